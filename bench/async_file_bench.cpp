@@ -0,0 +1,143 @@
+#include "async_file.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t FileSize  = 64 << 20;
+    constexpr std::size_t BlockSize = 64 << 10;
+    constexpr std::size_t Blocks    = FileSize / BlockSize;
+
+    std::string const& ScratchPath()
+    {
+        static std::string const path = []
+        {
+            auto path = (std::filesystem::temp_directory_path() / "handle_bench_async").string();
+
+            std::vector<char> const block(BlockSize, 'x');
+#if defined(_WIN32)
+            FileHandle file(::CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+            for (std::size_t i = 0; i < Blocks; ++i)
+            {
+                DWORD written = 0;
+                ::WriteFile(file, block.data(), static_cast<DWORD>(block.size()), &written, nullptr);
+            }
+#else
+            FileHandle file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+            for (std::size_t i = 0; i < Blocks; ++i)
+            {
+                auto const written = ::write(file, block.data(), block.size());
+                benchmark::DoNotOptimize(written);
+            }
+#endif
+            return path;
+        }();
+
+        return path;
+    }
+
+    FileHandle OpenForReading(bool overlapped) noexcept
+    {
+#if defined(_WIN32)
+        DWORD const flags = FILE_ATTRIBUTE_NORMAL | (overlapped ? FILE_FLAG_OVERLAPPED : 0);
+        return FileHandle(::CreateFileA(ScratchPath().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr));
+#else
+        (void)overlapped;
+        return FileHandle(::open(ScratchPath().c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+    }
+
+    /*
+     * @brief Baseline, one positional read after another over the whole file
+     */
+    void BM_SyncRead(benchmark::State& state)
+    {
+        auto const file = OpenForReading(false);
+        std::vector<std::byte> buffer(BlockSize);
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < Blocks; ++i)
+            {
+#if defined(_WIN32)
+                OVERLAPPED position{};
+                position.Offset     = static_cast<DWORD>(i * BlockSize);
+                position.OffsetHigh = static_cast<DWORD>(static_cast<std::uint64_t>(i * BlockSize) >> 32);
+
+                DWORD read = 0;
+                ::ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &read, &position);
+#else
+                auto const read = ::pread(file, buffer.data(), buffer.size(), static_cast<off_t>(i * BlockSize));
+#endif
+                benchmark::DoNotOptimize(read);
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * FileSize));
+    }
+
+    /*
+     * @brief Same reads through AsyncFile, keeping `range(0)` of them in flight
+     */
+    void BM_AsyncRead(benchmark::State& state)
+    {
+        auto const depth = static_cast<std::uint32_t>(state.range(0));
+
+        AsyncFile file(OpenForReading(true), depth);
+        if (!file.Valid())
+        {
+            state.SkipWithError("AsyncFile unavailable");
+            return;
+        }
+
+        // One buffer per slot, a slot is reused once its read completes
+        std::vector<std::byte> buffers(depth * BlockSize);
+        std::vector<AsyncCompletion> completions(depth);
+
+        for (auto _ : state)
+        {
+            std::size_t next = 0;
+            std::size_t done = 0;
+
+            auto submit = [&](std::size_t slot)
+            {
+                AsyncRead const read{ std::span(buffers).subspan(slot * BlockSize, BlockSize), next * BlockSize, slot };
+                next += file.SubmitReads({ &read, 1 });
+            };
+
+            for (std::size_t slot = 0; slot < depth && next < Blocks; ++slot)
+            {
+                submit(slot);
+            }
+
+            while (done < Blocks)
+            {
+                auto const reaped = file.WaitCompletions(completions);
+                for (std::size_t i = 0; i < reaped; ++i)
+                {
+                    benchmark::DoNotOptimize(completions[i].m_Result);
+                    if (next < Blocks)
+                    {
+                        submit(completions[i].m_UserData);
+                    }
+                }
+
+                done += reaped;
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * FileSize));
+    }
+}
+
+BENCHMARK(BM_SyncRead);
+BENCHMARK(BM_AsyncRead)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
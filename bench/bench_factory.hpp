@@ -0,0 +1,163 @@
+#pragma once
+#include "handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_WIN32)
+#include <tlhelp32.h>
+#else
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#endif
+
+namespace Bench
+{
+    /*
+     * @brief Creates a fresh kernel object for every handle alias
+     *
+     * Objects that need unique names or are expensive to create from scratch
+     * (pipes, mailslots, snapshots) are duplicated from a prototype instead, which
+     * still produces a new handle the wrapper has to close.
+     */
+    template<typename _Handle>
+    struct Factory;
+
+#if defined(_WIN32)
+    inline HANDLE Duplicate(HANDLE prototype) noexcept
+    {
+        HANDLE duplicate = nullptr;
+        ::DuplicateHandle(::GetCurrentProcess(), prototype, ::GetCurrentProcess(), &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS);
+        return duplicate;
+    }
+
+    template<> struct Factory<EventHandle>            { static HANDLE Open() noexcept { return ::CreateEventW(nullptr, FALSE, FALSE, nullptr); } };
+    template<> struct Factory<SemaphoreHandle>        { static HANDLE Open() noexcept { return ::CreateSemaphoreW(nullptr, 0, 1, nullptr); } };
+    template<> struct Factory<MutexHandle>            { static HANDLE Open() noexcept { return ::CreateMutexW(nullptr, FALSE, nullptr); } };
+    template<> struct Factory<ProcessHandle>          { static HANDLE Open() noexcept { return ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, ::GetCurrentProcessId()); } };
+    template<> struct Factory<ThreadHandle>           { static HANDLE Open() noexcept { return ::OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, ::GetCurrentThreadId()); } };
+    template<> struct Factory<IoCompletionPortHandle> { static HANDLE Open() noexcept { return ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1); } };
+    template<> struct Factory<JobHandle>              { static HANDLE Open() noexcept { return ::CreateJobObjectW(nullptr, nullptr); } };
+    template<> struct Factory<WaitableTimerHandle>    { static HANDLE Open() noexcept { return ::CreateWaitableTimerW(nullptr, FALSE, nullptr); } };
+
+    template<> struct Factory<FileHandle>
+    {
+        static HANDLE Open() noexcept
+        {
+            return ::CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+        }
+    };
+
+    template<> struct Factory<NamedPipeHandle>
+    {
+        static HANDLE Open() noexcept
+        {
+            static HANDLE const prototype = ::CreateNamedPipeW(L"\\\\.\\pipe\\handle_bench", PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE, 1, 0, 0, 0, nullptr);
+            return Duplicate(prototype);
+        }
+    };
+
+    template<> struct Factory<MailSlotHandle>
+    {
+        static HANDLE Open() noexcept
+        {
+            static HANDLE const prototype = ::CreateMailslotW(L"\\\\.\\mailslot\\handle_bench", 0, 0, nullptr);
+            return Duplicate(prototype);
+        }
+    };
+
+    template<> struct Factory<FileMappingHandle>
+    {
+        static HANDLE Open() noexcept
+        {
+            return ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, 4096, nullptr);
+        }
+    };
+
+    template<> struct Factory<SnapshotHandle>
+    {
+        static HANDLE Open() noexcept
+        {
+            static HANDLE const prototype = ::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+            return Duplicate(prototype);
+        }
+    };
+
+    template<> struct Factory<SocketHandle>
+    {
+        static SOCKET Open() noexcept
+        {
+            static bool const started = []
+            {
+                WSADATA data;
+                return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+
+            return started ? ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP) : INVALID_SOCKET;
+        }
+    };
+#else
+    template<> struct Factory<EventHandle>            { static int Open() noexcept { return ::eventfd(0, EFD_CLOEXEC); } };
+    template<> struct Factory<SemaphoreHandle>        { static int Open() noexcept { return ::eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC); } };
+    template<> struct Factory<WaitableTimerHandle>    { static int Open() noexcept { return ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC); } };
+    template<> struct Factory<JobHandle>              { static int Open() noexcept { return ::open("/sys/fs/cgroup", O_RDONLY | O_DIRECTORY | O_CLOEXEC); } };
+    template<> struct Factory<SnapshotHandle>         { static int Open() noexcept { return ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC); } };
+    template<> struct Factory<ProcessHandle>          { static int Open() noexcept { return static_cast<int>(::syscall(SYS_pidfd_open, ::getpid(), 0)); } };
+    template<> struct Factory<IoCompletionPortHandle> { static int Open() noexcept { return ::epoll_create1(EPOLL_CLOEXEC); } };
+    template<> struct Factory<FileMappingHandle>      { static int Open() noexcept { return ::memfd_create("handle_bench", MFD_CLOEXEC); } };
+    template<> struct Factory<SocketHandle>           { static int Open() noexcept { return ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0); } };
+    template<> struct Factory<FileHandle>             { static int Open() noexcept { return ::open("/dev/null", O_RDONLY | O_CLOEXEC); } };
+
+    template<> struct Factory<NamedPipeHandle>
+    {
+        static int Open() noexcept
+        {
+            static int const prototype = []
+            {
+                int ends[2] = { -1, -1 };
+                ::pipe2(ends, O_CLOEXEC);
+                return ends[0];
+            }();
+
+            return ::fcntl(prototype, F_DUPFD_CLOEXEC, 0);
+        }
+    };
+#endif
+}
+
+namespace Bench
+{
+    /*
+     * @brief Handle value that is never a kernel object, closing it only bumps g_FakeCloses
+     *
+     * Used where benchmarks need millions of owned handles without hitting descriptor limits.
+     */
+    enum class FakeValue : std::intptr_t {};
+
+    inline std::size_t g_FakeCloses = 0;
+}
+
+template<>
+struct HandleTraits<Bench::FakeValue>
+{
+    using Type = Bench::FakeValue;
+
+    static constexpr std::intptr_t InvalidHandleBits = -1;
+
+    [[nodiscard]] static constexpr Type InvalidHandleValue() noexcept
+    {
+        return HandleFromBits<Type>(InvalidHandleBits);
+    }
+
+    static void Close(Type) noexcept { ++Bench::g_FakeCloses; }
+
+    [[nodiscard]] static constexpr bool Valid(Type handle) noexcept
+    {
+        return HandleToBits(handle) != InvalidHandleBits;
+    }
+};
@@ -0,0 +1,285 @@
+#include "completion_engine.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t MessageSize = 64;
+    constexpr std::size_t Connections = 64;
+    constexpr std::int64_t RoundTrips = 10000;
+
+#if defined(_WIN32)
+    using SocketLength = int;
+#else
+    using SocketLength = socklen_t;
+#endif
+
+    /*
+     * @brief Connected TCP pair over 127.0.0.1 with Nagle disabled on both ends
+     */
+    bool LoopbackPair(SocketHandle& client, SocketHandle& server) noexcept
+    {
+#if defined(_WIN32)
+        static bool const started = []
+        {
+            WSADATA data;
+            return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+
+        if (!started)
+        {
+            return false;
+        }
+#endif
+
+        SocketHandle listener(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        SocketLength length     = sizeof(address);
+
+        if (!listener.Valid()
+            || ::bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0
+            || ::listen(listener, 1) != 0
+            || ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        {
+            return false;
+        }
+
+        client.Reset(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        if (!client.Valid() || ::connect(client, reinterpret_cast<sockaddr*>(&address), length) != 0)
+        {
+            return false;
+        }
+
+        server.Reset(::accept(listener, nullptr, nullptr));
+
+        int const enable = 1;
+        for (auto const socket : { client.Get(), server.Get() })
+        {
+            ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&enable), sizeof(enable));
+        }
+
+        return server.Valid();
+    }
+
+    struct EchoState
+    {
+        std::atomic<std::int64_t> m_Budget      = 0;
+        std::atomic<std::size_t>  m_Active      = 0;
+        std::atomic<std::size_t>  m_Outstanding = 0;
+    };
+
+    /*
+     * @brief One client/server socket pair bouncing a message through the engine
+     */
+    struct Connection
+    {
+        CompletionEngine* m_Engine;
+        EchoState*        m_State;
+
+        SocketHandle m_Client;
+        SocketHandle m_Server;
+
+        std::array<std::byte, MessageSize> m_Request{};
+        std::array<std::byte, MessageSize> m_Response{};
+        std::array<std::byte, MessageSize> m_Echo{};
+        std::size_t                        m_Received = 0;
+        std::size_t                        m_Echoed   = 0;
+
+        Clock::time_point   m_Sent;
+        std::vector<double> m_Latencies;
+
+        template<typename _Handle, typename _Buffer>
+        void Read(_Handle const& socket, _Buffer buffer, IoCallback callback) noexcept
+        {
+            m_State->m_Outstanding.fetch_add(1, std::memory_order_relaxed);
+            if (!m_Engine->Read(socket, buffer, 0, callback, this))
+            {
+                m_State->m_Outstanding.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        template<typename _Handle, typename _Buffer>
+        void Write(_Handle const& socket, _Buffer buffer, IoCallback callback) noexcept
+        {
+            m_State->m_Outstanding.fetch_add(1, std::memory_order_relaxed);
+            if (!m_Engine->Write(socket, buffer, 0, callback, this))
+            {
+                m_State->m_Outstanding.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        void Done() noexcept
+        {
+            m_State->m_Outstanding.fetch_sub(1, std::memory_order_release);
+        }
+
+        void SendRequest() noexcept
+        {
+            m_Received = 0;
+            m_Sent     = Clock::now();
+            Write(m_Client, std::span<std::byte const>(m_Request), &OnRequestSent);
+        }
+
+        static void OnRequestSent(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& self = *static_cast<Connection*>(operation.m_Context);
+            self.Read(self.m_Client, std::span(self.m_Response), &OnResponse);
+            self.Done();
+        }
+
+        static void OnResponse(IoOperation& operation, std::int64_t result) noexcept
+        {
+            auto& self = *static_cast<Connection*>(operation.m_Context);
+            if (result > 0)
+            {
+                self.m_Received += static_cast<std::size_t>(result);
+                if (self.m_Received < MessageSize)
+                {
+                    self.Read(self.m_Client, std::span(self.m_Response).subspan(self.m_Received), &OnResponse);
+                }
+                else
+                {
+                    self.m_Latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - self.m_Sent).count());
+
+                    if (self.m_State->m_Budget.fetch_sub(1, std::memory_order_relaxed) > 1)
+                    {
+                        self.SendRequest();
+                    }
+                    else if (self.m_State->m_Active.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        self.m_State->m_Active.notify_all();
+                    }
+                }
+            }
+
+            self.Done();
+        }
+
+        void ReceiveRequest() noexcept
+        {
+            Read(m_Server, std::span(m_Echo), &OnRequest);
+        }
+
+        static void OnRequest(IoOperation& operation, std::int64_t result) noexcept
+        {
+            auto& self = *static_cast<Connection*>(operation.m_Context);
+            if (result > 0)
+            {
+                self.m_Echoed = static_cast<std::size_t>(result);
+                self.Write(self.m_Server, std::span<std::byte const>(self.m_Echo).first(self.m_Echoed), &OnEchoed);
+            }
+
+            self.Done();
+        }
+
+        static void OnEchoed(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& self = *static_cast<Connection*>(operation.m_Context);
+            self.ReceiveRequest();
+            self.Done();
+        }
+    };
+
+    /*
+     * @brief Round trips of a 64 byte message over loopback TCP, `range(0)` workers
+     */
+    void BM_LoopbackEcho(benchmark::State& state)
+    {
+        auto const threads = static_cast<unsigned>(state.range(0));
+
+        CompletionEngine engine(threads);
+        EchoState echo;
+
+        std::vector<std::unique_ptr<Connection>> connections;
+        for (std::size_t i = 0; i < Connections; ++i)
+        {
+            auto connection = std::make_unique<Connection>();
+            connection->m_Engine = &engine;
+            connection->m_State  = &echo;
+
+            if (!LoopbackPair(connection->m_Client, connection->m_Server)
+                || !engine.Associate(connection->m_Client)
+                || !engine.Associate(connection->m_Server))
+            {
+                state.SkipWithError("loopback connection failed");
+                return;
+            }
+
+            connections.push_back(std::move(connection));
+        }
+
+        engine.Start(threads);
+        for (auto const& connection : connections)
+        {
+            connection->ReceiveRequest();
+        }
+
+        for (auto _ : state)
+        {
+            echo.m_Budget.store(RoundTrips, std::memory_order_relaxed);
+            echo.m_Active.store(Connections, std::memory_order_release);
+
+            for (auto const& connection : connections)
+            {
+                connection->SendRequest();
+            }
+
+            for (auto active = echo.m_Active.load(std::memory_order_acquire); active != 0; active = echo.m_Active.load(std::memory_order_acquire))
+            {
+                echo.m_Active.wait(active, std::memory_order_acquire);
+            }
+        }
+
+        // Closing the clients ends the pending server reads, wait for their callbacks before tearing down
+        for (auto const& connection : connections)
+        {
+            engine.Disassociate(connection->m_Client);
+            engine.Disassociate(connection->m_Server);
+            connection->m_Client.Close();
+        }
+
+        while (echo.m_Outstanding.load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        engine.Stop();
+
+        std::vector<double> latencies;
+        for (auto const& connection : connections)
+        {
+            latencies.insert(latencies.end(), connection->m_Latencies.begin(), connection->m_Latencies.end());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        if (!latencies.empty())
+        {
+            state.counters["p50_ns"] = latencies[latencies.size() / 2];
+            state.counters["p99_ns"] = latencies[latencies.size() * 99 / 100];
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(latencies.size()));
+    }
+}
+
+BENCHMARK(BM_LoopbackEcho)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->UseRealTime();
@@ -0,0 +1,290 @@
+#include "coroutine_io.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/socket.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t ChainLength = 1000;
+    constexpr std::size_t MessageSize = 64;
+
+    /*
+     * @brief File completing every read right away, isolating dispatch and resumption cost
+     */
+    FileHandle OpenZero() noexcept
+    {
+#if defined(_WIN32)
+        return FileHandle(::CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_OVERLAPPED, nullptr));
+#else
+        return FileHandle(::open("/dev/zero", O_RDONLY | O_CLOEXEC));
+#endif
+    }
+
+    /*
+     * @brief Connected stream pair, both ends associated with `engine`
+     */
+    bool StreamPair(CompletionEngine& engine, SocketHandle& first, SocketHandle& second) noexcept
+    {
+#if defined(_WIN32)
+        (void)engine, (void)first, (void)second;
+        return false;
+#else
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+        {
+            return false;
+        }
+
+        first.Reset(fds[0]);
+        second.Reset(fds[1]);
+        return engine.Associate(first) && engine.Associate(second);
+#endif
+    }
+
+    void Drive(CompletionEngine& engine, bool const& done) noexcept
+    {
+        while (!done)
+        {
+            engine.RunOnce();
+        }
+    }
+
+    // Runs completions still queued, e.g. of the final echo
+    void Drain(CompletionEngine& engine) noexcept
+    {
+        while (engine.RunOnce(std::chrono::milliseconds::zero()) != 0)
+        {
+        }
+    }
+
+    struct ReadChain
+    {
+        CompletionEngine&                  m_Engine;
+        FileHandle const&                  m_File;
+        std::array<std::byte, MessageSize> m_Buffer;
+        std::size_t                        m_Remaining;
+        bool                               m_Done;
+
+        static void OnRead(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& chain = *static_cast<ReadChain*>(operation.m_Context);
+            if (--chain.m_Remaining == 0 || !chain.m_Engine.Read(chain.m_File, chain.m_Buffer, 0, &OnRead, &chain))
+            {
+                chain.m_Done = true;
+            }
+        }
+    };
+
+    /*
+     * @brief ChainLength dependent reads, each issued from the previous one's callback
+     */
+    void BM_CallbackReadChain(benchmark::State& state)
+    {
+        CompletionEngine engine(1);
+        auto const file = OpenZero();
+        if (!engine.Valid() || !engine.Associate(file))
+        {
+            state.SkipWithError("engine setup failed");
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            ReadChain chain{ engine, file, {}, ChainLength, false };
+            engine.Read(file, chain.m_Buffer, 0, &ReadChain::OnRead, &chain);
+            Drive(engine, chain.m_Done);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ChainLength));
+    }
+
+    IoTask<> ReadLoop(CompletionEngine& engine, FileHandle const& file, bool& done)
+    {
+        std::array<std::byte, MessageSize> buffer;
+        for (std::size_t i = 0; i < ChainLength; ++i)
+        {
+            if (co_await ReadAsync(engine, file, buffer) < 0)
+            {
+                break;
+            }
+        }
+
+        done = true;
+    }
+
+    /*
+     * @brief Same chain as a loop in one coroutine
+     */
+    void BM_CoroutineReadChain(benchmark::State& state)
+    {
+        CompletionEngine engine(1);
+        auto const file = OpenZero();
+        if (!engine.Valid() || !engine.Associate(file))
+        {
+            state.SkipWithError("engine setup failed");
+            return;
+        }
+
+        auto const allocated = CoroutineFramePool::Allocated();
+
+        for (auto _ : state)
+        {
+            bool done = false;
+            ReadLoop(engine, file, done).Start();
+            Drive(engine, done);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ChainLength));
+        state.counters["frames_allocated"] = static_cast<double>(CoroutineFramePool::Allocated() - allocated);
+    }
+
+    /*
+     * @brief The protocol of Ping() and Echo() below as callbacks, each side waits for its send before receiving
+     */
+    struct PingPong
+    {
+        CompletionEngine&                  m_Engine;
+        SocketHandle const&                m_Client;
+        SocketHandle const&                m_Server;
+        std::array<std::byte, MessageSize> m_Ping;
+        std::array<std::byte, MessageSize> m_Pong;
+        std::size_t                        m_Remaining;
+        bool                               m_Done;
+
+        void Start() noexcept
+        {
+            m_Engine.Read(m_Server, m_Pong, 0, &OnServerReceived, this);
+            m_Engine.Write(m_Client, m_Ping, 0, &OnClientSent, this);
+        }
+
+        static void OnClientSent(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& pingPong = *static_cast<PingPong*>(operation.m_Context);
+            pingPong.m_Engine.Read(pingPong.m_Client, pingPong.m_Ping, 0, &OnClientReceived, &pingPong);
+        }
+
+        static void OnClientReceived(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& pingPong = *static_cast<PingPong*>(operation.m_Context);
+            if (--pingPong.m_Remaining == 0)
+            {
+                pingPong.m_Done = true;
+                return;
+            }
+
+            pingPong.m_Engine.Write(pingPong.m_Client, pingPong.m_Ping, 0, &OnClientSent, &pingPong);
+        }
+
+        static void OnServerReceived(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& pingPong = *static_cast<PingPong*>(operation.m_Context);
+            pingPong.m_Engine.Write(pingPong.m_Server, pingPong.m_Pong, 0, &OnServerSent, &pingPong);
+        }
+
+        static void OnServerSent(IoOperation& operation, std::int64_t) noexcept
+        {
+            auto& pingPong = *static_cast<PingPong*>(operation.m_Context);
+            if (pingPong.m_Remaining > 1)
+            {
+                pingPong.m_Engine.Read(pingPong.m_Server, pingPong.m_Pong, 0, &OnServerReceived, &pingPong);
+            }
+        }
+    };
+
+    /*
+     * @brief ChainLength round trips of a 64 byte message over a stream pair, with callbacks
+     */
+    void BM_CallbackPingPong(benchmark::State& state)
+    {
+        CompletionEngine engine(1);
+        SocketHandle client, server;
+        if (!engine.Valid() || !StreamPair(engine, client, server))
+        {
+            state.SkipWithError("stream pair setup failed");
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            PingPong pingPong{ engine, client, server, {}, {}, ChainLength, false };
+            pingPong.Start();
+            Drive(engine, pingPong.m_Done);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ChainLength));
+        Drain(engine);
+        engine.Disassociate(client);
+        engine.Disassociate(server);
+    }
+
+    IoTask<> Echo(CompletionEngine& engine, SocketHandle const& server)
+    {
+        std::array<std::byte, MessageSize> buffer;
+        for (std::size_t i = 0; i < ChainLength; ++i)
+        {
+            if (co_await ReceiveAsync(engine, server, buffer) <= 0 || co_await SendAsync(engine, server, buffer) <= 0)
+            {
+                break;
+            }
+        }
+    }
+
+    IoTask<> Ping(CompletionEngine& engine, SocketHandle const& client, bool& done)
+    {
+        std::array<std::byte, MessageSize> buffer{};
+        for (std::size_t i = 0; i < ChainLength; ++i)
+        {
+            if (co_await SendAsync(engine, client, buffer) <= 0 || co_await ReceiveAsync(engine, client, buffer) <= 0)
+            {
+                break;
+            }
+        }
+
+        done = true;
+    }
+
+    /*
+     * @brief Same round trips as two coroutines
+     */
+    void BM_CoroutinePingPong(benchmark::State& state)
+    {
+        CompletionEngine engine(1);
+        SocketHandle client, server;
+        if (!engine.Valid() || !StreamPair(engine, client, server))
+        {
+            state.SkipWithError("stream pair setup failed");
+            return;
+        }
+
+        auto const allocated = CoroutineFramePool::Allocated();
+
+        for (auto _ : state)
+        {
+            bool done = false;
+            Echo(engine, server).Start();
+            Ping(engine, client, done).Start();
+            Drive(engine, done);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ChainLength));
+        Drain(engine);
+        state.counters["frames_allocated"] = static_cast<double>(CoroutineFramePool::Allocated() - allocated);
+        engine.Disassociate(client);
+        engine.Disassociate(server);
+    }
+}
+
+BENCHMARK(BM_CallbackReadChain);
+BENCHMARK(BM_CoroutineReadChain);
+BENCHMARK(BM_CallbackPingPong);
+BENCHMARK(BM_CoroutinePingPong);
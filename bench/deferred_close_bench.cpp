@@ -0,0 +1,81 @@
+#include "deferred_close.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using FileTag = TaggedHandle<HandleType::File>;
+
+    /*
+     * @brief Opens a scratch file and writes `size` bytes so the close has dirty data behind it
+     */
+    FileHandle::Type OpenWrittenFile(std::string const& path, std::vector<char> const& data) noexcept
+    {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        DWORD written = 0;
+        ::WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+        return file;
+#else
+        int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        auto const written = ::write(file, data.data(), data.size());
+        benchmark::DoNotOptimize(written);
+        return file;
+#endif
+    }
+
+    /*
+     * @brief Times only the destructor and reports the p50/p99 of the samples
+     */
+    template<typename _ClosePolicy>
+    void BM_DestroyWrittenFile(benchmark::State& state)
+    {
+        std::vector<char> const data(static_cast<std::size_t>(state.range(0)), 'x');
+        std::string const path = (std::filesystem::temp_directory_path() / "handle_bench_deferred").string();
+        std::vector<double> samples;
+
+        for (auto _ : state)
+        {
+            std::chrono::duration<double> elapsed{};
+            {
+                auto* handle = new Handle<FileTag, _ClosePolicy>(OpenWrittenFile(path, data));
+
+                auto const start = Clock::now();
+                delete handle;
+                elapsed = Clock::now() - start;
+            }
+
+            state.SetIterationTime(elapsed.count());
+            samples.push_back(elapsed.count() * 1e9);
+
+            // Keep the closer from falling behind so every iteration measures the same thing
+            if constexpr (std::is_same_v<_ClosePolicy, CloseDeferred>)
+            {
+                DeferredCloser::Instance().Flush();
+            }
+        }
+
+        std::sort(samples.begin(), samples.end());
+        if (!samples.empty())
+        {
+            state.counters["p50_ns"] = samples[samples.size() / 2];
+            state.counters["p99_ns"] = samples[samples.size() * 99 / 100];
+        }
+
+        std::filesystem::remove(path);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_DestroyWrittenFile, CloseImmediately)->Arg(0)->Arg(1 << 20)->UseManualTime();
+BENCHMARK_TEMPLATE(BM_DestroyWrittenFile, CloseDeferred)->Arg(0)->Arg(1 << 20)->UseManualTime();
@@ -0,0 +1,84 @@
+#include "event_pool.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+    /*
+     * @brief Baseline, a fresh kernel event per request
+     */
+    void BM_CreateCloseEvent(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            EventHandle event(Bench::Factory<EventHandle>::Open());
+            benchmark::DoNotOptimize(event.Get());
+        }
+    }
+
+    /*
+     * @brief Steady state, served from the per-thread cache
+     */
+    template<EventReset _Reset>
+    void BM_EventPoolAcquireRelease(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            auto event = EventPool<_Reset>::Instance().Acquire();
+            benchmark::DoNotOptimize(event.Get());
+        }
+    }
+
+    /*
+     * @brief `range(0)` events held at once, beyond the thread cache this goes through the global freelist
+     */
+    void BM_EventPoolBurst(benchmark::State& state)
+    {
+        auto const burst = static_cast<std::size_t>(state.range(0));
+
+        std::vector<PooledEventHandle<>> events;
+        events.reserve(burst);
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < burst; ++i)
+            {
+                events.push_back(EventPool<EventReset::Auto>::Instance().Acquire());
+            }
+
+            events.clear();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * burst));
+    }
+
+    void BM_CreateCloseEventBurst(benchmark::State& state)
+    {
+        auto const burst = static_cast<std::size_t>(state.range(0));
+
+        std::vector<EventHandle> events;
+        events.reserve(burst);
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < burst; ++i)
+            {
+                events.emplace_back(Bench::Factory<EventHandle>::Open());
+            }
+
+            events.clear();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * burst));
+    }
+}
+
+BENCHMARK(BM_CreateCloseEvent)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_EventPoolAcquireRelease, EventReset::Auto)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_EventPoolAcquireRelease, EventReset::Manual);
+BENCHMARK(BM_EventPoolBurst)->Arg(8)->Arg(256);
+BENCHMARK(BM_CreateCloseEventBurst)->Arg(8)->Arg(256);
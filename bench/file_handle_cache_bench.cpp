@@ -0,0 +1,156 @@
+#include "file_handle_cache.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t HotFiles  = 256;
+    constexpr std::size_t ColdFiles = 4096;
+    constexpr std::size_t Capacity  = 1024;
+
+    /*
+     * @brief HotFiles + ColdFiles small files, hot ones first
+     */
+    std::vector<std::filesystem::path> const& Files()
+    {
+        static std::vector<std::filesystem::path> const files = []
+        {
+            auto const directory = std::filesystem::temp_directory_path() / "handle_bench_cache";
+            std::filesystem::create_directories(directory);
+
+            std::string const contents(1024, 'x');
+            std::vector<std::filesystem::path> files;
+            for (std::size_t i = 0; i < HotFiles + ColdFiles; ++i)
+            {
+                auto path = directory / (std::to_string(i) + ".txt");
+                if (!std::filesystem::exists(path))
+                {
+                    std::ofstream(path, std::ios::binary) << contents;
+                }
+
+                files.push_back(std::move(path));
+            }
+
+            return files;
+        }();
+
+        return files;
+    }
+
+    /*
+     * @brief Stands in for serving the file, reads its first bytes
+     */
+    template<typename _File>
+    void Serve(_File const& file) noexcept
+    {
+        char buffer[64];
+#if defined(_WIN32)
+        OVERLAPPED position{};
+        DWORD read = 0;
+        ::ReadFile(file.Get(), buffer, sizeof(buffer), &read, &position);
+#else
+        auto const read = ::pread(file.Get(), buffer, sizeof(buffer), 0);
+#endif
+        benchmark::DoNotOptimize(read);
+    }
+
+    /*
+     * @brief Request stream hitting the hot set `range(0)`% of the time and cycling through cold files otherwise
+     *
+     * Cold files are requested round-robin over more files than the cache holds, so they miss.
+     */
+    class RequestStream
+    {
+    private:
+        std::mt19937                          m_Random;
+        std::uniform_int_distribution<int>    m_Percent{ 0, 99 };
+        std::uniform_int_distribution<size_t> m_Hot{ 0, HotFiles - 1 };
+        std::size_t                           m_Cold;
+        int                                   m_HitPercent;
+
+    public:
+        RequestStream(int hitPercent, std::size_t seed)
+            : m_Random(static_cast<std::mt19937::result_type>(seed))
+            , m_Cold(seed * 997)
+            , m_HitPercent(hitPercent)
+        {}
+
+        std::filesystem::path const& Next()
+        {
+            if (m_Percent(m_Random) < m_HitPercent)
+            {
+                return Files()[m_Hot(m_Random)];
+            }
+
+            return Files()[HotFiles + m_Cold++ % ColdFiles];
+        }
+    };
+
+    /*
+     * @brief Baseline, open and close per request
+     */
+    void BM_OpenPerRequest(benchmark::State& state)
+    {
+        RequestStream requests(static_cast<int>(state.range(0)), static_cast<std::size_t>(state.thread_index()));
+
+        for (auto _ : state)
+        {
+            auto const& path = requests.Next();
+#if defined(_WIN32)
+            FileHandle file(::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                          FILE_ATTRIBUTE_NORMAL, nullptr));
+#else
+            FileHandle file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+            Serve(file);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    std::unique_ptr<FileHandleCache> g_Cache;
+
+    void BM_CachedRequest(benchmark::State& state)
+    {
+        if (state.thread_index() == 0)
+        {
+            g_Cache = std::make_unique<FileHandleCache>(Capacity);
+
+            // Warm the hot set
+            for (std::size_t i = 0; i < HotFiles; ++i)
+            {
+                benchmark::DoNotOptimize(g_Cache->Open(Files()[i]).Get());
+            }
+        }
+
+        RequestStream requests(static_cast<int>(state.range(0)), static_cast<std::size_t>(state.thread_index()));
+
+        for (auto _ : state)
+        {
+            Serve(g_Cache->Open(requests.Next()));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0)
+        {
+            auto const hits   = static_cast<double>(g_Cache->Hits());
+            auto const misses = static_cast<double>(g_Cache->Misses());
+            state.counters["hit_rate"] = hits / (hits + misses);
+            g_Cache.reset();
+        }
+    }
+}
+
+BENCHMARK(BM_OpenPerRequest)->Arg(0)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK(BM_CachedRequest)->Arg(0)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK(BM_OpenPerRequest)->Arg(90)->Threads(4)->UseRealTime();
+BENCHMARK(BM_CachedRequest)->Arg(90)->Threads(4)->UseRealTime();
@@ -0,0 +1,118 @@
+#include "handle.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+    /*
+     * @brief Open and close through the traits directly, the floor for BM_OpenCloseHandle
+     */
+    template<typename _Handle>
+    void BM_OpenCloseRaw(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            auto handle = Bench::Factory<_Handle>::Open();
+            benchmark::DoNotOptimize(handle);
+            _Handle::Traits::Close(handle);
+        }
+    }
+
+    template<typename _Handle>
+    void BM_OpenCloseHandle(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            _Handle handle = Bench::Factory<_Handle>::Open();
+            benchmark::DoNotOptimize(handle.Get());
+        }
+    }
+
+    template<typename _Handle>
+    void BM_Move(benchmark::State& state)
+    {
+        _Handle first = Bench::Factory<_Handle>::Open();
+        _Handle second;
+
+        for (auto _ : state)
+        {
+            second = std::move(first);
+            first  = std::move(second);
+            benchmark::DoNotOptimize(first.Get());
+        }
+    }
+
+    template<typename _Handle>
+    void BM_Valid(benchmark::State& state)
+    {
+        _Handle handle = Bench::Factory<_Handle>::Open();
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(handle);
+            benchmark::DoNotOptimize(handle.Valid());
+        }
+    }
+}
+
+#define HANDLE_BENCHMARK_ALIAS(alias)                 \
+    BENCHMARK_TEMPLATE(BM_OpenCloseRaw, alias);       \
+    BENCHMARK_TEMPLATE(BM_OpenCloseHandle, alias);    \
+    BENCHMARK_TEMPLATE(BM_Move, alias);               \
+    BENCHMARK_TEMPLATE(BM_Valid, alias);
+
+HANDLE_BENCHMARK_ALIAS(EventHandle)
+HANDLE_BENCHMARK_ALIAS(SemaphoreHandle)
+HANDLE_BENCHMARK_ALIAS(ProcessHandle)
+HANDLE_BENCHMARK_ALIAS(IoCompletionPortHandle)
+HANDLE_BENCHMARK_ALIAS(JobHandle)
+HANDLE_BENCHMARK_ALIAS(WaitableTimerHandle)
+HANDLE_BENCHMARK_ALIAS(FileHandle)
+HANDLE_BENCHMARK_ALIAS(NamedPipeHandle)
+HANDLE_BENCHMARK_ALIAS(FileMappingHandle)
+HANDLE_BENCHMARK_ALIAS(SnapshotHandle)
+HANDLE_BENCHMARK_ALIAS(SocketHandle)
+
+#if defined(_WIN32)
+HANDLE_BENCHMARK_ALIAS(MutexHandle)
+HANDLE_BENCHMARK_ALIAS(ThreadHandle)
+HANDLE_BENCHMARK_ALIAS(MailSlotHandle)
+#endif
+
+/*
+ * Vector growth must relocate handles by moving them. Fake handles with a counting
+ * closer let us push a million of them and check that not a single one was closed
+ * before the vector itself goes away.
+ */
+namespace
+{
+    void BM_VectorGrowth(benchmark::State& state)
+    {
+        auto const count = static_cast<std::intptr_t>(state.range(0));
+        std::size_t closesDuringGrowth = 0;
+
+        for (auto _ : state)
+        {
+            std::vector<Handle<Bench::FakeValue>> handles;
+            Bench::g_FakeCloses = 0;
+
+            for (std::intptr_t i = 0; i < count; ++i)
+            {
+                handles.emplace_back(static_cast<Bench::FakeValue>(i));
+            }
+
+            closesDuringGrowth += Bench::g_FakeCloses;
+        }
+
+        state.counters["closes"] = static_cast<double>(closesDuringGrowth);
+        if (closesDuringGrowth != 0)
+        {
+            state.SkipWithError("vector growth closed handles");
+        }
+    }
+}
+
+BENCHMARK(BM_VectorGrowth)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,171 @@
+#include "handle_table.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using FakeHandle = Handle<Bench::FakeValue>;
+
+    FakeHandle MakeHandle(std::int64_t i) noexcept
+    {
+        return FakeHandle(static_cast<Bench::FakeValue>(i * 4 + 4));
+    }
+
+    /*
+     * @brief Today's approach: owned handles keyed by their raw value
+     */
+    using HandleMap = std::unordered_map<Bench::FakeValue, FakeHandle>;
+
+    void BM_TableInsertErase(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+        std::vector<HandleId> ids(static_cast<std::size_t>(count));
+
+        for (auto _ : state)
+        {
+            HandleTable<Bench::FakeValue> table;
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                ids[static_cast<std::size_t>(i)] = table.Insert(MakeHandle(i));
+            }
+
+            for (auto id : ids)
+            {
+                table.Erase(id);
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+
+    void BM_MapInsertErase(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+
+        for (auto _ : state)
+        {
+            HandleMap map;
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                auto handle = MakeHandle(i);
+                auto const key = handle.Get();
+                map.emplace(key, std::move(handle));
+            }
+
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                map.erase(MakeHandle(i).Release());
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+
+    void BM_TableLookup(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+        HandleTable<Bench::FakeValue> table;
+        std::vector<HandleId> ids;
+
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            ids.push_back(table.Insert(MakeHandle(i)));
+        }
+
+        std::shuffle(ids.begin(), ids.end(), std::mt19937_64(42));
+
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(table.Get(ids[next]));
+            next = next + 1 == ids.size() ? 0 : next + 1;
+        }
+    }
+
+    void BM_MapLookup(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+        HandleMap map;
+        std::vector<Bench::FakeValue> keys;
+
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            auto handle = MakeHandle(i);
+            keys.push_back(handle.Get());
+            map.emplace(handle.Get(), std::move(handle));
+        }
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64(42));
+
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(map.find(keys[next])->second.Get());
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+    }
+
+    void BM_TableIterate(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+        HandleTable<Bench::FakeValue> table;
+
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            (void)table.Insert(MakeHandle(i));
+        }
+
+        for (auto _ : state)
+        {
+            std::size_t valid = 0;
+            for (auto const& handle : table)
+            {
+                valid += handle.Valid();
+            }
+
+            benchmark::DoNotOptimize(valid);
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+
+    void BM_MapIterate(benchmark::State& state)
+    {
+        auto const count = state.range(0);
+        HandleMap map;
+
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            auto handle = MakeHandle(i);
+            auto const key = handle.Get();
+            map.emplace(key, std::move(handle));
+        }
+
+        for (auto _ : state)
+        {
+            std::size_t valid = 0;
+            for (auto const& [key, handle] : map)
+            {
+                valid += handle.Valid();
+            }
+
+            benchmark::DoNotOptimize(valid);
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+}
+
+BENCHMARK(BM_TableInsertErase)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MapInsertErase)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TableLookup)->RangeMultiplier(10)->Range(10'000, 1'000'000);
+BENCHMARK(BM_MapLookup)->RangeMultiplier(10)->Range(10'000, 1'000'000);
+BENCHMARK(BM_TableIterate)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MapIterate)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
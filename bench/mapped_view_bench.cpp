@@ -0,0 +1,215 @@
+#include "mapped_view.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t FileSize   = 64 << 20;
+    constexpr std::size_t ChunkSize  = 64 << 10;
+    constexpr std::size_t RecordSize = 4 << 10;
+    constexpr std::size_t Records    = 4096;
+
+    std::string const& ScratchPath()
+    {
+        static std::string const path = []
+        {
+            auto path = (std::filesystem::temp_directory_path() / "handle_bench_mapped").string();
+
+            std::vector<char> chunk(ChunkSize);
+            for (std::size_t i = 0; i < chunk.size(); ++i)
+            {
+                chunk[i] = static_cast<char>(i * 31);
+            }
+
+#if defined(_WIN32)
+            FileHandle file(::CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+            for (std::size_t i = 0; i < FileSize / ChunkSize; ++i)
+            {
+                DWORD written = 0;
+                ::WriteFile(file, chunk.data(), static_cast<DWORD>(chunk.size()), &written, nullptr);
+            }
+#else
+            FileHandle file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+            for (std::size_t i = 0; i < FileSize / ChunkSize; ++i)
+            {
+                auto const written = ::write(file, chunk.data(), chunk.size());
+                benchmark::DoNotOptimize(written);
+            }
+#endif
+            return path;
+        }();
+
+        return path;
+    }
+
+    /*
+     * @brief Stands in for real work on the data, touches every 8 bytes
+     */
+    std::uint64_t Checksum(std::byte const* data, std::size_t size) noexcept
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            sum += word;
+        }
+
+        return sum;
+    }
+
+    /*
+     * @brief Positional read into `buffer`
+     */
+    std::size_t ReadAt(FileHandle const& file, std::byte* buffer, std::size_t size, std::uint64_t offset) noexcept
+    {
+#if defined(_WIN32)
+        OVERLAPPED position{};
+        position.Offset     = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD read = 0;
+        ::ReadFile(file, buffer, static_cast<DWORD>(size), &read, &position);
+        return read;
+#else
+        auto const read = ::pread(file, buffer, size, static_cast<off_t>(offset));
+        return read < 0 ? 0 : static_cast<std::size_t>(read);
+#endif
+    }
+
+    FileHandle OpenForReading() noexcept
+    {
+#if defined(_WIN32)
+        return FileHandle(::CreateFileA(ScratchPath().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+#else
+        return FileHandle(::open(ScratchPath().c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+    }
+
+    std::vector<std::uint64_t> RandomRecordOffsets()
+    {
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<std::size_t> record(0, FileSize / RecordSize - 1);
+
+        std::vector<std::uint64_t> offsets(Records);
+        for (auto& offset : offsets)
+        {
+            offset = record(random) * RecordSize;
+        }
+
+        return offsets;
+    }
+
+    void BM_SequentialBufferedRead(benchmark::State& state)
+    {
+        auto const file = OpenForReading();
+        std::vector<std::byte> buffer(ChunkSize);
+
+        for (auto _ : state)
+        {
+            std::uint64_t sum = 0;
+            for (std::uint64_t offset = 0; offset < FileSize; offset += ChunkSize)
+            {
+                sum += Checksum(buffer.data(), ReadAt(file, buffer.data(), buffer.size(), offset));
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * FileSize));
+    }
+
+    void BM_SequentialMappedScan(benchmark::State& state)
+    {
+        MappedFile const file(ScratchPath());
+        file.Advise(MapAdvice::Sequential);
+
+        for (auto _ : state)
+        {
+            auto const bytes = file.Bytes();
+            benchmark::DoNotOptimize(Checksum(bytes.data(), bytes.size()));
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * FileSize));
+    }
+
+    void BM_RandomBufferedRead(benchmark::State& state)
+    {
+        auto const file    = OpenForReading();
+        auto const offsets = RandomRecordOffsets();
+        std::vector<std::byte> buffer(RecordSize);
+
+        for (auto _ : state)
+        {
+            std::uint64_t sum = 0;
+            for (auto const offset : offsets)
+            {
+                sum += Checksum(buffer.data(), ReadAt(file, buffer.data(), buffer.size(), offset));
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * Records * RecordSize));
+    }
+
+    void BM_RandomMappedScan(benchmark::State& state)
+    {
+        MappedFile const file(ScratchPath());
+        file.Advise(MapAdvice::Random);
+
+        auto const offsets = RandomRecordOffsets();
+
+        for (auto _ : state)
+        {
+            auto const bytes = file.Bytes();
+
+            std::uint64_t sum = 0;
+            for (auto const offset : offsets)
+            {
+                sum += Checksum(bytes.data() + offset, RecordSize);
+            }
+
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * Records * RecordSize));
+    }
+
+    /*
+     * @brief Cost of mapping a granularity-misaligned window and unmapping it again
+     */
+    void BM_MapUnmapWindow(benchmark::State& state)
+    {
+        auto const file = OpenForReading();
+#if defined(_WIN32)
+        FileMappingHandle const mapping(::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr));
+#else
+        FileMappingHandle const mapping(::fcntl(file, F_DUPFD_CLOEXEC, 0));
+#endif
+
+        for (auto _ : state)
+        {
+            MappedView const view(mapping, FileSize / 2 + 123, RecordSize);
+            benchmark::DoNotOptimize(view.Data());
+        }
+    }
+}
+
+BENCHMARK(BM_SequentialBufferedRead);
+BENCHMARK(BM_SequentialMappedScan);
+BENCHMARK(BM_RandomBufferedRead);
+BENCHMARK(BM_RandomMappedScan);
+BENCHMARK(BM_MapUnmapWindow);
@@ -0,0 +1,219 @@
+#include "pipe_server.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t MessageSize = 64;
+
+    std::filesystem::path ServerName()
+    {
+#if defined(_WIN32)
+        return L"\\\\.\\pipe\\handle_bench_" + std::to_wstring(::_getpid());
+#else
+        return std::filesystem::temp_directory_path() / ("handle_bench_" + std::to_string(::getpid()) + ".sock");
+#endif
+    }
+
+    IoTask<> Echo(PipeConnection connection, std::atomic<std::size_t>& sessions)
+    {
+        for (;;)
+        {
+            auto const message = co_await connection.Receive();
+            if (message.empty() || co_await connection.Send(message) <= 0)
+            {
+                break;
+            }
+        }
+
+        connection.Close();
+        --sessions;
+    }
+
+    IoTask<> Serve(PipeServer& server, std::atomic<std::size_t>& sessions)
+    {
+        for (;;)
+        {
+            auto connection = co_await server.Accept();
+            if (!connection.Valid())
+            {
+                break;
+            }
+
+            ++sessions;
+            Echo(std::move(connection), sessions).Start();
+        }
+    }
+
+    /*
+     * @brief PipeServer echoing every message, run by one engine worker
+     */
+    struct EchoServer
+    {
+        CompletionEngine          m_Engine{ 1, 8192 };
+        std::atomic<std::size_t>  m_Sessions{ 0 };
+        std::optional<PipeServer> m_Server;
+
+        explicit EchoServer(std::size_t instances)
+        {
+            if (!m_Engine.Valid())
+            {
+                return;
+            }
+
+            m_Engine.Start(1);
+            m_Server.emplace(m_Engine, ServerName(), instances, MessageSize);
+            if (m_Server->Valid())
+            {
+                Serve(*m_Server, m_Sessions).Start();
+            }
+        }
+
+        ~EchoServer()
+        {
+            // Clients are gone, the sessions end once their disconnects are seen
+            while (m_Sessions != 0)
+            {
+                std::this_thread::yield();
+            }
+
+            m_Server.reset();
+            m_Engine.Stop();
+        }
+
+        [[nodiscard]] bool Valid() const noexcept
+        {
+            return m_Server && m_Server->Valid();
+        }
+    };
+
+    bool RoundTrip(NamedPipeHandle const& client, std::array<std::byte, MessageSize>& buffer) noexcept
+    {
+        return PipeSend(client, buffer) == MessageSize && PipeReceive(client, buffer) == MessageSize;
+    }
+
+    /*
+     * @brief `range(0)` connected clients each with one 64 byte message in flight per iteration
+     */
+    void BM_PipeMessages(benchmark::State& state)
+    {
+        auto const clients = static_cast<std::size_t>(state.range(0));
+
+        EchoServer server(PipeServer::DefaultInstances);
+        if (!server.Valid())
+        {
+            state.SkipWithError("server setup failed");
+            return;
+        }
+
+        {
+            std::vector<NamedPipeHandle> connections(clients);
+            for (auto& connection : connections)
+            {
+                connection = PipeConnect(ServerName());
+                if (!connection.Valid())
+                {
+                    state.SkipWithError("connect failed");
+                    return;
+                }
+            }
+
+            std::array<std::byte, MessageSize> buffer{};
+            for (auto _ : state)
+            {
+                for (auto const& connection : connections)
+                {
+                    if (PipeSend(connection, buffer) != MessageSize)
+                    {
+                        state.SkipWithError("send failed");
+                        return;
+                    }
+                }
+
+                for (auto const& connection : connections)
+                {
+                    if (PipeReceive(connection, buffer) != MessageSize)
+                    {
+                        state.SkipWithError("echo failed");
+                        return;
+                    }
+                }
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * clients));
+        }
+    }
+
+    /*
+     * @brief Connect plus first round trip of a new client, with `range(0)` clients already
+     *        connected and `range(1)` pending instances
+     */
+    void BM_PipeConnect(benchmark::State& state)
+    {
+        auto const clients   = static_cast<std::size_t>(state.range(0));
+        auto const instances = static_cast<std::size_t>(state.range(1));
+
+        EchoServer server(instances);
+        if (!server.Valid())
+        {
+            state.SkipWithError("server setup failed");
+            return;
+        }
+
+        {
+            std::vector<NamedPipeHandle> idle(clients);
+            for (auto& connection : idle)
+            {
+                connection = PipeConnect(ServerName());
+                if (!connection.Valid())
+                {
+                    state.SkipWithError("connect failed");
+                    return;
+                }
+            }
+
+            auto const name = ServerName();
+            std::array<std::byte, MessageSize> buffer{};
+            std::vector<double> latencies;
+
+            for (auto _ : state)
+            {
+                auto const start  = std::chrono::steady_clock::now();
+                auto const client = PipeConnect(name);
+                if (!client.Valid() || !RoundTrip(client, buffer))
+                {
+                    state.SkipWithError("connect failed");
+                    return;
+                }
+
+                latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            state.counters["p50_us"] = latencies[latencies.size() / 2];
+            state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+        }
+    }
+}
+
+BENCHMARK(BM_PipeMessages)->RangeMultiplier(10)->Range(1, 1000)->UseRealTime();
+BENCHMARK(BM_PipeConnect)->ArgsProduct({ { 1, 10, 100, 1000 }, { 1, PipeServer::DefaultInstances } })->UseRealTime();
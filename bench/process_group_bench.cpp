@@ -0,0 +1,126 @@
+#include "process_group.hpp"
+#include "process_spawn.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    constexpr std::string_view TrivialArguments[] = { "/c", "exit", "0" };
+    constexpr wchar_t const*   TrivialProgram     = L"cmd.exe";
+#else
+    constexpr std::string_view TrivialArguments[] = { "-c", "exit 0" };
+    constexpr char const*      TrivialProgram     = "/bin/sh";
+#endif
+
+    /*
+     * @brief Trivial child, suspended on Windows so it is assigned before it runs
+     */
+    SpawnedProcess SpawnChild()
+    {
+        SpawnOptions options;
+        options.m_Program   = TrivialProgram;
+        options.m_Arguments = TrivialArguments;
+        options.m_Suspended = true;
+        return Spawn(options);
+    }
+
+    /*
+     * @brief Group under the delegated cgroup root if it accepts a directory, under a fake root in the temp directory otherwise
+     */
+    std::optional<ProcessGroup> MakeGroup()
+    {
+#if defined(_WIN32)
+        std::optional<ProcessGroup> group(std::in_place);
+#else
+        std::optional<ProcessGroup> group(std::in_place, std::string_view{}, ProcessGroup::DefaultRoot());
+        if (!group->Valid())
+        {
+            auto const root = std::filesystem::temp_directory_path() / ("handle_bench_" + std::to_string(::getpid()));
+            std::error_code error;
+            std::filesystem::create_directories(root, error);
+            group.emplace(std::string_view{}, root);
+        }
+#endif
+
+        if (!group->Valid())
+        {
+            group.reset();
+        }
+
+        return group;
+    }
+
+    /*
+     * @brief Baseline, spawn of a trivial child and wait for its exit
+     */
+    void BM_SpawnUnassigned(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            auto child = SpawnChild();
+            if (!child.Valid())
+            {
+                state.SkipWithError("spawn failed");
+                return;
+            }
+
+            child.Resume();
+            child.Wait();
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /*
+     * @brief Same child moved into a ProcessGroup with limits set before it runs its command
+     */
+    void BM_SpawnAssign(benchmark::State& state)
+    {
+        auto group = MakeGroup();
+        if (!group)
+        {
+            state.SkipWithError("group setup failed");
+            return;
+        }
+
+        // Limits whose controller is disabled fail, the assignment cost stays the same
+        (void)group->SetActiveProcessLimit(64);
+        (void)group->SetMemoryLimit(std::uint64_t(256) << 20);
+        group->SetKillOnClose(true);
+
+        for (auto _ : state)
+        {
+            auto child = SpawnChild();
+            if (!child.Valid())
+            {
+                state.SkipWithError("spawn failed");
+                return;
+            }
+
+            if (!group->Assign(child.m_Process))
+            {
+                state.SkipWithError("assign failed");
+                return;
+            }
+
+            child.Resume();
+            child.Wait();
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_SpawnUnassigned)->UseRealTime();
+BENCHMARK(BM_SpawnAssign)->UseRealTime();
@@ -0,0 +1,249 @@
+#include "process_snapshot.hpp"
+#include "process_spawn.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /*
+     * @brief Idle children raising the process count, shared by all benchmarks and killed at exit
+     */
+    class Population
+    {
+    private:
+        std::vector<SpawnedProcess> m_Children;
+
+        Population() = default;
+
+        ~Population()
+        {
+            Shrink(0);
+        }
+
+        void Shrink(std::size_t count) noexcept
+        {
+            while (m_Children.size() > count)
+            {
+                auto& child = m_Children.back();
+#if defined(_WIN32)
+                ::TerminateProcess(child.m_Process, 0);
+#else
+                ::syscall(SYS_pidfd_send_signal, child.m_Process.Get(), SIGKILL, nullptr, 0);
+#endif
+                child.Wait();
+                m_Children.pop_back();
+            }
+        }
+
+    public:
+        static Population& Instance()
+        {
+            static Population population;
+            return population;
+        }
+
+        /*
+         * @brief Grows or shrinks the population to `count` children
+         */
+        bool Resize(std::size_t count)
+        {
+            Shrink(count);
+
+#if defined(_WIN32)
+            static constexpr std::string_view Arguments[] = { "/c", "exit", "0" };
+
+            SpawnOptions options;
+            options.m_Program   = L"cmd.exe";
+            options.m_Arguments = Arguments;
+            // Never resumed, a suspended child costs no CPU
+            options.m_Suspended = true;
+#else
+            static constexpr std::string_view Arguments[] = { "3600" };
+
+            SpawnOptions options;
+            options.m_Program   = "/bin/sleep";
+            options.m_Arguments = Arguments;
+#endif
+
+            while (m_Children.size() < count)
+            {
+                auto child = Spawn(options);
+                if (!child.Valid())
+                {
+                    return false;
+                }
+
+                m_Children.push_back(std::move(child));
+            }
+
+            return true;
+        }
+    };
+
+    bool Populate(benchmark::State& state)
+    {
+        if (!Population::Instance().Resize(static_cast<std::size_t>(state.range(0))))
+        {
+            state.SkipWithError("spawn failed");
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+     * @brief Walk over every process with `range(0)` extra processes running
+     */
+    void BM_SnapshotProcesses(benchmark::State& state)
+    {
+        if (!Populate(state))
+        {
+            return;
+        }
+
+        std::size_t processes = 0;
+        for (auto _ : state)
+        {
+            ProcessSnapshot snapshot(SnapshotContents::Processes);
+
+            processes = 0;
+            std::uint64_t threads = 0;
+            for (auto const& process : snapshot.Processes())
+            {
+                threads += process.m_Threads;
+                ++processes;
+            }
+
+            benchmark::DoNotOptimize(threads);
+        }
+
+        state.counters["processes"] = static_cast<double>(processes);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * processes));
+    }
+
+    /*
+     * @brief Same walk repeated on one snapshot, the cost once its buffers exist
+     */
+    void BM_SnapshotProcessesReused(benchmark::State& state)
+    {
+        if (!Populate(state))
+        {
+            return;
+        }
+
+        ProcessSnapshot snapshot(SnapshotContents::Processes);
+        std::size_t processes = 0;
+        for (auto _ : state)
+        {
+            processes = 0;
+            for (auto const& process : snapshot.Processes())
+            {
+                benchmark::DoNotOptimize(process.m_ProcessId);
+                ++processes;
+            }
+        }
+
+        state.counters["processes"] = static_cast<double>(processes);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * processes));
+    }
+
+    /*
+     * @brief Walk over every thread of the system
+     */
+    void BM_SnapshotThreads(benchmark::State& state)
+    {
+        if (!Populate(state))
+        {
+            return;
+        }
+
+        ProcessSnapshot snapshot(SnapshotContents::Threads);
+        std::size_t threads = 0;
+        for (auto _ : state)
+        {
+            threads = 0;
+            for (auto const& thread : snapshot.Threads())
+            {
+                benchmark::DoNotOptimize(thread.m_ThreadId);
+                ++threads;
+            }
+        }
+
+        state.counters["threads"] = static_cast<double>(threads);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * threads));
+    }
+
+    /*
+     * @brief Modules of the benchmark process
+     */
+    void BM_SnapshotModules(benchmark::State& state)
+    {
+        std::size_t modules = 0;
+        for (auto _ : state)
+        {
+            ProcessSnapshot snapshot(SnapshotContents::Modules);
+
+            modules = 0;
+            for (auto const& module : snapshot.Modules())
+            {
+                benchmark::DoNotOptimize(module.m_Base);
+                ++modules;
+            }
+        }
+
+        state.counters["modules"] = static_cast<double>(modules);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * modules));
+    }
+
+#if defined(_WIN32)
+    /*
+     * @brief The bulk NtQuerySystemInformation path over the same processes
+     */
+    void BM_SystemProcessList(benchmark::State& state)
+    {
+        if (!Populate(state))
+        {
+            return;
+        }
+
+        SystemProcessList list;
+        std::size_t processes = 0;
+        for (auto _ : state)
+        {
+            if (!list.Refresh())
+            {
+                state.SkipWithError("query failed");
+                return;
+            }
+
+            processes = 0;
+            for (auto const& process : list)
+            {
+                benchmark::DoNotOptimize(process.m_ProcessId);
+                ++processes;
+            }
+        }
+
+        state.counters["processes"] = static_cast<double>(processes);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * processes));
+    }
+
+    BENCHMARK(BM_SystemProcessList)->Arg(0)->Arg(1000)->Arg(10000)->UseRealTime();
+#endif
+}
+
+BENCHMARK(BM_SnapshotProcesses)->Arg(0)->Arg(1000)->Arg(10000)->UseRealTime();
+BENCHMARK(BM_SnapshotProcessesReused)->Arg(0)->Arg(1000)->Arg(10000)->UseRealTime();
+BENCHMARK(BM_SnapshotThreads)->Arg(0)->Arg(1000)->Arg(10000)->UseRealTime();
+BENCHMARK(BM_SnapshotModules)->UseRealTime();
@@ -0,0 +1,131 @@
+#include "process_spawn.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    constexpr std::string_view TrivialArguments[] = { "/c", "exit", "0" };
+    constexpr wchar_t const*   TrivialProgram     = L"cmd.exe";
+#else
+    constexpr std::string_view TrivialArguments[] = { "-c", "exit 0" };
+    constexpr char const*      TrivialProgram     = "/bin/sh";
+#endif
+
+    /*
+     * @brief `count` pipe ends to hand to the children
+     */
+    std::vector<NamedPipeHandle> MakeInheritable(std::size_t count)
+    {
+        std::vector<NamedPipeHandle> pipes;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+#if defined(_WIN32)
+            HANDLE readEnd, writeEnd;
+            if (::CreatePipe(&readEnd, &writeEnd, nullptr, 0))
+            {
+                pipes.emplace_back(readEnd);
+                pipes.emplace_back(writeEnd);
+            }
+#else
+            int fds[2];
+            if (::pipe2(fds, O_CLOEXEC) == 0)
+            {
+                pipes.emplace_back(fds[0]);
+                pipes.emplace_back(fds[1]);
+            }
+#endif
+        }
+
+        pipes.resize(count);
+        return pipes;
+    }
+
+    /*
+     * @brief Spawn and wait of a trivial child inheriting `range(0)` handles
+     */
+    void BM_SpawnWait(benchmark::State& state)
+    {
+        auto const pipes = MakeInheritable(static_cast<std::size_t>(state.range(0)));
+
+        std::vector<NativeHandle> inherit;
+        for (auto const& pipe : pipes)
+        {
+            inherit.push_back(pipe.Get());
+        }
+
+        SpawnOptions options;
+        options.m_Program   = TrivialProgram;
+        options.m_Arguments = TrivialArguments;
+        options.m_Inherit   = inherit;
+
+        for (auto _ : state)
+        {
+            auto child = Spawn(options);
+            if (!child.Valid() || child.Wait() != 0)
+            {
+                state.SkipWithError("spawn failed");
+                return;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /*
+     * @brief Baseline, the unrestricted spawn every handle leaks into: CreateProcess with
+     *        inheritance on, fork and exec on Linux
+     */
+    void BM_InheritAllWait(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+#if defined(_WIN32)
+            wchar_t command[] = L"cmd.exe /c exit 0";
+            STARTUPINFOW startup{ sizeof(startup) };
+            PROCESS_INFORMATION information{};
+            if (!::CreateProcessW(nullptr, command, nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &information))
+            {
+                state.SkipWithError("spawn failed");
+                return;
+            }
+
+            ProcessHandle process(information.hProcess);
+            ThreadHandle thread(information.hThread);
+            ::WaitForSingleObject(process, INFINITE);
+#else
+            pid_t const pid = ::fork();
+            if (pid == 0)
+            {
+                ::execl(TrivialProgram, TrivialProgram, TrivialArguments[0].data(), TrivialArguments[1].data(), nullptr);
+                ::_exit(127);
+            }
+
+            if (pid < 0)
+            {
+                state.SkipWithError("fork failed");
+                return;
+            }
+
+            int status = 0;
+            ::waitpid(pid, &status, 0);
+#endif
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_SpawnWait)->Arg(0)->Arg(1)->Arg(8)->UseRealTime();
+BENCHMARK(BM_InheritAllWait)->UseRealTime();
@@ -0,0 +1,89 @@
+#include "shared_handle.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+namespace
+{
+    using Port = IoCompletionPortHandle;
+
+    SharedHandle<TaggedHandle<HandleType::IoCompletionPort>>& SharedPort()
+    {
+        static SharedHandle shared{ Port(Bench::Factory<Port>::Open()) };
+        return shared;
+    }
+
+    /*
+     * @brief The usual std::shared_ptr<void> wrapping of a raw handle with a closing deleter
+     */
+    std::shared_ptr<void>& StdSharedPort()
+    {
+        static std::shared_ptr<void> shared(
+            reinterpret_cast<void*>(HandleToBits(Bench::Factory<Port>::Open())),
+            [](void* handle) { Port::Traits::Close(HandleFromBits<Port::Type>(reinterpret_cast<std::intptr_t>(handle))); });
+        return shared;
+    }
+
+    void BM_SharedHandleCopy(benchmark::State& state)
+    {
+        auto const& shared = SharedPort();
+
+        for (auto _ : state)
+        {
+            auto copy = shared;
+            benchmark::DoNotOptimize(copy.Get());
+        }
+    }
+
+    void BM_StdSharedPtrCopy(benchmark::State& state)
+    {
+        auto const& shared = StdSharedPort();
+
+        for (auto _ : state)
+        {
+            auto copy = shared;
+            benchmark::DoNotOptimize(copy.get());
+        }
+    }
+
+    void BM_WeakHandleLock(benchmark::State& state)
+    {
+        WeakHandle weak = SharedPort();
+
+        for (auto _ : state)
+        {
+            auto locked = weak.Lock();
+            benchmark::DoNotOptimize(locked.Get());
+        }
+    }
+
+    void BM_StdWeakPtrLock(benchmark::State& state)
+    {
+        std::weak_ptr<void> weak = StdSharedPort();
+
+        for (auto _ : state)
+        {
+            auto locked = weak.lock();
+            benchmark::DoNotOptimize(locked.get());
+        }
+    }
+
+    void BM_LocalSharedHandleCopy(benchmark::State& state)
+    {
+        LocalSharedHandle<TaggedHandle<HandleType::IoCompletionPort>> shared{ Port(Bench::Factory<Port>::Open()) };
+
+        for (auto _ : state)
+        {
+            auto copy = shared;
+            benchmark::DoNotOptimize(copy.Get());
+        }
+    }
+}
+
+BENCHMARK(BM_SharedHandleCopy)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_StdSharedPtrCopy)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_WeakHandleLock)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_StdWeakPtrLock)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_LocalSharedHandleCopy);
@@ -0,0 +1,247 @@
+#include "shared_ring.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::string RingName(char const* role)
+    {
+#if defined(_WIN32)
+        return "handle_bench_" + std::to_string(::_getpid()) + "_" + role;
+#else
+        return "handle_bench_" + std::to_string(::getpid()) + "_" + role;
+#endif
+    }
+
+    /*
+     * @brief Consumer thread on its own opening of the ring, counting what it drained
+     *
+     * A consumer in another process maps the same region, the thread keeps the benchmark
+     * self-contained.
+     */
+    template<RingProducers _Producers>
+    struct Drain
+    {
+        SharedRing<_Producers>     m_Ring;
+        std::atomic<std::uint64_t> m_Received{ 0 };
+        std::atomic<bool>          m_Stop{ false };
+        std::thread                m_Thread;
+
+        explicit Drain(std::string const& name)
+            : m_Ring(name)
+        {
+            if (!m_Ring.Valid())
+            {
+                return;
+            }
+
+            m_Thread = std::thread([this]
+            {
+                std::uint64_t checksum = 0;
+                while (!m_Stop.load(std::memory_order_relaxed))
+                {
+                    auto const count = m_Ring.Receive([&](std::span<std::byte const> message)
+                    {
+                        checksum += static_cast<std::uint64_t>(message.front());
+                    }, 10);
+
+                    m_Received.fetch_add(count, std::memory_order_release);
+                }
+
+                benchmark::DoNotOptimize(checksum);
+            });
+        }
+
+        void WaitFor(std::uint64_t sent) noexcept
+        {
+            while (m_Received.load(std::memory_order_acquire) < sent)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        ~Drain()
+        {
+            m_Stop = true;
+            if (m_Thread.joinable())
+            {
+                m_Thread.join();
+            }
+        }
+    };
+
+    template<RingProducers _Producers>
+    void RingThroughput(benchmark::State& state)
+    {
+        auto const size = static_cast<std::size_t>(state.range(0));
+        auto const name = RingName("throughput");
+
+        SharedRing<_Producers> ring(name, SharedRing<_Producers>::DefaultCapacity);
+        if (!ring.Valid())
+        {
+            state.SkipWithError("ring setup failed");
+            return;
+        }
+
+        Drain<_Producers> drain(name);
+        SharedRing<_Producers> producer(name);
+        if (!drain.m_Ring.Valid() || !producer.Valid())
+        {
+            state.SkipWithError("ring open failed");
+            return;
+        }
+
+        std::vector<std::byte> message(size, std::byte{ 1 });
+        for (auto _ : state)
+        {
+            producer.Send(message);
+        }
+
+        drain.WaitFor(state.iterations());
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(size));
+    }
+
+    /*
+     * @brief One producer streaming `range(0)` byte messages to a consumer thread
+     */
+    void BM_SpscRingThroughput(benchmark::State& state)
+    {
+        RingThroughput<RingProducers::Single>(state);
+    }
+
+    /*
+     * @brief Same stream through the multi-producer layout, CAS reservation and zeroing included
+     */
+    void BM_MpscRingThroughput(benchmark::State& state)
+    {
+        RingThroughput<RingProducers::Multiple>(state);
+    }
+
+    /*
+     * @brief Baseline, the same stream through an anonymous pipe
+     */
+    void BM_PipeThroughput(benchmark::State& state)
+    {
+        auto const size = static_cast<std::size_t>(state.range(0));
+
+#if defined(_WIN32)
+        HANDLE readEnd, writeEnd;
+        if (!::CreatePipe(&readEnd, &writeEnd, nullptr, 1 << 20))
+        {
+            state.SkipWithError("pipe setup failed");
+            return;
+        }
+
+        NamedPipeHandle reader(readEnd), writer(writeEnd);
+#else
+        int fds[2];
+        if (::pipe2(fds, O_CLOEXEC) != 0)
+        {
+            state.SkipWithError("pipe setup failed");
+            return;
+        }
+
+        NamedPipeHandle reader(fds[0]), writer(fds[1]);
+#endif
+
+        std::thread drain([&]
+        {
+            std::vector<std::byte> buffer(64 << 10);
+            for (;;)
+            {
+#if defined(_WIN32)
+                DWORD read = 0;
+                if (!::ReadFile(reader.Get(), buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) || read == 0)
+                {
+                    break;
+                }
+#else
+                if (::read(reader.Get(), buffer.data(), buffer.size()) <= 0)
+                {
+                    break;
+                }
+#endif
+            }
+        });
+
+        std::vector<std::byte> message(size, std::byte{ 1 });
+        for (auto _ : state)
+        {
+#if defined(_WIN32)
+            DWORD written = 0;
+            ::WriteFile(writer.Get(), message.data(), static_cast<DWORD>(size), &written, nullptr);
+#else
+            benchmark::DoNotOptimize(::write(writer.Get(), message.data(), size));
+#endif
+        }
+
+        writer.Close();
+        drain.join();
+
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(size));
+    }
+
+    /*
+     * @brief Round trip of a `range(0)` byte message through two SPSC rings and an echo thread
+     */
+    void BM_SpscRingRoundTrip(benchmark::State& state)
+    {
+        auto const size = static_cast<std::size_t>(state.range(0));
+        auto const requestName  = RingName("request");
+        auto const responseName = RingName("response");
+
+        SpscRing requests(requestName, SpscRing::DefaultCapacity);
+        SpscRing responses(responseName, SpscRing::DefaultCapacity);
+        if (!requests.Valid() || !responses.Valid())
+        {
+            state.SkipWithError("ring setup failed");
+            return;
+        }
+
+        std::atomic<bool> stop{ false };
+        std::thread echo([&]
+        {
+            SpscRing in(requestName);
+            SpscRing out(responseName);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                in.Receive([&](std::span<std::byte const> message) { out.Send(message); }, 10);
+            }
+        });
+
+        std::vector<std::byte> message(size, std::byte{ 1 });
+        for (auto _ : state)
+        {
+            requests.Send(message);
+            while (responses.Receive([](std::span<std::byte const>) {}) == 0)
+            {
+            }
+        }
+
+        stop = true;
+        echo.join();
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_SpscRingThroughput)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+BENCHMARK(BM_MpscRingThroughput)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+BENCHMARK(BM_PipeThroughput)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+BENCHMARK(BM_SpscRingRoundTrip)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
@@ -0,0 +1,146 @@
+#include "socket_io.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t PacketSize = 64;
+
+    /*
+     * @brief Two UDP sockets on 127.0.0.1 connected to each other
+     */
+    struct UdpPair
+    {
+        SocketHandle m_Sender;
+        SocketHandle m_Receiver;
+
+        UdpPair()
+        {
+            if (!SocketStartup())
+            {
+                return;
+            }
+
+            SocketHandle sender(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+            SocketHandle receiver(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+            if (!sender.Valid() || !receiver.Valid())
+            {
+                return;
+            }
+
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            sockaddr_in senderAddress   = address;
+            sockaddr_in receiverAddress = address;
+            SocketLength length         = sizeof(address);
+
+            if (::bind(sender, reinterpret_cast<sockaddr*>(&senderAddress), length) != 0
+                || ::bind(receiver, reinterpret_cast<sockaddr*>(&receiverAddress), length) != 0
+                || ::getsockname(sender, reinterpret_cast<sockaddr*>(&senderAddress), &length) != 0
+                || ::getsockname(receiver, reinterpret_cast<sockaddr*>(&receiverAddress), &length) != 0
+                || ::connect(sender, reinterpret_cast<sockaddr*>(&receiverAddress), length) != 0
+                || ::connect(receiver, reinterpret_cast<sockaddr*>(&senderAddress), length) != 0)
+            {
+                return;
+            }
+
+            m_Sender   = std::move(sender);
+            m_Receiver = std::move(receiver);
+        }
+
+        [[nodiscard]] bool Valid() const noexcept
+        {
+            return m_Sender.Valid() && m_Receiver.Valid();
+        }
+    };
+
+    /*
+     * @brief Baseline, one send and one receive call per datagram, `range(0)` in flight
+     */
+    void BM_UdpPerPacket(benchmark::State& state)
+    {
+        auto const batch = static_cast<std::size_t>(state.range(0));
+
+        UdpPair pair;
+        if (!pair.Valid())
+        {
+            state.SkipWithError("UDP loopback setup failed");
+            return;
+        }
+
+        char payload[PacketSize] = {};
+        char buffer[PacketSize];
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                benchmark::DoNotOptimize(::send(pair.m_Sender, payload, sizeof(payload), 0));
+            }
+
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                benchmark::DoNotOptimize(::recv(pair.m_Receiver, buffer, sizeof(buffer), 0));
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batch));
+    }
+
+    /*
+     * @brief `range(0)` datagrams per SendDatagrams / ReceiveDatagrams call
+     */
+    void BM_UdpBatched(benchmark::State& state)
+    {
+        auto const batch = static_cast<std::size_t>(state.range(0));
+
+        UdpPair pair;
+        if (!pair.Valid())
+        {
+            state.SkipWithError("UDP loopback setup failed");
+            return;
+        }
+
+        std::vector<char> payload(PacketSize);
+        std::vector<char> buffers(PacketSize * batch);
+        std::vector<Datagram> outgoing(batch);
+        std::vector<Datagram> incoming(batch);
+
+        for (std::size_t i = 0; i < batch; ++i)
+        {
+            outgoing[i].m_Buffer = MakeSocketBuffer(payload.data(), PacketSize);
+            incoming[i].m_Buffer = MakeSocketBuffer(buffers.data() + i * PacketSize, PacketSize);
+        }
+
+        for (auto _ : state)
+        {
+            auto const sent = SendDatagrams(pair.m_Sender, outgoing);
+
+            for (std::int64_t received = 0; received < sent;)
+            {
+                auto const count = ReceiveDatagrams(pair.m_Receiver, std::span(incoming).first(static_cast<std::size_t>(sent - received)));
+                if (count < 0)
+                {
+                    state.SkipWithError("ReceiveDatagrams failed");
+                    return;
+                }
+
+                received += count;
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batch));
+    }
+}
+
+BENCHMARK(BM_UdpPerPacket)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_UdpBatched)->Arg(8)->Arg(32)->Arg(64);
@@ -0,0 +1,148 @@
+#include "thread_pool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int         FibonacciN       = 30;
+    constexpr int         SerialCutoff     = 16;
+    constexpr std::size_t FineGrainedTasks = 100'000;
+
+    std::uint64_t SerialFibonacci(int n) noexcept
+    {
+        return n < 2 ? static_cast<std::uint64_t>(n) : SerialFibonacci(n - 1) + SerialFibonacci(n - 2);
+    }
+
+    struct Fibonacci
+    {
+        PoolTask      m_Task;
+        ThreadPool&   m_Pool;
+        int           m_N;
+        std::uint64_t m_Result = 0;
+    };
+
+    /*
+     * @brief Forks fib(n - 1) as a task, computes fib(n - 2) inline, then joins
+     */
+    std::uint64_t ParallelFibonacci(ThreadPool& pool, int n) noexcept
+    {
+        if (n < SerialCutoff)
+        {
+            return SerialFibonacci(n);
+        }
+
+        Fibonacci child{ {}, pool, n - 1 };
+        child.m_Task.m_Context = &child;
+        child.m_Task.m_Run     = [](PoolTask& task) noexcept
+        {
+            auto& self = *static_cast<Fibonacci*>(task.m_Context);
+            self.m_Result = ParallelFibonacci(self.m_Pool, self.m_N);
+        };
+
+        TaskGroup group(pool);
+        group.Run(child.m_Task);
+        auto const other = ParallelFibonacci(pool, n - 2);
+        group.Wait();
+
+        return child.m_Result + other;
+    }
+
+    /*
+     * @brief Baseline for the fork-join runs, fib(30) on the calling thread
+     */
+    void BM_SerialFibonacci(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(SerialFibonacci(FibonacciN));
+        }
+    }
+
+    /*
+     * @brief Recursive fork-join fib(30) with `range(0)` workers, the root forked from the pool
+     */
+    void BM_ForkJoinFibonacci(benchmark::State& state)
+    {
+        ThreadPool pool(static_cast<unsigned>(state.range(0)));
+        if (!pool.Valid())
+        {
+            state.SkipWithError("pool setup failed");
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            Fibonacci root{ {}, pool, FibonacciN };
+            root.m_Task.m_Context = &root;
+            root.m_Task.m_Run     = [](PoolTask& task) noexcept
+            {
+                auto& self = *static_cast<Fibonacci*>(task.m_Context);
+                self.m_Result = ParallelFibonacci(self.m_Pool, self.m_N);
+            };
+
+            TaskGroup group(pool);
+            group.Run(root.m_Task);
+            group.Wait();
+            benchmark::DoNotOptimize(root.m_Result);
+        }
+    }
+
+    /*
+     * @brief 100k tasks of a few nanoseconds each submitted from outside the pool, `range(0)` workers
+     */
+    void BM_FineGrainedTasks(benchmark::State& state)
+    {
+        ThreadPool pool(static_cast<unsigned>(state.range(0)));
+        if (!pool.Valid())
+        {
+            state.SkipWithError("pool setup failed");
+            return;
+        }
+
+        std::atomic<std::uint64_t> sum = 0;
+        std::vector<PoolTask> tasks(FineGrainedTasks);
+        for (auto& task : tasks)
+        {
+            task.m_Context = &sum;
+            task.m_Run     = [](PoolTask& self) noexcept
+            {
+                static_cast<std::atomic<std::uint64_t>*>(self.m_Context)->fetch_add(1, std::memory_order_relaxed);
+            };
+        }
+
+        for (auto _ : state)
+        {
+            TaskGroup group(pool);
+            for (auto& task : tasks)
+            {
+                group.Run(task);
+            }
+
+            group.Wait();
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * FineGrainedTasks));
+    }
+
+    void WorkerCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        auto const cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned workers = 1; workers < cores; workers *= 2)
+        {
+            benchmark->Arg(workers);
+        }
+
+        benchmark->Arg(cores);
+    }
+}
+
+BENCHMARK(BM_SerialFibonacci)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ForkJoinFibonacci)->Apply(WorkerCounts)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FineGrainedTasks)->Apply(WorkerCounts)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,203 @@
+#include "timer_wheel.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t Timers = 1'000'000;
+
+    void Ignore(TimerNode&) noexcept
+    {
+    }
+
+    /*
+     * @brief `count` nodes scheduled between 1 and 60 seconds out, like idle connection timeouts
+     */
+    std::unique_ptr<TimerNode[]> Preload(TimerWheel& wheel, std::size_t count)
+    {
+        std::unique_ptr<TimerNode[]> nodes(new TimerNode[count]);
+        std::mt19937_64 random(1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            nodes[i].m_Expired = Ignore;
+            wheel.Schedule(nodes[i], std::chrono::milliseconds(1000 + random() % 59'000));
+        }
+
+        return nodes;
+    }
+
+    /*
+     * @brief Schedule plus cancel of one timer with `range(0)` others pending
+     */
+    void BM_TimerScheduleCancel(benchmark::State& state)
+    {
+        TimerWheel wheel;
+        if (!wheel.Valid())
+        {
+            state.SkipWithError("timer setup failed");
+            return;
+        }
+
+        auto const count = static_cast<std::size_t>(state.range(0));
+        auto const nodes = Preload(wheel, count);
+
+        TimerNode node{ Ignore };
+        std::mt19937_64 random(2);
+        for (auto _ : state)
+        {
+            wheel.Schedule(node, std::chrono::milliseconds(1000 + random() % 59'000));
+            wheel.Cancel(node);
+        }
+
+        // The nodes go first, the wheel must not hold them then
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            wheel.Cancel(nodes[i]);
+        }
+
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    /*
+     * @brief Baseline, the same with an ordered multimap of deadlines
+     */
+    void BM_MultimapScheduleCancel(benchmark::State& state)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::multimap<Clock::time_point, TimerNode*> timers;
+        std::vector<TimerNode> nodes(static_cast<std::size_t>(state.range(0)));
+        std::mt19937_64 random(1);
+        for (auto& node : nodes)
+        {
+            timers.emplace(Clock::now() + std::chrono::milliseconds(1000 + random() % 59'000), &node);
+        }
+
+        TimerNode node{ Ignore };
+        for (auto _ : state)
+        {
+            auto const position = timers.emplace(Clock::now() + std::chrono::milliseconds(1000 + random() % 59'000), &node);
+            timers.erase(position);
+        }
+
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    /*
+     * @brief Scheduling then cancelling 1M timers
+     */
+    void BM_TimerScheduleAll(benchmark::State& state)
+    {
+        TimerWheel wheel;
+        std::unique_ptr<TimerNode[]> nodes(new TimerNode[Timers]);
+        std::vector<std::chrono::milliseconds> delays(Timers);
+
+        std::mt19937_64 random(1);
+        for (auto& delay : delays)
+        {
+            delay = std::chrono::milliseconds(1000 + random() % 59'000);
+        }
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < Timers; ++i)
+            {
+                nodes[i].m_Expired = Ignore;
+                wheel.Schedule(nodes[i], delays[i]);
+            }
+
+            for (std::size_t i = 0; i < Timers; ++i)
+            {
+                wheel.Cancel(nodes[i]);
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * Timers * 2));
+    }
+
+    struct JitterTimer
+    {
+        TimerNode                              m_Node;
+        TimerWheel::Clock::time_point          m_Due;
+        std::vector<std::chrono::nanoseconds>* m_Lateness;
+    };
+
+    /*
+     * @brief 1M timers due within ten seconds, expired through the kernel timer; `range(0)` is
+     *        the coalescing tolerance in milliseconds
+     *
+     * Lateness is measured from the requested deadline. It includes the tick rounding, the
+     * tolerance and the wakeup delay. The tail also holds the cascades, each re-placing the
+     * ~25k timers of the next 256 ticks in one go.
+     */
+    void BM_TimerExpiryJitter(benchmark::State& state)
+    {
+        auto const tolerance = std::chrono::milliseconds(state.range(0));
+
+        for (auto _ : state)
+        {
+            TimerWheel wheel;
+            if (!wheel.Valid())
+            {
+                state.SkipWithError("timer setup failed");
+                return;
+            }
+
+            std::vector<std::chrono::nanoseconds> lateness;
+            lateness.reserve(Timers);
+
+            std::unique_ptr<JitterTimer[]> timers(new JitterTimer[Timers]);
+            std::mt19937_64 random(3);
+
+            // Past the setup, so no timer is due before the loop runs
+            auto const start = TimerWheel::Clock::now() + std::chrono::milliseconds(200);
+            for (std::size_t i = 0; i < Timers; ++i)
+            {
+                auto& timer = timers[i];
+                timer.m_Node.m_Context = &timer;
+                timer.m_Node.m_Expired = [](TimerNode& node) noexcept
+                {
+                    auto const& timer = *static_cast<JitterTimer const*>(node.m_Context);
+                    timer.m_Lateness->push_back(TimerWheel::Clock::now() - timer.m_Due);
+                };
+
+                timer.m_Due      = start + std::chrono::microseconds(random() % 10'000'000);
+                timer.m_Lateness = &lateness;
+                wheel.ScheduleAt(timer.m_Node, timer.m_Due, tolerance);
+            }
+
+            std::size_t wakeups = 0;
+            while (wheel.Size() != 0)
+            {
+                wakeups += wheel.Run() != 0;
+            }
+
+            std::sort(lateness.begin(), lateness.end());
+            auto const microseconds = [&](std::size_t index)
+            {
+                return std::chrono::duration<double, std::micro>(lateness[index]).count();
+            };
+
+            state.counters["wakeups"] = static_cast<double>(wakeups);
+            state.counters["p50_us"]  = microseconds(lateness.size() / 2);
+            state.counters["p99_us"]  = microseconds(lateness.size() * 99 / 100);
+            state.counters["max_us"]  = microseconds(lateness.size() - 1);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * Timers));
+    }
+}
+
+BENCHMARK(BM_TimerScheduleCancel)->Arg(0)->Arg(Timers);
+BENCHMARK(BM_MultimapScheduleCancel)->Arg(0)->Arg(Timers);
+BENCHMARK(BM_TimerScheduleAll)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TimerExpiryJitter)->Arg(0)->Arg(4)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,47 @@
+#include "handle.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+/*
+ * Built three times: into handle_bench (tracking compiled out), handle_bench_tracking
+ * (HANDLE_ENABLE_TRACKING) and handle_bench_call_sites (plus HANDLE_TRACK_CALL_SITES).
+ * Comparing the same benchmark across the binaries gives the per-handle instrumentation cost.
+ */
+namespace
+{
+    void BM_TrackedConstructClose(benchmark::State& state)
+    {
+        std::intptr_t value = 0;
+
+        for (auto _ : state)
+        {
+            Handle<Bench::FakeValue> handle(static_cast<Bench::FakeValue>(value++));
+            benchmark::DoNotOptimize(handle.Get());
+        }
+    }
+
+    void BM_TrackedConstructRelease(benchmark::State& state)
+    {
+        std::intptr_t value = 0;
+
+        for (auto _ : state)
+        {
+            Handle<Bench::FakeValue> handle(static_cast<Bench::FakeValue>(value++));
+            benchmark::DoNotOptimize(handle.Release());
+        }
+    }
+
+    void BM_TrackedSnapshot(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            auto census = HandleTracker::Snapshot(true);
+            benchmark::DoNotOptimize(census.m_Tags.data());
+        }
+    }
+}
+
+BENCHMARK(BM_TrackedConstructClose)->ThreadRange(1, 8);
+BENCHMARK(BM_TrackedConstructRelease);
+BENCHMARK(BM_TrackedSnapshot);
@@ -0,0 +1,247 @@
+#include "transmit_file.hpp"
+#include "socket_io.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t CopyBufferSize = 64 * 1024;
+
+    std::filesystem::path FileOfSize(std::int64_t size)
+    {
+        auto const path = std::filesystem::temp_directory_path() / ("handle_bench_transmit_" + std::to_string(size) + ".bin");
+
+        std::error_code error;
+        if (std::filesystem::file_size(path, error) != static_cast<std::uintmax_t>(size))
+        {
+            std::vector<char> block(1 << 20, 'x');
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            for (std::int64_t written = 0; written < size; written += static_cast<std::int64_t>(block.size()))
+            {
+                out.write(block.data(), static_cast<std::streamsize>(std::min<std::int64_t>(size - written, static_cast<std::int64_t>(block.size()))));
+            }
+        }
+
+        return path;
+    }
+
+    FileHandle OpenFile(std::filesystem::path const& path) noexcept
+    {
+#if defined(_WIN32)
+        return FileHandle(::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+#else
+        return FileHandle(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+    }
+
+    /*
+     * @brief CPU time of the whole process, both the sender and the draining receiver
+     */
+    std::chrono::nanoseconds ProcessCpuTime() noexcept
+    {
+#if defined(_WIN32)
+        FILETIME creation, exit, kernel, user;
+        ::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+        auto const ticks = [](FILETIME time) { return static_cast<std::int64_t>(time.dwHighDateTime) << 32 | time.dwLowDateTime; };
+        return std::chrono::nanoseconds((ticks(kernel) + ticks(user)) * 100);
+#else
+        rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+
+        return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+             + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+    }
+
+    /*
+     * @brief Loopback TCP connection whose receiving end is drained by a thread
+     */
+    struct DrainedConnection
+    {
+        SocketHandle m_Sender;
+        SocketHandle m_Receiver;
+        std::thread  m_Drain;
+
+        DrainedConnection()
+        {
+            if (!SocketStartup())
+            {
+                return;
+            }
+
+            SocketHandle listener(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            SocketLength length     = sizeof(address);
+
+            if (!listener.Valid()
+                || ::bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0
+                || ::listen(listener, 1) != 0
+                || ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                return;
+            }
+
+            SocketHandle sender(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+            if (!sender.Valid() || ::connect(sender, reinterpret_cast<sockaddr*>(&address), length) != 0)
+            {
+                return;
+            }
+
+            m_Receiver.Reset(::accept(listener, nullptr, nullptr));
+            if (!m_Receiver.Valid())
+            {
+                return;
+            }
+
+            m_Sender = std::move(sender);
+            m_Drain  = std::thread([this]
+            {
+                std::vector<char> buffer(256 * 1024);
+                while (::recv(m_Receiver, buffer.data(), static_cast<int>(buffer.size()), 0) > 0)
+                {
+                }
+            });
+        }
+
+        ~DrainedConnection()
+        {
+            m_Sender.Close();
+            if (m_Drain.joinable())
+            {
+                m_Drain.join();
+            }
+        }
+
+        [[nodiscard]] bool Valid() const noexcept
+        {
+            return m_Sender.Valid() && m_Drain.joinable();
+        }
+    };
+
+    // Stands in for a response header
+    std::byte const Header[256] = {};
+
+    template<typename _Send>
+    void RunTransfer(benchmark::State& state, _Send&& send)
+    {
+        auto const size = state.range(0);
+        auto const file = OpenFile(FileOfSize(size));
+
+        DrainedConnection connection;
+        if (!file.Valid() || !connection.Valid())
+        {
+            state.SkipWithError("setup failed");
+            return;
+        }
+
+        auto const cpuStart  = ProcessCpuTime();
+        auto const wallStart = std::chrono::steady_clock::now();
+
+        for (auto _ : state)
+        {
+            if (!send(connection.m_Sender, file, static_cast<std::uint64_t>(size)))
+            {
+                state.SkipWithError("send failed");
+                return;
+            }
+        }
+
+        auto const wall = std::chrono::steady_clock::now() - wallStart;
+        state.counters["cpu_pct"] = 100.0 * std::chrono::duration<double>(ProcessCpuTime() - cpuStart).count()
+                                  / std::chrono::duration<double>(wall).count();
+        state.SetBytesProcessed(state.iterations() * (size + static_cast<std::int64_t>(sizeof(Header))));
+    }
+
+    /*
+     * @brief Baseline, header then the file through a 64KB user buffer
+     */
+    void BM_ReadSendLoop(benchmark::State& state)
+    {
+        std::vector<char> buffer(CopyBufferSize);
+
+        RunTransfer(state, [&](SocketHandle const& socket, FileHandle const& file, std::uint64_t size)
+        {
+            if (::send(socket, reinterpret_cast<char const*>(Header), sizeof(Header), 0) != static_cast<int>(sizeof(Header)))
+            {
+                return false;
+            }
+
+            for (std::uint64_t offset = 0; offset < size;)
+            {
+#if defined(_WIN32)
+                OVERLAPPED position{};
+                position.Offset     = static_cast<DWORD>(offset);
+                position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+                DWORD read = 0;
+                if (!::ReadFile(file.Get(), buffer.data(), static_cast<DWORD>(buffer.size()), nullptr, &position)
+                    && ::GetLastError() != ERROR_IO_PENDING)
+                {
+                    return false;
+                }
+
+                if (!::GetOverlappedResult(file.Get(), &position, &read, TRUE) || read == 0)
+                {
+                    return false;
+                }
+#else
+                auto const read = ::pread(file.Get(), buffer.data(), buffer.size(), static_cast<off_t>(offset));
+                if (read <= 0)
+                {
+                    return false;
+                }
+#endif
+
+                for (std::size_t sent = 0; sent < static_cast<std::size_t>(read);)
+                {
+                    auto const result = ::send(socket, buffer.data() + sent, static_cast<int>(read - sent), 0);
+                    if (result <= 0)
+                    {
+                        return false;
+                    }
+
+                    sent += static_cast<std::size_t>(result);
+                }
+
+                offset += static_cast<std::uint64_t>(read);
+            }
+
+            return true;
+        });
+    }
+
+    /*
+     * @brief Header and file in one SendFile call
+     */
+    void BM_SendFile(benchmark::State& state)
+    {
+        RunTransfer(state, [](SocketHandle const& socket, FileHandle const& file, std::uint64_t size)
+        {
+            TransmitRequest request{ .m_File = file, .m_Length = size, .m_Header = Header, .m_Trailer = {} };
+            return SendFile(socket, request) == static_cast<std::int64_t>(size + sizeof(Header));
+        });
+    }
+}
+
+BENCHMARK(BM_ReadSendLoop)->RangeMultiplier(16)->Range(4 << 10, 1 << 30)->UseRealTime();
+BENCHMARK(BM_SendFile)->RangeMultiplier(16)->Range(4 << 10, 1 << 30)->UseRealTime();
@@ -0,0 +1,180 @@
+#include "wait_set.hpp"
+#include "bench_factory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void Signal(EventHandle const& event) noexcept
+    {
+#if defined(_WIN32)
+        ::SetEvent(event);
+#else
+        (void)::eventfd_write(event, 1);
+#endif
+    }
+
+    /*
+     * @brief Resets an event reported by the set, auto-reset events were consumed by the wait already
+     */
+    void Consume(EventHandle const& event) noexcept
+    {
+#if defined(_WIN32)
+        (void)event;
+#else
+        eventfd_t value;
+        (void)::eventfd_read(event, &value);
+#endif
+    }
+
+    struct Fixture
+    {
+        std::vector<EventHandle> m_Events;
+        std::vector<std::size_t> m_Indices;
+        WaitSet                  m_Set;
+
+        explicit Fixture(std::size_t count)
+        {
+            m_Events.reserve(count);
+            m_Indices.reserve(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                m_Events.emplace_back(Bench::Factory<EventHandle>::Open());
+                m_Indices.push_back(m_Set.Add(m_Events.back()));
+            }
+        }
+
+        ~Fixture()
+        {
+            for (auto const index : m_Indices)
+            {
+                m_Set.Remove(index);
+            }
+        }
+
+        [[nodiscard]] bool Valid() const noexcept
+        {
+            return m_Set.Valid() && m_Set.Size() == m_Events.size();
+        }
+
+        // Spreads the signaled handle over the whole set
+        [[nodiscard]] std::size_t Pick(std::size_t iteration) const noexcept
+        {
+            return iteration * 7919 % m_Events.size();
+        }
+    };
+
+    /*
+     * @brief CPU cost of one signal, wait and reset round with `range(0)` registered handles
+     */
+    void BM_WaitSetSignalAndWait(benchmark::State& state)
+    {
+        Fixture fixture(static_cast<std::size_t>(state.range(0)));
+        if (!fixture.Valid())
+        {
+            state.SkipWithError("WaitSet registration failed");
+            return;
+        }
+
+        std::array<std::size_t, 64> ready;
+        std::size_t iteration = 0;
+
+        for (auto _ : state)
+        {
+            auto const target = fixture.Pick(iteration++);
+            Signal(fixture.m_Events[target]);
+
+            auto const count = fixture.m_Set.Wait(ready);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                Consume(fixture.m_Events[ready[i]]);
+            }
+
+            benchmark::DoNotOptimize(count);
+        }
+    }
+
+    /*
+     * @brief Time from another thread signaling a handle until a blocked Wait() returns it
+     */
+    void BM_WaitSetWakeLatency(benchmark::State& state)
+    {
+        Fixture fixture(static_cast<std::size_t>(state.range(0)));
+        if (!fixture.Valid())
+        {
+            state.SkipWithError("WaitSet registration failed");
+            return;
+        }
+
+        std::atomic<std::size_t> request = 0;
+        std::atomic<bool>        stop    = false;
+        // Published through the kernel object, atomic only to keep the handoff well-defined
+        std::atomic<Clock::rep>  signaled = 0;
+
+        std::thread signaler([&]
+        {
+            for (std::size_t seen = 0;;)
+            {
+                request.wait(seen, std::memory_order_acquire);
+                if (stop.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+
+                seen = request.load(std::memory_order_acquire);
+
+                // Give the waiter time to block, on a single core this also yields to it
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+                signaled.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+                Signal(fixture.m_Events[fixture.Pick(seen)]);
+            }
+        });
+
+        std::array<std::size_t, 64> ready;
+        std::vector<double> samples;
+
+        for (auto _ : state)
+        {
+            request.fetch_add(1, std::memory_order_release);
+            request.notify_one();
+
+            auto const count = fixture.m_Set.Wait(ready);
+            auto const elapsed = std::chrono::duration<double>(Clock::now() - Clock::time_point(Clock::duration(signaled.load(std::memory_order_acquire))));
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                Consume(fixture.m_Events[ready[i]]);
+            }
+
+            state.SetIterationTime(elapsed.count());
+            samples.push_back(elapsed.count() * 1e9);
+        }
+
+        stop.store(true, std::memory_order_release);
+        request.fetch_add(1, std::memory_order_release);
+        request.notify_one();
+        signaler.join();
+
+        std::sort(samples.begin(), samples.end());
+        if (!samples.empty())
+        {
+            state.counters["p50_ns"] = samples[samples.size() / 2];
+            state.counters["p99_ns"] = samples[samples.size() * 99 / 100];
+        }
+    }
+}
+
+BENCHMARK(BM_WaitSetSignalAndWait)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_WaitSetWakeLatency)->Arg(10)->Arg(1000)->Arg(10000)->UseManualTime();
@@ -0,0 +1,408 @@
+#pragma once
+#include "handle.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#if !defined(_WIN32)
+#include "io_ring.hpp"
+#endif
+
+/*
+ * @brief One read for AsyncFile::SubmitReads, the buffer must stay alive until it completes
+ */
+struct AsyncRead
+{
+    std::span<std::byte> m_Buffer;
+    std::uint64_t        m_Offset;
+    std::uint64_t        m_UserData;
+};
+
+/*
+ * @brief Result of a finished read
+ *
+ * `m_Result` is the number of bytes read, or a negated platform error code
+ * (-errno / -GetLastError()). Cancelled reads report -ECANCELED / -ERROR_OPERATION_ABORTED.
+ */
+struct AsyncCompletion
+{
+    std::uint64_t m_UserData;
+    std::int64_t  m_Result;
+};
+
+/*
+ * @brief Queue-depth > 1 positional reads over a FileHandle
+ *
+ * Windows: the file must be opened with FILE_FLAG_OVERLAPPED. Reads are issued with
+ * OVERLAPPED structures from a fixed pool and completions are dequeued in batches from an
+ * IoCompletionPortHandle the file gets associated with.
+ *
+ * Linux: reads are IORING_OP_READ entries on a private io_uring.
+ *
+ * At most `QueueDepth()` reads are in flight, `SubmitReads` queues as many as fit. Not
+ * thread-safe, use one AsyncFile per thread (several may share a file). Linux keeps the
+ * submission queue empty between calls, entries the kernel refused are withdrawn again.
+ */
+class AsyncFile
+{
+private:
+    FileHandle    m_File;
+    std::uint32_t m_QueueDepth;
+    std::size_t   m_InFlight = 0;
+
+#if defined(_WIN32)
+    struct Request
+    {
+        OVERLAPPED    m_Overlapped;
+        std::uint64_t m_UserData;
+        // Issued and not reaped yet, only these are matched by Cancel
+        bool          m_Pending = false;
+    };
+
+    IoCompletionPortHandle        m_Port;
+    std::vector<Request>          m_Requests;
+    std::vector<Request*>         m_FreeRequests;
+    std::vector<AsyncCompletion>  m_Failed;
+    std::vector<OVERLAPPED_ENTRY> m_Entries;
+#else
+    // Marks the completions of cancel requests, which are not reported
+    static constexpr std::uint64_t CancelUserData = ~std::uint64_t(0);
+
+    IoRing m_Ring;
+#endif
+
+public:
+    /*
+     * @param File to read from, owned by the AsyncFile from now on
+     * @param Maximum number of reads in flight
+     */
+    explicit AsyncFile(FileHandle&& file, std::uint32_t queueDepth = 32)
+        : m_File(std::move(file))
+        , m_QueueDepth(queueDepth ? queueDepth : 1)
+#if defined(_WIN32)
+        , m_Port(::CreateIoCompletionPort(m_File, nullptr, 0, 1))
+        , m_Requests(m_QueueDepth)
+        , m_Entries(m_QueueDepth)
+#else
+        // Cancels take submission entries too, leave room for one per read
+        , m_Ring(m_QueueDepth * 2)
+#endif
+    {
+#if defined(_WIN32)
+        m_FreeRequests.reserve(m_QueueDepth);
+        for (auto& request : m_Requests)
+        {
+            m_FreeRequests.push_back(&request);
+        }
+#endif
+    }
+
+    AsyncFile(AsyncFile const&) = delete;
+    AsyncFile& operator=(AsyncFile const&) = delete;
+
+    /*
+     * @brief Cancels and drains everything still in flight, buffers may be released afterwards
+     */
+    ~AsyncFile()
+    {
+        if (!Valid() || m_InFlight == 0)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        ::CancelIoEx(m_File, nullptr);
+#else
+        if (auto* sqe = m_Ring.GetSqe())
+        {
+            sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+            sqe->fd           = m_File.Get();
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_FD;
+            sqe->user_data    = CancelUserData;
+
+            // Without the cancel the reads still finish on their own
+            if (m_Ring.Submit() != 1)
+            {
+                m_Ring.Withdraw();
+            }
+        }
+#endif
+
+        AsyncCompletion completions[16];
+        while (m_InFlight != 0)
+        {
+            // Nothing is reaped only once waiting failed for good, closing the ring then
+            // cancels whatever the kernel still holds
+            if (WaitCompletions(completions, 1) == 0)
+            {
+                break;
+            }
+        }
+    }
+
+public:
+    /*
+     * @brief Whether the file and the completion machinery were set up
+     */
+    [[nodiscard]] bool Valid() const noexcept
+    {
+#if defined(_WIN32)
+        return m_File.Valid() && m_Port.Valid();
+#else
+        return m_File.Valid() && m_Ring.Valid();
+#endif
+    }
+
+    [[nodiscard]] FileHandle const& File() const noexcept
+    {
+        return m_File;
+    }
+
+    [[nodiscard]] std::uint32_t QueueDepth() const noexcept
+    {
+        return m_QueueDepth;
+    }
+
+    [[nodiscard]] std::size_t InFlight() const noexcept
+    {
+        return m_InFlight;
+    }
+
+    /*
+     * @brief Issues as many of `reads` as the queue depth allows with a single submission
+     *
+     * @return Number of reads issued, the rest can be resubmitted after completions are reaped
+     */
+    std::size_t SubmitReads(std::span<AsyncRead const> reads) noexcept
+    {
+        std::size_t issued = 0;
+
+#if defined(_WIN32)
+        for (auto const& read : reads)
+        {
+            if (m_FreeRequests.empty())
+            {
+                break;
+            }
+
+            auto* request = m_FreeRequests.back();
+            m_FreeRequests.pop_back();
+
+            std::memset(&request->m_Overlapped, 0, sizeof(request->m_Overlapped));
+            request->m_Overlapped.Offset     = static_cast<DWORD>(read.m_Offset);
+            request->m_Overlapped.OffsetHigh = static_cast<DWORD>(read.m_Offset >> 32);
+            request->m_UserData              = read.m_UserData;
+
+            ++issued;
+            if (!::ReadFile(m_File, read.m_Buffer.data(), static_cast<DWORD>(read.m_Buffer.size()), nullptr, &request->m_Overlapped)
+                && ::GetLastError() != ERROR_IO_PENDING)
+            {
+                // Failed synchronously, no packet will be queued to the port
+                m_Failed.push_back({ read.m_UserData, -static_cast<std::int64_t>(::GetLastError()) });
+                m_FreeRequests.push_back(request);
+                continue;
+            }
+
+            request->m_Pending = true;
+            ++m_InFlight;
+        }
+#else
+        for (auto const& read : reads)
+        {
+            if (m_InFlight == m_QueueDepth)
+            {
+                break;
+            }
+
+            auto* sqe = m_Ring.GetSqe();
+            if (!sqe)
+            {
+                break;
+            }
+
+            sqe->opcode    = IORING_OP_READ;
+            sqe->fd        = m_File.Get();
+            sqe->addr      = reinterpret_cast<std::uint64_t>(read.m_Buffer.data());
+            sqe->len       = static_cast<std::uint32_t>(read.m_Buffer.size());
+            sqe->off       = read.m_Offset;
+            sqe->user_data = read.m_UserData;
+
+            ++issued;
+            ++m_InFlight;
+        }
+
+        // Entries the kernel did not take are not in flight, the caller resubmits them
+        if (issued != 0 && m_Ring.Submit() != static_cast<int>(issued))
+        {
+            auto const withdrawn = m_Ring.Withdraw();
+            issued     -= withdrawn;
+            m_InFlight -= withdrawn;
+        }
+#endif
+
+        return issued;
+    }
+
+    /*
+     * @brief Collects finished reads without blocking
+     *
+     * @return Number of entries written to `completions`
+     */
+    std::size_t PollCompletions(std::span<AsyncCompletion> completions) noexcept
+    {
+        std::size_t reaped = 0;
+        (void)Reap(completions, 0, reaped);
+        return reaped;
+    }
+
+    /*
+     * @brief Blocks until at least `minimum` reads finished, nothing is in flight or waiting failed
+     *
+     * @return Number of entries written to `completions`
+     */
+    std::size_t WaitCompletions(std::span<AsyncCompletion> completions, std::size_t minimum = 1) noexcept
+    {
+        std::size_t reaped = 0;
+        while (reaped < completions.size() && (reaped < minimum || reaped == 0))
+        {
+            if (m_InFlight == 0 && !HasBufferedCompletions())
+            {
+                break;
+            }
+
+            std::size_t count = 0;
+            auto const waited = Reap(completions.subspan(reaped), 1, count);
+            reaped += count;
+
+            if (!waited)
+            {
+                break;
+            }
+        }
+
+        return reaped;
+    }
+
+    /*
+     * @brief Requests cancellation of the read submitted with `userData`
+     *
+     * The read still completes, usually with a cancellation error. Returns false when the
+     * cancel could not be issued, on Windows also when no read with `userData` is in flight.
+     */
+    bool Cancel(std::uint64_t userData) noexcept
+    {
+#if defined(_WIN32)
+        for (auto& request : m_Requests)
+        {
+            if (request.m_Pending && request.m_UserData == userData)
+            {
+                return ::CancelIoEx(m_File, &request.m_Overlapped) || ::GetLastError() == ERROR_NOT_FOUND;
+            }
+        }
+
+        return false;
+#else
+        auto* sqe = m_Ring.GetSqe();
+        if (!sqe)
+        {
+            return false;
+        }
+
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->addr      = userData;
+        sqe->user_data = CancelUserData;
+
+        if (m_Ring.Submit() != 1)
+        {
+            m_Ring.Withdraw();
+            return false;
+        }
+
+        return true;
+#endif
+    }
+
+private:
+    [[nodiscard]] bool HasBufferedCompletions() const noexcept
+    {
+#if defined(_WIN32)
+        return !m_Failed.empty();
+#else
+        return false;
+#endif
+    }
+
+    /*
+     * @param Completions to fill
+     * @param Milliseconds (Windows) or number of completions (Linux) to wait for, 0 polls
+     * @param Number of entries written to `completions`
+     * @return False when waiting failed for good, nothing in flight will be reported anymore
+     */
+    [[nodiscard]] bool Reap(std::span<AsyncCompletion> completions, unsigned wait, std::size_t& reaped) noexcept
+    {
+        reaped = 0;
+
+#if defined(_WIN32)
+        while (!m_Failed.empty() && reaped < completions.size())
+        {
+            completions[reaped++] = m_Failed.back();
+            m_Failed.pop_back();
+        }
+
+        if (reaped == completions.size() || m_InFlight == 0)
+        {
+            return true;
+        }
+
+        ULONG removed = 0;
+        auto const capacity = static_cast<ULONG>(std::min(completions.size() - reaped, m_Entries.size()));
+        if (!::GetQueuedCompletionStatusEx(m_Port, m_Entries.data(), capacity, &removed, wait ? INFINITE : 0, FALSE))
+        {
+            // Polling times out, an infinite wait only fails when the port is unusable
+            return wait == 0;
+        }
+
+        for (ULONG i = 0; i < removed; ++i)
+        {
+            auto* request = reinterpret_cast<Request*>(m_Entries[i].lpOverlapped);
+
+            DWORD transferred = 0;
+            auto const result = ::GetOverlappedResult(m_File, &request->m_Overlapped, &transferred, FALSE)
+                ? static_cast<std::int64_t>(transferred)
+                : -static_cast<std::int64_t>(::GetLastError());
+
+            completions[reaped++] = { request->m_UserData, result };
+            request->m_Pending = false;
+            m_FreeRequests.push_back(request);
+            --m_InFlight;
+        }
+#else
+        // A full completion queue (EBUSY) or a short allocation failure (EAGAIN) clears up by draining
+        auto const result = wait ? m_Ring.Submit(wait) : 0;
+        auto const waited = result >= 0 || result == -EBUSY || result == -EAGAIN;
+
+        // Cancel completions count against the limit too, so `completions` never overflows
+        m_Ring.DrainCompletions([&](io_uring_cqe const& cqe) noexcept
+        {
+            if (cqe.user_data == CancelUserData)
+            {
+                return;
+            }
+
+            completions[reaped++] = { cqe.user_data, cqe.res };
+            --m_InFlight;
+        }, static_cast<unsigned>(std::min<std::size_t>(completions.size(), ~0u)));
+
+        if (!waited)
+        {
+            return false;
+        }
+#endif
+
+        return true;
+    }
+};
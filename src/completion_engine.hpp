@@ -0,0 +1,1014 @@
+#pragma once
+#include "handle.hpp"
+#include "transmit_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <mswsock.h>
+#else
+#include <cerrno>
+#include <semaphore>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#endif
+
+struct IoOperation;
+
+/*
+ * @brief Completion routine of an IoOperation
+ *
+ * @param The finished operation, recycled as soon as the callback returns
+ * @param Bytes transferred, or a negated platform error code (-errno / -GetLastError())
+ */
+using IoCallback = void(*)(IoOperation& operation, std::int64_t result) noexcept;
+
+enum class IoOperationType : std::uint8_t
+{
+    Read,
+    Write,
+    Post,
+    Accept,
+    Wait,
+    Transmit,
+    Connect,
+};
+
+/*
+ * @brief Per-operation context handed out by CompletionEngine from a fixed pool
+ */
+struct IoOperation
+{
+#if defined(_WIN32)
+    // Must stay the first member, completion packets carry its address
+    OVERLAPPED m_Overlapped;
+#endif
+    IoCallback      m_Callback;
+    void*           m_Context;
+    std::byte*      m_Buffer;
+    std::size_t     m_Size;
+    std::uint64_t   m_Offset;
+    std::intptr_t   m_Handle;
+    IoOperationType m_Type;
+#if !defined(_WIN32)
+    std::int64_t    m_Result;
+#endif
+    IoOperation*    m_Next;
+};
+
+/*
+ * @brief Multi-threaded proactor around an I/O completion port
+ *
+ * Handles are associated once and then read from / written to with operations whose
+ * callbacks run on the engine's workers. Workers dequeue completions in batches and at most
+ * `Concurrency()` of them run callbacks at the same time.
+ *
+ * Windows: an IoCompletionPortHandle drained with GetQueuedCompletionStatusEx. Handles must
+ * be opened for overlapped I/O (FILE_FLAG_OVERLAPPED, sockets are overlapped by default).
+ *
+ * Linux: an edge-triggered epoll instance emulates the completion model. Operations are
+ * attempted right away and parked per descriptor until readiness when they would block;
+ * regular files, which epoll rejects, are read and written synchronously by the caller.
+ * Completions are always delivered on a worker, never inside Read/Write/Post.
+ *
+ * Every operation must have completed before the engine is destroyed.
+ */
+class CompletionEngine
+{
+public:
+    static constexpr std::chrono::milliseconds Infinite{ -1 };
+    static constexpr std::size_t MaxBatchSize = 256;
+
+    // Space AcceptEx needs for the local and remote address
+    static constexpr std::size_t AcceptBufferSize = 2 * (sizeof(sockaddr_storage) + 16);
+
+private:
+    struct IoQueue
+    {
+        IoOperation* m_Head = nullptr;
+        IoOperation* m_Tail = nullptr;
+
+        [[nodiscard]] bool Empty() const noexcept
+        {
+            return m_Head == nullptr;
+        }
+
+        void Push(IoOperation* operation) noexcept
+        {
+            operation->m_Next = nullptr;
+            (m_Tail ? m_Tail->m_Next : m_Head) = operation;
+            m_Tail = operation;
+        }
+
+        IoOperation* Pop() noexcept
+        {
+            auto* operation = m_Head;
+            m_Head = operation->m_Next;
+            if (!m_Head)
+            {
+                m_Tail = nullptr;
+            }
+
+            return operation;
+        }
+    };
+
+    unsigned    m_Concurrency;
+    std::size_t m_BatchSize;
+
+    std::unique_ptr<IoOperation[]> m_Operations;
+    std::mutex                     m_FreeLock;
+    IoOperation*                   m_Free = nullptr;
+
+    std::atomic<bool>        m_Stopping = false;
+    std::vector<std::thread> m_Workers;
+
+#if defined(_WIN32)
+    static constexpr ULONG_PTR StopKey = 1;
+
+    IoCompletionPortHandle m_Port;
+#else
+    // epoll_event::data of the wakeup eventfd, descriptors use generation << 32 | fd
+    static constexpr std::uint64_t WakeKey = ~std::uint64_t(0);
+
+    struct Descriptor
+    {
+        int           m_Fd;
+        std::uint32_t m_Generation;
+        bool          m_Pollable;
+        bool          m_Socket;
+
+        std::mutex m_Lock;
+        IoQueue    m_Reads;
+        IoQueue    m_Writes;
+    };
+
+    IoCompletionPortHandle m_Epoll;
+    EventHandle            m_Wake;
+
+    std::shared_mutex                                        m_DescriptorsLock;
+    std::unordered_map<int, std::shared_ptr<Descriptor>>     m_Descriptors;
+    std::uint32_t                                            m_Generation = 0;
+
+    std::mutex m_ReadyLock;
+    IoQueue    m_Ready;
+
+    std::counting_semaphore<> m_Running;
+
+    // Completions queued by a worker of this engine are picked up by that worker without a wakeup
+    static inline thread_local CompletionEngine* t_Worker = nullptr;
+#endif
+
+public:
+    /*
+     * @param Number of workers allowed to run callbacks at once, 0 means one per hardware thread
+     * @param Maximum number of operations in flight
+     * @param Maximum number of completions dequeued per call
+     */
+    explicit CompletionEngine(unsigned concurrency = 0, std::size_t maxOperations = 4096, std::size_t batchSize = 64)
+        : m_Concurrency(concurrency ? concurrency : std::max(1u, std::thread::hardware_concurrency()))
+        , m_BatchSize(std::clamp<std::size_t>(batchSize, 1, MaxBatchSize))
+        , m_Operations(std::make_unique<IoOperation[]>(maxOperations))
+#if defined(_WIN32)
+        , m_Port(::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, m_Concurrency))
+#else
+        , m_Epoll(::epoll_create1(EPOLL_CLOEXEC))
+        , m_Wake(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        , m_Running(static_cast<std::ptrdiff_t>(m_Concurrency))
+#endif
+    {
+        for (std::size_t i = maxOperations; i-- != 0;)
+        {
+            m_Operations[i].m_Next = m_Free;
+            m_Free = &m_Operations[i];
+        }
+
+#if !defined(_WIN32)
+        epoll_event event{};
+        event.events   = EPOLLIN;
+        event.data.u64 = WakeKey;
+
+        if (m_Epoll.Valid() && m_Wake.Valid() && ::epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_Wake, &event) != 0)
+        {
+            m_Epoll.Close();
+        }
+#endif
+    }
+
+    CompletionEngine(CompletionEngine const&) = delete;
+    CompletionEngine& operator=(CompletionEngine const&) = delete;
+
+    ~CompletionEngine()
+    {
+        Stop();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+#if defined(_WIN32)
+        return m_Port.Valid();
+#else
+        return m_Epoll.Valid() && m_Wake.Valid();
+#endif
+    }
+
+    [[nodiscard]] unsigned Concurrency() const noexcept
+    {
+        return m_Concurrency;
+    }
+
+    /*
+     * @brief Routes completions of `handle` to this engine
+     *
+     * On Linux pollable descriptors are switched to non-blocking mode.
+     */
+    template<typename _Ty, typename _ClosePolicy>
+    bool Associate(Handle<_Ty, _ClosePolicy> const& handle) noexcept
+    {
+        return Associate(HandleToBits(handle.Get()));
+    }
+
+    /*
+     * @brief Cancels outstanding operations of `handle`, call before closing it
+     *
+     * Cancelled operations still complete, with ERROR_OPERATION_ABORTED / ECANCELED.
+     */
+    template<typename _Ty, typename _ClosePolicy>
+    void Disassociate(Handle<_Ty, _ClosePolicy> const& handle) noexcept
+    {
+        Disassociate(HandleToBits(handle.Get()));
+    }
+
+    /*
+     * @brief Starts reading into `buffer`, `offset` is ignored for streams
+     *
+     * @return false when the operation pool is exhausted or the read failed to start
+     */
+    template<typename _Ty, typename _ClosePolicy>
+    bool Read(Handle<_Ty, _ClosePolicy> const& handle, std::span<std::byte> buffer, std::uint64_t offset,
+              IoCallback callback, void* context = nullptr) noexcept
+    {
+        return Start(IoOperationType::Read, HandleToBits(handle.Get()), buffer.data(), buffer.size(), offset, callback, context);
+    }
+
+    /*
+     * @brief Starts writing `buffer`, which must stay alive until the callback ran
+     */
+    template<typename _Ty, typename _ClosePolicy>
+    bool Write(Handle<_Ty, _ClosePolicy> const& handle, std::span<std::byte const> buffer, std::uint64_t offset,
+               IoCallback callback, void* context = nullptr) noexcept
+    {
+        return Start(IoOperationType::Write, HandleToBits(handle.Get()), const_cast<std::byte*>(buffer.data()), buffer.size(),
+                     offset, callback, context);
+    }
+
+    /*
+     * @brief Accepts a connection on `listener`, the result is the accepted socket or -error
+     *
+     * On Windows this is AcceptEx into a socket of the listener's protocol and `addresses`
+     * must hold AcceptBufferSize bytes until the callback ran. Linux ignores `addresses`.
+     * The accepted socket belongs to the callback, e.g. as a SocketHandle.
+     */
+    bool Accept(SocketHandle const& listener, std::span<std::byte> addresses, IoCallback callback, void* context = nullptr) noexcept
+    {
+#if defined(_WIN32)
+        return StartAccept(listener.Get(), addresses, callback, context);
+#else
+        return Start(IoOperationType::Accept, listener.Get(), addresses.data(), addresses.size(), 0, callback, context);
+#endif
+    }
+
+#if defined(_WIN32)
+    /*
+     * @brief Waits for a client to connect to the listening instance `pipe` (ConnectNamedPipe)
+     */
+    bool Connect(NamedPipeHandle const& pipe, IoCallback callback, void* context = nullptr) noexcept
+    {
+        auto* operation = Acquire(IoOperationType::Connect, HandleToBits(pipe.Get()), nullptr, 0, 0, callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        if (!::ConnectNamedPipe(pipe.Get(), &operation->m_Overlapped))
+        {
+            auto const error = ::GetLastError();
+
+            // A client connected in between, no packet is queued for that
+            if (error == ERROR_PIPE_CONNECTED)
+            {
+                if (::PostQueuedCompletionStatus(m_Port, 0, 0, &operation->m_Overlapped))
+                {
+                    return true;
+                }
+            }
+            else if (error == ERROR_IO_PENDING)
+            {
+                return true;
+            }
+
+            Recycle(operation);
+            return false;
+        }
+
+        return true;
+    }
+#endif
+
+    /*
+     * @brief Runs `callback(operation, 0)` once `handle` is signaled
+     *
+     * Windows registers a threadpool wait. Linux waits for the descriptor to become readable
+     * without consuming it, so `handle` must be associated, and Disassociate() cancels the
+     * wait; on Windows it does not.
+     */
+    template<WaitableHandleType _Ty, typename _ClosePolicy>
+    bool Wait(Handle<_Ty, _ClosePolicy> const& handle, IoCallback callback, void* context = nullptr) noexcept
+    {
+#if defined(_WIN32)
+        return StartWait(handle.Get(), callback, context);
+#else
+        return Start(IoOperationType::Wait, HandleToBits(handle.Get()), nullptr, 0, 0, callback, context);
+#endif
+    }
+
+    /*
+     * @brief Sends `request` on `socket`, the result is the total bytes sent or -error
+     *
+     * Windows issues a single TransmitFile, so the file range is limited to MaxTransmitChunk.
+     * Linux keeps calling sendfile whenever the socket has room, `socket` must be associated.
+     */
+    bool Transmit(SocketHandle const& socket, TransmitRequest& request, IoCallback callback, void* context = nullptr) noexcept
+    {
+        if (!request.Resolve())
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        return StartTransmit(socket.Get(), request, callback, context);
+#else
+        return Start(IoOperationType::Transmit, socket.Get(), reinterpret_cast<std::byte*>(&request), 0, 0, callback, context);
+#endif
+    }
+
+    /*
+     * @brief Queues `callback(operation, 0)` to run on a worker
+     */
+    bool Post(IoCallback callback, void* context = nullptr) noexcept
+    {
+        auto* operation = Acquire(IoOperationType::Post, 0, nullptr, 0, 0, callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        if (!::PostQueuedCompletionStatus(m_Port, 0, 0, &operation->m_Overlapped))
+        {
+            Recycle(operation);
+            return false;
+        }
+#else
+        operation->m_Result = 0;
+        Complete(operation);
+#endif
+
+        return true;
+    }
+
+    /*
+     * @brief Dequeues one batch of completions on the calling thread and runs their callbacks
+     *
+     * @return Number of callbacks run
+     */
+    std::size_t RunOnce(std::chrono::milliseconds timeout = Infinite) noexcept
+    {
+#if defined(_WIN32)
+        OVERLAPPED_ENTRY entries[MaxBatchSize];
+        ULONG removed = 0;
+
+        DWORD const milliseconds = timeout < std::chrono::milliseconds::zero() ? INFINITE : static_cast<DWORD>(timeout.count());
+        if (!::GetQueuedCompletionStatusEx(m_Port, entries, static_cast<ULONG>(m_BatchSize), &removed, milliseconds, FALSE))
+        {
+            return 0;
+        }
+
+        std::size_t dispatched = 0;
+        for (ULONG i = 0; i < removed; ++i)
+        {
+            if (entries[i].lpCompletionKey == StopKey)
+            {
+                continue;
+            }
+
+            auto* operation = reinterpret_cast<IoOperation*>(entries[i].lpOverlapped);
+
+            std::int64_t result = 0;
+            if (operation->m_Type != IoOperationType::Post && operation->m_Type != IoOperationType::Wait)
+            {
+                DWORD transferred = 0;
+                result = ::GetOverlappedResult(reinterpret_cast<HANDLE>(operation->m_Handle), &operation->m_Overlapped, &transferred, FALSE)
+                    ? static_cast<std::int64_t>(transferred)
+                    : -static_cast<std::int64_t>(::GetLastError());
+            }
+
+            if (operation->m_Type == IoOperationType::Accept)
+            {
+                result = FinishAccept(*operation, result);
+            }
+            else if (operation->m_Type == IoOperationType::Transmit && result > 0)
+            {
+                reinterpret_cast<TransmitRequest*>(operation->m_Buffer)->m_Sent += static_cast<std::uint64_t>(result);
+            }
+
+            operation->m_Callback(*operation, result);
+            Recycle(operation);
+            ++dispatched;
+        }
+
+        return dispatched;
+#else
+        IoQueue completed;
+        TakeReady(completed);
+
+        if (completed.Empty())
+        {
+            epoll_event events[MaxBatchSize];
+            auto const count = ::epoll_wait(m_Epoll, events, static_cast<int>(m_BatchSize),
+                                            timeout < std::chrono::milliseconds::zero() ? -1 : static_cast<int>(timeout.count()));
+
+            for (int i = 0; i < count; ++i)
+            {
+                if (events[i].data.u64 == WakeKey)
+                {
+                    eventfd_t value;
+                    (void)::eventfd_read(m_Wake, &value);
+                    continue;
+                }
+
+                auto const descriptor = Find(static_cast<int>(events[i].data.u64 & 0xffffffff));
+                if (!descriptor || descriptor->m_Generation != static_cast<std::uint32_t>(events[i].data.u64 >> 32))
+                {
+                    continue;
+                }
+
+                std::lock_guard lock(descriptor->m_Lock);
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP))
+                {
+                    Progress(*descriptor, descriptor->m_Reads, completed);
+                }
+
+                if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+                {
+                    Progress(*descriptor, descriptor->m_Writes, completed);
+                }
+            }
+
+            TakeReady(completed);
+        }
+
+        if (completed.Empty())
+        {
+            return 0;
+        }
+
+        std::size_t dispatched = 0;
+
+        m_Running.acquire();
+        while (!completed.Empty())
+        {
+            auto* operation = completed.Pop();
+            operation->m_Callback(*operation, operation->m_Result);
+            Recycle(operation);
+            ++dispatched;
+        }
+        m_Running.release();
+
+        return dispatched;
+#endif
+    }
+
+    /*
+     * @brief Spawns `threads` workers calling RunOnce until Stop(), 0 means Concurrency()
+     */
+    void Start(unsigned threads = 0)
+    {
+        m_Stopping.store(false, std::memory_order_relaxed);
+
+        for (unsigned i = 0, count = threads ? threads : m_Concurrency; i < count; ++i)
+        {
+            m_Workers.emplace_back([this]
+            {
+#if !defined(_WIN32)
+                t_Worker = this;
+#endif
+                while (!m_Stopping.load(std::memory_order_acquire))
+                {
+                    RunOnce(Infinite);
+                }
+
+                // The stop wakeup may have been consumed by this worker, pass it on to the next one
+#if defined(_WIN32)
+                ::PostQueuedCompletionStatus(m_Port, 0, StopKey, nullptr);
+#else
+                (void)::eventfd_write(m_Wake, 1);
+#endif
+            });
+        }
+    }
+
+    /*
+     * @brief Wakes and joins every worker, completions still queued stay queued
+     */
+    void Stop() noexcept
+    {
+        if (m_Workers.empty())
+        {
+            return;
+        }
+
+        m_Stopping.store(true, std::memory_order_release);
+
+#if defined(_WIN32)
+        ::PostQueuedCompletionStatus(m_Port, 0, StopKey, nullptr);
+#else
+        (void)::eventfd_write(m_Wake, 1);
+#endif
+
+        for (auto& worker : m_Workers)
+        {
+            worker.join();
+        }
+
+        m_Workers.clear();
+    }
+
+private:
+    IoOperation* Acquire(IoOperationType type, std::intptr_t handle, std::byte* buffer, std::size_t size, std::uint64_t offset,
+                         IoCallback callback, void* context) noexcept
+    {
+        IoOperation* operation;
+        {
+            std::lock_guard lock(m_FreeLock);
+            operation = m_Free;
+            if (!operation)
+            {
+                return nullptr;
+            }
+
+            m_Free = operation->m_Next;
+        }
+
+#if defined(_WIN32)
+        std::memset(&operation->m_Overlapped, 0, sizeof(operation->m_Overlapped));
+        operation->m_Overlapped.Offset     = static_cast<DWORD>(offset);
+        operation->m_Overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+#endif
+        operation->m_Callback = callback;
+        operation->m_Context  = context;
+        operation->m_Buffer   = buffer;
+        operation->m_Size     = size;
+        operation->m_Offset   = offset;
+        operation->m_Handle   = handle;
+        operation->m_Type     = type;
+
+        return operation;
+    }
+
+    void Recycle(IoOperation* operation) noexcept
+    {
+        std::lock_guard lock(m_FreeLock);
+        operation->m_Next = m_Free;
+        m_Free = operation;
+    }
+
+#if defined(_WIN32)
+    bool Associate(std::intptr_t handle) noexcept
+    {
+        return ::CreateIoCompletionPort(reinterpret_cast<HANDLE>(handle), m_Port, 0, 0) != nullptr;
+    }
+
+    void Disassociate(std::intptr_t handle) noexcept
+    {
+        ::CancelIoEx(reinterpret_cast<HANDLE>(handle), nullptr);
+    }
+
+    bool Start(IoOperationType type, std::intptr_t handle, std::byte* buffer, std::size_t size, std::uint64_t offset,
+               IoCallback callback, void* context) noexcept
+    {
+        auto* operation = Acquire(type, handle, buffer, size, offset, callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        auto const native = reinterpret_cast<HANDLE>(handle);
+        BOOL const started = type == IoOperationType::Read
+            ? ::ReadFile(native, buffer, static_cast<DWORD>(size), nullptr, &operation->m_Overlapped)
+            : ::WriteFile(native, buffer, static_cast<DWORD>(size), nullptr, &operation->m_Overlapped);
+
+        // Synchronous successes queue a packet as well
+        if (!started && ::GetLastError() != ERROR_IO_PENDING)
+        {
+            Recycle(operation);
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+     * @brief AcceptEx into a fresh socket of the listener's protocol, kept in m_Offset until completion
+     */
+    bool StartAccept(SOCKET listener, std::span<std::byte> addresses, IoCallback callback, void* context) noexcept
+    {
+        WSAPROTOCOL_INFOW protocol;
+        int length = sizeof(protocol);
+        if (addresses.size() < AcceptBufferSize
+            || ::getsockopt(listener, SOL_SOCKET, SO_PROTOCOL_INFOW, reinterpret_cast<char*>(&protocol), &length) != 0)
+        {
+            return false;
+        }
+
+        SocketHandle accepted(::WSASocketW(protocol.iAddressFamily, protocol.iSocketType, protocol.iProtocol, nullptr, 0, WSA_FLAG_OVERLAPPED));
+        if (!accepted.Valid())
+        {
+            return false;
+        }
+
+        auto* operation = Acquire(IoOperationType::Accept, HandleToBits(listener), addresses.data(), addresses.size(),
+                                  static_cast<std::uint64_t>(accepted.Get()), callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        DWORD received = 0;
+        if (!::AcceptEx(listener, accepted.Get(), addresses.data(), 0, sizeof(sockaddr_storage) + 16, sizeof(sockaddr_storage) + 16,
+                        &received, &operation->m_Overlapped)
+            && ::WSAGetLastError() != ERROR_IO_PENDING)
+        {
+            Recycle(operation);
+            return false;
+        }
+
+        (void)accepted.Release();
+        return true;
+    }
+
+    /*
+     * @return the accepted socket, or `result` after closing it when AcceptEx failed
+     */
+    static std::int64_t FinishAccept(IoOperation const& operation, std::int64_t result) noexcept
+    {
+        auto const listener = static_cast<SOCKET>(operation.m_Handle);
+        SocketHandle accepted(static_cast<SOCKET>(operation.m_Offset));
+
+        if (result >= 0)
+        {
+            if (::setsockopt(accepted.Get(), SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT, reinterpret_cast<char const*>(&listener), sizeof(listener)) != 0)
+            {
+                return -static_cast<std::int64_t>(::WSAGetLastError());
+            }
+
+            return static_cast<std::int64_t>(accepted.Release());
+        }
+
+        return result;
+    }
+
+    bool StartTransmit(SOCKET socket, TransmitRequest& request, IoCallback callback, void* context) noexcept
+    {
+        if (request.m_Length > MaxTransmitChunk)
+        {
+            return false;
+        }
+
+        auto* operation = Acquire(IoOperationType::Transmit, HandleToBits(socket), reinterpret_cast<std::byte*>(&request), 0,
+                                  request.m_Offset, callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        request.m_Buffers.Head       = const_cast<std::byte*>(request.m_Header.data());
+        request.m_Buffers.HeadLength = static_cast<DWORD>(request.m_Header.size());
+        request.m_Buffers.Tail       = const_cast<std::byte*>(request.m_Trailer.data());
+        request.m_Buffers.TailLength = static_cast<DWORD>(request.m_Trailer.size());
+
+        if (!::TransmitFile(socket, request.m_File.Get(), static_cast<DWORD>(request.m_Length), 0, &operation->m_Overlapped,
+                            &request.m_Buffers, 0)
+            && ::WSAGetLastError() != WSA_IO_PENDING)
+        {
+            Recycle(operation);
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+     * @brief Threadpool wait posting the operation to the port, whose handle is kept in m_Offset
+     */
+    bool StartWait(HANDLE handle, IoCallback callback, void* context) noexcept
+    {
+        auto* operation = Acquire(IoOperationType::Wait, HandleToBits(handle), nullptr, 0, static_cast<std::uint64_t>(HandleToBits(m_Port.Get())),
+                                  callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        auto* const wait = ::CreateThreadpoolWait(&OnWaitSignaled, operation, nullptr);
+        if (!wait)
+        {
+            Recycle(operation);
+            return false;
+        }
+
+        ::SetThreadpoolWait(wait, handle, nullptr);
+        return true;
+    }
+
+    static void CALLBACK OnWaitSignaled(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WAIT wait, TP_WAIT_RESULT) noexcept
+    {
+        auto* operation = static_cast<IoOperation*>(context);
+
+        // Freed once this callback returns
+        ::CloseThreadpoolWait(wait);
+        ::PostQueuedCompletionStatus(reinterpret_cast<HANDLE>(operation->m_Offset), 0, 0, &operation->m_Overlapped);
+    }
+#else
+    [[nodiscard]] std::shared_ptr<Descriptor> Find(int fd) noexcept
+    {
+        std::shared_lock lock(m_DescriptorsLock);
+
+        auto const found = m_Descriptors.find(fd);
+        return found != m_Descriptors.end() ? found->second : nullptr;
+    }
+
+    bool Associate(std::intptr_t handle) noexcept
+    {
+        auto const fd = static_cast<int>(handle);
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            return false;
+        }
+
+        auto descriptor = std::make_shared<Descriptor>();
+        descriptor->m_Fd     = fd;
+        descriptor->m_Socket = S_ISSOCK(status.st_mode);
+
+        std::unique_lock lock(m_DescriptorsLock);
+        if (m_Descriptors.contains(fd))
+        {
+            return false;
+        }
+
+        descriptor->m_Generation = ++m_Generation;
+
+        epoll_event event{};
+        event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = static_cast<std::uint64_t>(descriptor->m_Generation) << 32 | static_cast<std::uint32_t>(fd);
+
+        if (::epoll_ctl(m_Epoll, EPOLL_CTL_ADD, fd, &event) == 0)
+        {
+            descriptor->m_Pollable = true;
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        else if (errno == EPERM)
+        {
+            descriptor->m_Pollable = false;
+        }
+        else
+        {
+            return false;
+        }
+
+        m_Descriptors.emplace(fd, std::move(descriptor));
+        return true;
+    }
+
+    void Disassociate(std::intptr_t handle) noexcept
+    {
+        auto const fd = static_cast<int>(handle);
+
+        std::shared_ptr<Descriptor> descriptor;
+        {
+            std::unique_lock lock(m_DescriptorsLock);
+
+            auto const found = m_Descriptors.find(fd);
+            if (found == m_Descriptors.end())
+            {
+                return;
+            }
+
+            descriptor = std::move(found->second);
+            m_Descriptors.erase(found);
+        }
+
+        if (descriptor->m_Pollable)
+        {
+            ::epoll_ctl(m_Epoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+
+        std::lock_guard lock(descriptor->m_Lock);
+        for (auto* queue : { &descriptor->m_Reads, &descriptor->m_Writes })
+        {
+            while (!queue->Empty())
+            {
+                auto* operation = queue->Pop();
+                operation->m_Result = -ECANCELED;
+                Complete(operation);
+            }
+        }
+    }
+
+    bool Start(IoOperationType type, std::intptr_t handle, std::byte* buffer, std::size_t size, std::uint64_t offset,
+               IoCallback callback, void* context) noexcept
+    {
+        auto const descriptor = Find(static_cast<int>(handle));
+        if (!descriptor)
+        {
+            return false;
+        }
+
+        auto* operation = Acquire(type, handle, buffer, size, offset, callback, context);
+        if (!operation)
+        {
+            return false;
+        }
+
+        if (!descriptor->m_Pollable)
+        {
+            operation->m_Result = Perform(*descriptor, *operation);
+            Complete(operation);
+            return true;
+        }
+
+        std::unique_lock lock(descriptor->m_Lock);
+
+        // Earlier operations are still waiting for readiness, keep the order
+        auto const sending = type == IoOperationType::Write || type == IoOperationType::Transmit;
+        auto& queue = sending ? descriptor->m_Writes : descriptor->m_Reads;
+        if (queue.Empty())
+        {
+            auto const result = Perform(*descriptor, *operation);
+            if (result != -EAGAIN && result != -EWOULDBLOCK)
+            {
+                lock.unlock();
+                operation->m_Result = result;
+                Complete(operation);
+                return true;
+            }
+        }
+
+        queue.Push(operation);
+        return true;
+    }
+
+    /*
+     * @return Bytes transferred or -errno
+     */
+    static std::int64_t Perform(Descriptor const& descriptor, IoOperation const& operation) noexcept
+    {
+        if (operation.m_Type == IoOperationType::Transmit)
+        {
+            return TransmitStep(descriptor.m_Fd, *reinterpret_cast<TransmitRequest*>(operation.m_Buffer));
+        }
+
+        for (;;)
+        {
+            ssize_t result;
+            if (operation.m_Type == IoOperationType::Wait)
+            {
+                pollfd readable{ descriptor.m_Fd, POLLIN, 0 };
+                result = ::poll(&readable, 1, 0);
+                if (result == 0)
+                {
+                    return -EAGAIN;
+                }
+
+                if (result > 0)
+                {
+                    return 0;
+                }
+            }
+            else if (operation.m_Type == IoOperationType::Accept)
+            {
+                result = ::accept4(descriptor.m_Fd, nullptr, nullptr, SOCK_CLOEXEC);
+            }
+            else if (!descriptor.m_Pollable)
+            {
+                result = operation.m_Type == IoOperationType::Read
+                    ? ::pread(descriptor.m_Fd, operation.m_Buffer, operation.m_Size, static_cast<off_t>(operation.m_Offset))
+                    : ::pwrite(descriptor.m_Fd, operation.m_Buffer, operation.m_Size, static_cast<off_t>(operation.m_Offset));
+            }
+            else if (descriptor.m_Socket)
+            {
+                // MSG_NOSIGNAL, a peer reset must not raise SIGPIPE in a worker
+                result = operation.m_Type == IoOperationType::Read
+                    ? ::recv(descriptor.m_Fd, operation.m_Buffer, operation.m_Size, 0)
+                    : ::send(descriptor.m_Fd, operation.m_Buffer, operation.m_Size, MSG_NOSIGNAL);
+            }
+            else
+            {
+                result = operation.m_Type == IoOperationType::Read
+                    ? ::read(descriptor.m_Fd, operation.m_Buffer, operation.m_Size)
+                    : ::write(descriptor.m_Fd, operation.m_Buffer, operation.m_Size);
+            }
+
+            if (result >= 0)
+            {
+                return result;
+            }
+
+            if (errno != EINTR)
+            {
+                return -errno;
+            }
+        }
+    }
+
+    /*
+     * @brief Retries parked operations in order until one would block, caller holds the descriptor lock
+     */
+    static void Progress(Descriptor const& descriptor, IoQueue& queue, IoQueue& completed) noexcept
+    {
+        while (!queue.Empty())
+        {
+            auto const result = Perform(descriptor, *queue.m_Head);
+            if (result == -EAGAIN || result == -EWOULDBLOCK)
+            {
+                return;
+            }
+
+            auto* operation = queue.Pop();
+            operation->m_Result = result;
+            completed.Push(operation);
+        }
+    }
+
+    /*
+     * @brief Queues a finished operation for dispatch on a worker
+     */
+    void Complete(IoOperation* operation) noexcept
+    {
+        bool wasEmpty;
+        {
+            std::lock_guard lock(m_ReadyLock);
+            wasEmpty = m_Ready.Empty();
+            m_Ready.Push(operation);
+        }
+
+        if (wasEmpty && t_Worker != this)
+        {
+            (void)::eventfd_write(m_Wake, 1);
+        }
+    }
+
+    /*
+     * @brief Moves up to one batch of ready operations to `completed`
+     */
+    void TakeReady(IoQueue& completed) noexcept
+    {
+        bool leftover;
+        {
+            std::lock_guard lock(m_ReadyLock);
+            for (std::size_t taken = 0; taken < m_BatchSize && !m_Ready.Empty(); ++taken)
+            {
+                completed.Push(m_Ready.Pop());
+            }
+
+            leftover = !m_Ready.Empty();
+        }
+
+        // Let an idle worker take the rest
+        if (leftover)
+        {
+            (void)::eventfd_write(m_Wake, 1);
+        }
+    }
+#endif
+};
@@ -0,0 +1,563 @@
+#pragma once
+#include "handle.hpp"
+#include "completion_engine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <sys/timerfd.h>
+#endif
+
+/*
+ * @brief Recycles coroutine frames of IoTask in per-thread free lists
+ *
+ * Frames are rounded up to `Granularity` and kept per size class, at most `MaxCachedPerClass`
+ * of each per thread. A frame released on another thread than the one that allocated it goes
+ * to the releasing thread's list. Frames larger than `MaxPooledSize` are not pooled.
+ */
+class CoroutineFramePool
+{
+public:
+    static constexpr std::size_t Granularity       = 64;
+    static constexpr std::size_t MaxPooledSize     = 4096;
+    static constexpr std::size_t MaxCachedPerClass = 256;
+
+private:
+    static constexpr std::size_t Classes = MaxPooledSize / Granularity;
+
+    struct FreeFrame
+    {
+        FreeFrame* m_Next;
+    };
+
+    struct ThreadCache
+    {
+        FreeFrame*    m_Free[Classes]  = {};
+        std::uint32_t m_Count[Classes] = {};
+
+        ~ThreadCache()
+        {
+            t_CacheAlive = false;
+
+            for (std::size_t i = 0; i < Classes; ++i)
+            {
+                while (auto* frame = m_Free[i])
+                {
+                    m_Free[i] = frame->m_Next;
+                    ::operator delete(frame, (i + 1) * Granularity);
+                }
+
+                m_Count[i] = 0;
+            }
+        }
+    };
+
+    [[nodiscard]] static ThreadCache& Cache() noexcept
+    {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Trivially destructible, so still readable after the cache is gone. Frames of coroutines
+    // destroyed by later thread_local or static destructors then bypass it.
+    static inline thread_local bool t_CacheAlive = true;
+
+    static std::atomic<std::size_t>& AllocatedCounter() noexcept
+    {
+        static std::atomic<std::size_t> allocated = 0;
+        return allocated;
+    }
+
+public:
+    [[nodiscard]] static void* Allocate(std::size_t size)
+    {
+        if (size > MaxPooledSize)
+        {
+            AllocatedCounter().fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+
+        auto const index = (size - 1) / Granularity;
+        if (!t_CacheAlive)
+        {
+            AllocatedCounter().fetch_add(1, std::memory_order_relaxed);
+            return ::operator new((index + 1) * Granularity);
+        }
+
+        auto& cache = Cache();
+        if (auto* frame = cache.m_Free[index])
+        {
+            cache.m_Free[index] = frame->m_Next;
+            --cache.m_Count[index];
+            return frame;
+        }
+
+        AllocatedCounter().fetch_add(1, std::memory_order_relaxed);
+        return ::operator new((index + 1) * Granularity);
+    }
+
+    static void Release(void* frame, std::size_t size) noexcept
+    {
+        if (size > MaxPooledSize)
+        {
+            ::operator delete(frame, size);
+            return;
+        }
+
+        auto const index = (size - 1) / Granularity;
+        if (!t_CacheAlive)
+        {
+            ::operator delete(frame, (index + 1) * Granularity);
+            return;
+        }
+
+        auto& cache = Cache();
+        if (cache.m_Count[index] == MaxCachedPerClass)
+        {
+            ::operator delete(frame, (index + 1) * Granularity);
+            return;
+        }
+
+        cache.m_Free[index] = ::new (frame) FreeFrame{ cache.m_Free[index] };
+        ++cache.m_Count[index];
+    }
+
+    /*
+     * @brief Frames that could not be served from a free list, flat in steady state
+     */
+    [[nodiscard]] static std::size_t Allocated() noexcept
+    {
+        return AllocatedCounter().load(std::memory_order_relaxed);
+    }
+};
+
+template<typename _Ty>
+class IoTask;
+
+namespace IoTaskDetail
+{
+    struct PromiseBase
+    {
+        std::coroutine_handle<> m_Continuation;
+        bool                    m_Detached = false;
+
+        struct FinalAwaiter
+        {
+            [[nodiscard]] bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            template<typename _Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<_Promise> coroutine) noexcept
+            {
+                auto& promise = coroutine.promise();
+                if (promise.m_Continuation)
+                {
+                    return promise.m_Continuation;
+                }
+
+                if (promise.m_Detached)
+                {
+                    coroutine.destroy();
+                }
+
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        [[nodiscard]] static void* operator new(std::size_t size)
+        {
+            return CoroutineFramePool::Allocate(size);
+        }
+
+        static void operator delete(void* frame, std::size_t size) noexcept
+        {
+            CoroutineFramePool::Release(frame, size);
+        }
+
+        [[nodiscard]] std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        [[nodiscard]] FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        // Handles never throw, anything that does is a bug
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    template<typename _Ty>
+    struct Promise : PromiseBase
+    {
+        std::optional<_Ty> m_Value;
+
+        [[nodiscard]] IoTask<_Ty> get_return_object() noexcept;
+
+        void return_value(_Ty value)
+        {
+            m_Value.emplace(std::move(value));
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase
+    {
+        [[nodiscard]] IoTask<void> get_return_object() noexcept;
+
+        void return_void() const noexcept {}
+    };
+}
+
+/*
+ * @brief Lazily started coroutine whose frame comes from CoroutineFramePool
+ *
+ * Either `co_await` it from another coroutine, which resumes when it finishes, or `Start()`
+ * it from plain code, after which it runs until its first suspension and frees itself when
+ * done. Exceptions terminate.
+ */
+template<typename _Ty = void>
+class IoTask
+{
+public:
+    using promise_type = IoTaskDetail::Promise<_Ty>;
+
+private:
+    std::coroutine_handle<promise_type> m_Coroutine;
+
+public:
+    explicit IoTask(std::coroutine_handle<promise_type> coroutine) noexcept
+        : m_Coroutine(coroutine)
+    {}
+
+    IoTask(IoTask&& other) noexcept
+        : m_Coroutine(std::exchange(other.m_Coroutine, nullptr))
+    {}
+
+    IoTask& operator=(IoTask&& other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+            if (m_Coroutine)
+            {
+                m_Coroutine.destroy();
+            }
+
+            m_Coroutine = std::exchange(other.m_Coroutine, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~IoTask()
+    {
+        if (m_Coroutine)
+        {
+            m_Coroutine.destroy();
+        }
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return static_cast<bool>(m_Coroutine);
+    }
+
+    /*
+     * @brief Runs the task on the calling thread until it first suspends, it frees itself when done
+     */
+    void Start() && noexcept
+    {
+        auto const coroutine = std::exchange(m_Coroutine, nullptr);
+        coroutine.promise().m_Detached = true;
+        coroutine.resume();
+    }
+
+    [[nodiscard]] bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_Coroutine.promise().m_Continuation = awaiting;
+        return m_Coroutine;
+    }
+
+    _Ty await_resume() noexcept
+    {
+        if constexpr (!std::is_void_v<_Ty>)
+        {
+            return std::move(*m_Coroutine.promise().m_Value);
+        }
+    }
+};
+
+template<typename _Ty>
+IoTask<_Ty> IoTaskDetail::Promise<_Ty>::get_return_object() noexcept
+{
+    return IoTask<_Ty>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+inline IoTask<void> IoTaskDetail::Promise<void>::get_return_object() noexcept
+{
+    return IoTask<void>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+/*
+ * @brief Awaiter starting a CompletionEngine operation and resuming from its callback
+ *
+ * The coroutine resumes on whichever engine worker (or RunOnce caller) ran the callback.
+ * `co_await` yields the operation result: bytes transferred, the accepted socket, 0 for
+ * waits, or a negated error code. `StartFailed` means the operation could not be started,
+ * e.g. the operation pool is exhausted or the handle is not associated.
+ *
+ * @tparam Callable starting the operation, `bool(CompletionEngine&, IoCallback, void*)`,
+ *         optionally with `Finish(result)` mapping the raw result
+ */
+template<typename _Start>
+class IoAwaitable
+{
+public:
+#if defined(_WIN32)
+    static constexpr std::int64_t StartFailed = -ERROR_NO_SYSTEM_RESOURCES;
+#else
+    static constexpr std::int64_t StartFailed = -ENOBUFS;
+#endif
+
+private:
+    CompletionEngine&       m_Engine;
+    _Start                  m_Start;
+    std::coroutine_handle<> m_Coroutine;
+    std::int64_t            m_Result = 0;
+
+public:
+    IoAwaitable(CompletionEngine& engine, _Start start) noexcept
+        : m_Engine(engine)
+        , m_Start(std::move(start))
+    {}
+
+    [[nodiscard]] bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) noexcept
+    {
+        m_Coroutine = coroutine;
+        if (!m_Start(m_Engine, &OnComplete, this))
+        {
+            m_Result = StartFailed;
+            return false;
+        }
+
+        // May already be resumed on a worker, `this` must not be touched anymore
+        return true;
+    }
+
+    [[nodiscard]] std::int64_t await_resume() noexcept
+    {
+        if constexpr (requires { m_Start.Finish(m_Result); })
+        {
+            return m_Result == StartFailed ? m_Result : m_Start.Finish(m_Result);
+        }
+        else
+        {
+            return m_Result;
+        }
+    }
+
+private:
+    static void OnComplete(IoOperation& operation, std::int64_t result) noexcept
+    {
+        auto& awaitable = *static_cast<IoAwaitable*>(operation.m_Context);
+        awaitable.m_Result = result;
+        awaitable.m_Coroutine.resume();
+    }
+};
+
+/*
+ * @brief Reads into `buffer` at `offset` (ignored for streams), `handle` must be associated with `engine`
+ */
+template<typename _Ty, typename _ClosePolicy>
+[[nodiscard]] auto ReadAsync(CompletionEngine& engine, Handle<_Ty, _ClosePolicy> const& handle, std::span<std::byte> buffer,
+                             std::uint64_t offset = 0) noexcept
+{
+    return IoAwaitable(engine, [&handle, buffer, offset](CompletionEngine& engine, IoCallback callback, void* context) noexcept
+    {
+        return engine.Read(handle, buffer, offset, callback, context);
+    });
+}
+
+/*
+ * @brief Writes `buffer` at `offset` (ignored for streams), `handle` must be associated with `engine`
+ */
+template<typename _Ty, typename _ClosePolicy>
+[[nodiscard]] auto WriteAsync(CompletionEngine& engine, Handle<_Ty, _ClosePolicy> const& handle, std::span<std::byte const> buffer,
+                              std::uint64_t offset = 0) noexcept
+{
+    return IoAwaitable(engine, [&handle, buffer, offset](CompletionEngine& engine, IoCallback callback, void* context) noexcept
+    {
+        return engine.Write(handle, buffer, offset, callback, context);
+    });
+}
+
+[[nodiscard]] inline auto ReceiveAsync(CompletionEngine& engine, SocketHandle const& socket, std::span<std::byte> buffer) noexcept
+{
+    return ReadAsync(engine, socket, buffer);
+}
+
+[[nodiscard]] inline auto SendAsync(CompletionEngine& engine, SocketHandle const& socket, std::span<std::byte const> buffer) noexcept
+{
+    return WriteAsync(engine, socket, buffer);
+}
+
+namespace IoAwaitableDetail
+{
+    struct Accept
+    {
+        SocketHandle const& m_Listener;
+#if defined(_WIN32)
+        alignas(sockaddr_storage) std::byte m_Addresses[CompletionEngine::AcceptBufferSize];
+#endif
+
+        bool operator()(CompletionEngine& engine, IoCallback callback, void* context) noexcept
+        {
+#if defined(_WIN32)
+            return engine.Accept(m_Listener, m_Addresses, callback, context);
+#else
+            return engine.Accept(m_Listener, {}, callback, context);
+#endif
+        }
+    };
+
+#if !defined(_WIN32)
+    template<typename _Ty>
+    concept CounterHandle = std::is_same_v<_Ty, TaggedHandle<HandleType::Event>>
+                         || std::is_same_v<_Ty, TaggedHandle<HandleType::Semaphore>>
+                         || std::is_same_v<_Ty, TaggedHandle<HandleType::WaitableTimer>>;
+
+    // eventfd and timerfd waits read the counter, which resets them like a satisfied Windows wait
+    template<typename _Ty, typename _ClosePolicy>
+        requires CounterHandle<_Ty>
+    struct ConsumingWait
+    {
+        Handle<_Ty, _ClosePolicy> const& m_Handle;
+        std::uint64_t                    m_Counter = 0;
+
+        bool operator()(CompletionEngine& engine, IoCallback callback, void* context) noexcept
+        {
+            return engine.Read(m_Handle, std::as_writable_bytes(std::span(&m_Counter, 1)), 0, callback, context);
+        }
+
+        [[nodiscard]] std::int64_t Finish(std::int64_t result) const noexcept
+        {
+            return result < 0 ? result : 0;
+        }
+    };
+#endif
+
+    template<typename _Ty, typename _ClosePolicy>
+    struct Wait
+    {
+        Handle<_Ty, _ClosePolicy> const& m_Handle;
+
+        bool operator()(CompletionEngine& engine, IoCallback callback, void* context) noexcept
+        {
+            return engine.Wait(m_Handle, callback, context);
+        }
+    };
+}
+
+/*
+ * @brief Accepts a connection on `listener`, the result is the accepted socket or -error
+ *
+ * Take ownership of a non-negative result with SocketHandle(static_cast<SOCKET>(result)).
+ */
+[[nodiscard]] inline auto AcceptAsync(CompletionEngine& engine, SocketHandle const& listener) noexcept
+{
+    return IoAwaitable(engine, IoAwaitableDetail::Accept{ listener });
+}
+
+/*
+ * @brief Sends `request` on `socket` (TransmitFile / sendfile), the result is the total bytes sent or -error
+ */
+[[nodiscard]] inline auto TransmitAsync(CompletionEngine& engine, SocketHandle const& socket, TransmitRequest& request) noexcept
+{
+    return IoAwaitable(engine, [&socket, &request](CompletionEngine& engine, IoCallback callback, void* context) noexcept
+    {
+        return engine.Transmit(socket, request, callback, context);
+    });
+}
+
+/*
+ * @brief Waits for an event, semaphore, waitable timer or process handle, the result is 0 or -error
+ *
+ * Auto-reset events, semaphores and timers are consumed by the wait, as on Windows; on Linux
+ * their eventfd/timerfd counter is read, so `handle` must be associated with `engine` there.
+ * Linux pipes and sockets can be waited on too, the wait ends once they are readable and
+ * leaves the data in place. Epoll instances are rejected at compile time.
+ */
+template<typename _Ty, typename _ClosePolicy>
+    requires WaitableHandleType<_Ty>
+[[nodiscard]] auto WaitAsync(CompletionEngine& engine, Handle<_Ty, _ClosePolicy> const& handle) noexcept
+{
+#if defined(_WIN32)
+    return IoAwaitable(engine, IoAwaitableDetail::Wait<_Ty, _ClosePolicy>{ handle });
+#else
+    if constexpr (IoAwaitableDetail::CounterHandle<_Ty>)
+    {
+        return IoAwaitable(engine, IoAwaitableDetail::ConsumingWait<_Ty, _ClosePolicy>{ handle });
+    }
+    else
+    {
+        // An epoll instance is Waitable for WaitSet, but the engine cannot watch its own kind
+        static_assert(!std::is_same_v<_Ty, TaggedHandle<HandleType::IoCompletionPort>>,
+                      "WaitAsync supports event, semaphore, waitable timer, process, pipe and socket handles");
+
+        return IoAwaitable(engine, IoAwaitableDetail::Wait<_Ty, _ClosePolicy>{ handle });
+    }
+#endif
+}
+
+/*
+ * @brief Arms `timer` to expire once after `delay` right away, the returned awaitable waits for it
+ */
+template<typename _ClosePolicy>
+[[nodiscard]] auto SleepAsync(CompletionEngine& engine, Handle<TaggedHandle<HandleType::WaitableTimer>, _ClosePolicy> const& timer,
+                              std::chrono::nanoseconds delay) noexcept
+{
+    auto const ticks = std::max<std::chrono::nanoseconds::rep>(delay.count(), 1);
+
+#if defined(_WIN32)
+    // Negative due times are relative, in 100ns units
+    LARGE_INTEGER due;
+    due.QuadPart = -std::max<LONGLONG>(ticks / 100, 1);
+    ::SetWaitableTimer(timer.Get(), &due, 0, nullptr, nullptr, FALSE);
+#else
+    itimerspec expiry{};
+    expiry.it_value.tv_sec  = static_cast<time_t>(ticks / 1'000'000'000);
+    expiry.it_value.tv_nsec = static_cast<long>(ticks % 1'000'000'000);
+    ::timerfd_settime(timer.Get(), 0, &expiry, nullptr);
+#endif
+
+    return WaitAsync(engine, timer);
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include "handle.hpp"
+#include "mpmc_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/*
+ * @brief Background thread closing handles on behalf of their owners
+ *
+ * Owners enqueue the raw value into a BoundedMpmcQueue, drained by a single consumer, and
+ * return immediately. The closer thread drains the ring
+ * in batches. When the ring is full the owner closes inline, which bounds both memory and
+ * the number of handles whose close is still pending.
+ */
+class DeferredCloser
+{
+public:
+    static constexpr std::size_t DefaultCapacity  = 4096;
+    static constexpr std::size_t DefaultBatchSize = 64;
+
+private:
+    using CloseFunction = void(*)(std::intptr_t) noexcept;
+
+    struct Entry
+    {
+        CloseFunction m_Close;
+        std::intptr_t m_Handle;
+    };
+
+    BoundedMpmcQueue<Entry> m_Queue;
+    std::size_t             m_BatchSize;
+
+    alignas(64) std::atomic<std::size_t> m_Closed          = 0;
+    alignas(64) std::atomic<std::uint32_t> m_Wake          = 0;
+    std::atomic<bool>                      m_Sleeping      = false;
+    std::atomic<bool>                      m_Stop          = false;
+    std::atomic<std::size_t>               m_InlineCloses  = 0;
+
+    std::thread m_Thread;
+
+public:
+    /*
+     * @param Ring capacity, rounded up to a power of two
+     * @param Maximum number of handles closed between two progress updates
+     */
+    explicit DeferredCloser(std::size_t capacity = DefaultCapacity, std::size_t batchSize = DefaultBatchSize)
+        : m_Queue(capacity)
+        , m_BatchSize(batchSize ? batchSize : 1)
+    {
+        m_Thread = std::thread([this] { Run(); });
+    }
+
+    DeferredCloser(DeferredCloser const&) = delete;
+    DeferredCloser& operator=(DeferredCloser const&) = delete;
+
+    /*
+     * @brief Closes everything still queued and joins the closer thread
+     */
+    ~DeferredCloser()
+    {
+        m_Stop.store(true, std::memory_order_seq_cst);
+        Wake();
+        m_Thread.join();
+    }
+
+    /*
+     * @brief Process-wide closer used by CloseDeferred
+     *
+     * Intentionally never destroyed so that handles with static storage duration can still
+     * be released during shutdown. Anything pending at exit is reclaimed by the OS.
+     */
+    [[nodiscard]] static DeferredCloser& Instance()
+    {
+        static auto* instance = new DeferredCloser();
+        return *instance;
+    }
+
+public:
+    /*
+     * @brief Queues `handle` for closing, closes it inline when the ring is full
+     */
+    template<typename _Traits>
+    void Enqueue(typename _Traits::Type handle) noexcept
+    {
+        CloseFunction close = [](std::intptr_t bits) noexcept
+        {
+            _Traits::Close(HandleFromBits<typename _Traits::Type>(bits));
+        };
+
+        if (!m_Queue.TryPush({ close, HandleToBits(handle) }))
+        {
+            m_InlineCloses.fetch_add(1, std::memory_order_relaxed);
+            _Traits::Close(handle);
+            return;
+        }
+
+        // Pairs with the fence in Run(), either the closer sees the new entry or we see it sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Sleeping.load(std::memory_order_relaxed))
+        {
+            Wake();
+        }
+    }
+
+    /*
+     * @brief Blocks until every handle enqueued before this call has been closed
+     */
+    void Flush() noexcept
+    {
+        auto const target = m_Queue.Pushed();
+
+        auto closed = m_Closed.load(std::memory_order_acquire);
+        while (closed < target)
+        {
+            m_Closed.wait(closed, std::memory_order_acquire);
+            closed = m_Closed.load(std::memory_order_acquire);
+        }
+    }
+
+    /*
+     * @brief Number of handles closed on the owner's thread because the ring was full
+     */
+    [[nodiscard]] std::size_t InlineCloses() const noexcept
+    {
+        return m_InlineCloses.load(std::memory_order_relaxed);
+    }
+
+private:
+    void Wake() noexcept
+    {
+        m_Sleeping.store(false, std::memory_order_relaxed);
+        m_Wake.fetch_add(1, std::memory_order_release);
+        m_Wake.notify_one();
+    }
+
+    void Run() noexcept
+    {
+        std::size_t position = 0;
+
+        for (;;)
+        {
+            std::size_t batch = 0;
+            Entry entry{};
+            while (batch < m_BatchSize && m_Queue.TryPop(entry))
+            {
+                entry.m_Close(entry.m_Handle);
+
+                ++position;
+                ++batch;
+            }
+
+            if (batch != 0)
+            {
+                m_Closed.store(position, std::memory_order_release);
+                m_Closed.notify_all();
+                continue;
+            }
+
+            if (m_Stop.load(std::memory_order_acquire)
+                && m_Queue.Pushed() == position)
+            {
+                return;
+            }
+
+            auto const wake = m_Wake.load(std::memory_order_acquire);
+            m_Sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!m_Queue.Empty() || m_Stop.load(std::memory_order_acquire))
+            {
+                m_Sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            m_Wake.wait(wake, std::memory_order_acquire);
+        }
+    }
+};
+
+/*
+ * @brief Handle close policy handing valid handles to DeferredCloser::Instance()
+ *
+ * Destructors return in the time of one enqueue instead of waiting on CloseHandle/close(2),
+ * which can block for milliseconds after large writes or on lingering sockets. Call
+ * `DeferredCloser::Instance().Flush()` where the close must have happened, e.g. before
+ * reopening a file with exclusive sharing.
+ */
+struct CloseDeferred
+{
+    template<typename _Traits>
+    static void Close(typename _Traits::Type handle) noexcept
+    {
+        DeferredCloser::Instance().Enqueue<_Traits>(handle);
+    }
+};
+
+template<typename _Ty>
+using DeferredHandle = Handle<_Ty, CloseDeferred>;
@@ -0,0 +1,228 @@
+#pragma once
+#include "handle.hpp"
+#include "mpmc_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+#if !defined(_WIN32)
+#include <sys/eventfd.h>
+#endif
+
+/*
+ * @brief Reset behaviour of pooled events
+ *
+ * On Linux both kinds are non-blocking eventfds, whoever reads the counter resets it.
+ */
+enum class EventReset
+{
+    Auto,
+    Manual,
+};
+
+template<EventReset _Reset>
+class EventPool;
+
+/*
+ * @brief Handle close policy returning events to EventPool<_Reset>::Instance() instead of closing them
+ */
+template<EventReset _Reset>
+struct ReturnToEventPool
+{
+    template<typename _Traits>
+    static void Close(typename _Traits::Type handle) noexcept
+    {
+        EventPool<_Reset>::Instance().Release(handle);
+    }
+};
+
+template<EventReset _Reset = EventReset::Auto>
+using PooledEventHandle = Handle<TaggedHandle<HandleType::Event>, ReturnToEventPool<_Reset>>;
+
+/*
+ * @brief Recycles events so per-request overlapped I/O does not pay for CreateEvent/CloseHandle
+ *
+ * Acquire() pops from a small per-thread cache first, refills it from a bounded lock-free
+ * global freelist (Vyukov's MPMC ring) and creates a new event only when both are empty.
+ * Released events are reset and pushed back the same way; when the cache overflows, half of
+ * it spills to the global freelist and whatever does not fit there is closed. At most
+ * `DefaultCapacity` events plus `ThreadCacheSize` per thread stay pooled. Once a thread's
+ * cache is destroyed at thread exit, its Acquire() and Release() use the global freelist only.
+ */
+template<EventReset _Reset>
+class EventPool
+{
+public:
+    using Type   = typename PooledEventHandle<_Reset>::Type;
+    using Traits = typename PooledEventHandle<_Reset>::Traits;
+
+    static constexpr std::size_t DefaultCapacity = 1024;
+    static constexpr std::size_t ThreadCacheSize = 32;
+
+private:
+    struct ThreadCache
+    {
+        Type        m_Events[ThreadCacheSize];
+        std::size_t m_Count = 0;
+
+        // Hands the cached events to the global freelist when the thread exits
+        ~ThreadCache()
+        {
+            t_CacheAlive = false;
+
+            auto& pool = Instance();
+            while (m_Count != 0)
+            {
+                pool.Push(m_Events[--m_Count]);
+            }
+        }
+    };
+
+    static inline thread_local ThreadCache t_Cache;
+
+    // Trivially destructible, so still readable after t_Cache is gone. Releases from later
+    // thread_local or static destructors then bypass the cache.
+    static inline thread_local bool t_CacheAlive = true;
+
+    BoundedMpmcQueue<Type> m_Freelist;
+
+    alignas(64) std::atomic<std::size_t> m_Created = 0;
+
+    // Per-thread caches belong to the process-wide instance, there are no others
+    explicit EventPool(std::size_t capacity)
+        : m_Freelist(capacity)
+    {}
+
+public:
+    EventPool(EventPool const&) = delete;
+    EventPool& operator=(EventPool const&) = delete;
+
+    /*
+     * @brief Process-wide pool used by ReturnToEventPool, with a DefaultCapacity global freelist
+     *
+     * Never destroyed, pooled handles may be released from static destructors and thread exit.
+     */
+    [[nodiscard]] static EventPool& Instance()
+    {
+        static auto* instance = new EventPool(DefaultCapacity);
+        return *instance;
+    }
+
+public:
+    /*
+     * @brief Event in the non-signaled state, invalid only if a new one had to be created and that failed
+     */
+    [[nodiscard]] PooledEventHandle<_Reset> Acquire(HandleCallSite site = HandleCallSite::current()) noexcept
+    {
+        if (!t_CacheAlive)
+        {
+            Type event;
+            if (Pop(event))
+            {
+                return PooledEventHandle<_Reset>(event, site);
+            }
+
+            m_Created.fetch_add(1, std::memory_order_relaxed);
+            return PooledEventHandle<_Reset>(Create(), site);
+        }
+
+        auto& cache = t_Cache;
+        if (cache.m_Count == 0)
+        {
+            // Refill half, leaving room for releases without an immediate spill
+            while (cache.m_Count < ThreadCacheSize / 2 && Pop(cache.m_Events[cache.m_Count]))
+            {
+                ++cache.m_Count;
+            }
+        }
+
+        if (cache.m_Count != 0)
+        {
+            return PooledEventHandle<_Reset>(cache.m_Events[--cache.m_Count], site);
+        }
+
+        m_Created.fetch_add(1, std::memory_order_relaxed);
+        return PooledEventHandle<_Reset>(Create(), site);
+    }
+
+    /*
+     * @brief Resets `event` and keeps it for reuse
+     */
+    void Release(Type event) noexcept
+    {
+        if (!Traits::Valid(event))
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        ::ResetEvent(event);
+#else
+        eventfd_t value;
+        (void)::eventfd_read(event, &value);
+#endif
+
+        if (!t_CacheAlive)
+        {
+            Push(event);
+            return;
+        }
+
+        auto& cache = t_Cache;
+        if (cache.m_Count == ThreadCacheSize)
+        {
+            while (cache.m_Count > ThreadCacheSize / 2)
+            {
+                Push(cache.m_Events[--cache.m_Count]);
+            }
+        }
+
+        cache.m_Events[cache.m_Count++] = event;
+    }
+
+    /*
+     * @brief Closes every event in the global freelist, per-thread caches are left alone
+     */
+    void Trim() noexcept
+    {
+        Type event;
+        while (Pop(event))
+        {
+            Traits::Close(event);
+        }
+    }
+
+    /*
+     * @brief Number of events created because the pool was empty
+     */
+    [[nodiscard]] std::size_t Created() const noexcept
+    {
+        return m_Created.load(std::memory_order_relaxed);
+    }
+
+private:
+    [[nodiscard]] static Type Create() noexcept
+    {
+#if defined(_WIN32)
+        return ::CreateEventW(nullptr, _Reset == EventReset::Manual, FALSE, nullptr);
+#else
+        return ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+    }
+
+    /*
+     * @brief Moves `event` to the global freelist, closes it when the freelist is full
+     */
+    void Push(Type event) noexcept
+    {
+        if (!m_Freelist.TryPush(event))
+        {
+            Traits::Close(event);
+        }
+    }
+
+    [[nodiscard]] bool Pop(Type& event) noexcept
+    {
+        return m_Freelist.TryPop(event);
+    }
+};
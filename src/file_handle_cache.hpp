@@ -0,0 +1,684 @@
+#pragma once
+#include "handle.hpp"
+#include "shared_handle.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#endif
+
+/*
+ * @brief Access and sharing a cached file is opened with, part of the cache key
+ */
+struct FileOpenMode
+{
+    std::uint32_t m_Access; // GENERIC_READ ... / O_RDONLY ...
+    std::uint32_t m_Share;  // FILE_SHARE_* on Windows, unused on Linux
+
+    /*
+     * @brief Read-only, on Windows shared so that cached files can still be renamed and deleted
+     */
+    [[nodiscard]] static constexpr FileOpenMode Read() noexcept
+    {
+#if defined(_WIN32)
+        return { GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE };
+#else
+        return { O_RDONLY, 0 };
+#endif
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(FileOpenMode, FileOpenMode) noexcept = default;
+};
+
+/*
+ * @brief Shared reference to a cached file, keeps it open after eviction until released
+ */
+using FileLease = SharedHandle<TaggedHandle<HandleType::File>>;
+
+/*
+ * @brief Open-file cache keyed by normalized absolute path and FileOpenMode
+ *
+ * Entries are spread over shards by path, each with its own lock and LRU list, so lookups
+ * of different files rarely contend. Files are opened outside the shard lock and evicted
+ * handles are released outside of it as well. `Open()` hands out FileLeases; an evicted or
+ * invalidated file stays open until its last lease is gone.
+ *
+ * Cached files go stale when renamed or deleted. Call `Invalidate()` / `InvalidateTree()`,
+ * or let `Watch()` do it from directory change notifications (ReadDirectoryChangesW on
+ * Windows, one thread per directory; inotify on Linux, one thread per cache).
+ *
+ * On Windows paths differing only in case are separate entries.
+ */
+class FileHandleCache
+{
+public:
+    static constexpr std::size_t DefaultShards = 16;
+
+private:
+    using PathString = std::filesystem::path::string_type;
+
+    struct Key
+    {
+        PathString   m_Path;
+        FileOpenMode m_Mode;
+
+        [[nodiscard]] friend bool operator==(Key const&, Key const&) = default;
+    };
+
+    struct KeyHash
+    {
+        [[nodiscard]] std::size_t operator()(Key const& key) const noexcept
+        {
+            auto const mode = static_cast<std::size_t>(key.m_Mode.m_Access) * 31 + key.m_Mode.m_Share;
+            return std::hash<PathString>{}(key.m_Path) ^ (mode * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    struct Entry
+    {
+        Key       m_Key;
+        FileLease m_File;
+    };
+
+    struct Shard
+    {
+        std::mutex                                                     m_Lock;
+        std::list<Entry>                                               m_Lru;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>   m_Index;
+        // Bumped by every invalidation, opens that raced with one are not cached
+        std::uint64_t                                                  m_Generation = 0;
+        std::size_t                                                    m_Hits       = 0;
+        std::size_t                                                    m_Misses     = 0;
+    };
+
+    std::unique_ptr<Shard[]> m_Shards;
+    std::size_t              m_ShardCount;
+    std::size_t              m_ShardCapacity;
+
+    std::mutex        m_WatchLock;
+    std::atomic<bool> m_StopWatching = false;
+
+#if defined(_WIN32)
+    std::vector<std::thread> m_Watchers;
+    EventHandle              m_StopWatch;
+#else
+    FileHandle                                      m_Inotify;
+    EventHandle                                     m_StopWatch;
+    std::thread                                     m_Watcher;
+    std::unordered_map<int, std::filesystem::path>  m_Watches;
+#endif
+
+public:
+    /*
+     * @param Maximum number of cached files, which is also the number of handles the cache keeps open
+     * @param Number of independently locked shards
+     */
+    explicit FileHandleCache(std::size_t capacity = DefaultCapacity(), std::size_t shards = DefaultShards)
+        : m_Shards(std::make_unique<Shard[]>(shards ? shards : 1))
+        , m_ShardCount(shards ? shards : 1)
+        , m_ShardCapacity(std::max<std::size_t>(1, (capacity + m_ShardCount - 1) / m_ShardCount))
+    {
+    }
+
+    FileHandleCache(FileHandleCache const&) = delete;
+    FileHandleCache& operator=(FileHandleCache const&) = delete;
+
+    ~FileHandleCache()
+    {
+        StopWatching();
+    }
+
+    /*
+     * @brief 4096, lowered to a quarter of RLIMIT_NOFILE on Linux so the cache never starves the process of descriptors
+     */
+    [[nodiscard]] static std::size_t DefaultCapacity() noexcept
+    {
+        std::size_t capacity = 4096;
+
+#if !defined(_WIN32)
+        rlimit limit;
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        {
+            capacity = std::min<std::size_t>(capacity, std::max<std::size_t>(1, limit.rlim_cur / 4));
+        }
+#endif
+
+        return capacity;
+    }
+
+public:
+    /*
+     * @brief Lease on the cached handle for `path`, opening and caching it on a miss
+     *
+     * @return Invalid lease when the file cannot be opened
+     */
+    [[nodiscard]] FileLease Open(std::filesystem::path const& path, FileOpenMode mode = FileOpenMode::Read())
+    {
+        Key key{ Normalize(path), mode };
+        auto& shard = ShardFor(key.m_Path);
+
+        std::uint64_t generation;
+        {
+            std::lock_guard lock(shard.m_Lock);
+
+            auto const found = shard.m_Index.find(key);
+            if (found != shard.m_Index.end())
+            {
+                ++shard.m_Hits;
+                shard.m_Lru.splice(shard.m_Lru.begin(), shard.m_Lru, found->second);
+                return found->second->m_File;
+            }
+
+            ++shard.m_Misses;
+            generation = shard.m_Generation;
+        }
+
+        FileLease file(OpenFile(key));
+        if (!file.Valid())
+        {
+            return file;
+        }
+
+        // Released after unlocking, the last close of an evicted file can block
+        std::list<Entry> evicted;
+        {
+            std::lock_guard lock(shard.m_Lock);
+
+            auto const found = shard.m_Index.find(key);
+            if (found != shard.m_Index.end())
+            {
+                // Another thread opened it meanwhile, share theirs and drop ours
+                return found->second->m_File;
+            }
+
+            if (generation != shard.m_Generation)
+            {
+                return file;
+            }
+
+            shard.m_Lru.push_front(Entry{ std::move(key), file });
+            shard.m_Index.emplace(shard.m_Lru.front().m_Key, shard.m_Lru.begin());
+
+            if (shard.m_Lru.size() > m_ShardCapacity)
+            {
+                shard.m_Index.erase(shard.m_Lru.back().m_Key);
+                evicted.splice(evicted.end(), shard.m_Lru, std::prev(shard.m_Lru.end()));
+            }
+        }
+
+        return file;
+    }
+
+    /*
+     * @brief Drops every cached handle for `path`, in any mode
+     */
+    void Invalidate(std::filesystem::path const& path)
+    {
+        auto const normalized = Normalize(path);
+        auto& shard = ShardFor(normalized);
+
+        std::list<Entry> dropped;
+        std::lock_guard lock(shard.m_Lock);
+
+        ++shard.m_Generation;
+        for (auto it = shard.m_Lru.begin(); it != shard.m_Lru.end();)
+        {
+            auto const next = std::next(it);
+            if (it->m_Key.m_Path == normalized)
+            {
+                shard.m_Index.erase(it->m_Key);
+                dropped.splice(dropped.end(), shard.m_Lru, it);
+            }
+
+            it = next;
+        }
+    }
+
+    /*
+     * @brief Drops `directory` and everything cached below it, e.g. after the directory was renamed
+     */
+    void InvalidateTree(std::filesystem::path const& directory)
+    {
+        auto prefix = Normalize(directory);
+        auto const exact = prefix;
+        if (prefix.empty() || prefix.back() != std::filesystem::path::preferred_separator)
+        {
+            prefix.push_back(std::filesystem::path::preferred_separator);
+        }
+
+        DropIf([&](PathString const& path)
+        {
+            return path == exact || path.starts_with(prefix);
+        });
+    }
+
+    /*
+     * @brief Drops every cached handle
+     */
+    void Clear()
+    {
+        DropIf([](PathString const&) { return true; });
+    }
+
+    /*
+     * @brief Invalidates entries of `directory` (not recursive) when files in it are renamed or deleted
+     *
+     * @return false when the directory cannot be watched
+     */
+    bool Watch(std::filesystem::path const& directory)
+    {
+        std::filesystem::path watched(Normalize(directory));
+        std::lock_guard lock(m_WatchLock);
+
+#if defined(_WIN32)
+        if (!m_StopWatch.Valid())
+        {
+            m_StopWatch.Reset(::CreateEventW(nullptr, TRUE, FALSE, nullptr));
+            if (!m_StopWatch.Valid())
+            {
+                return false;
+            }
+        }
+
+        FileHandle handle(::CreateFileW(watched.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr));
+        EventHandle completed(::CreateEventW(nullptr, TRUE, FALSE, nullptr));
+        if (!handle.Valid() || !completed.Valid())
+        {
+            return false;
+        }
+
+        m_Watchers.emplace_back([this, watched = std::move(watched), handle = std::move(handle), completed = std::move(completed)]
+        {
+            WatchDirectory(watched, handle, completed);
+        });
+
+        return true;
+#else
+        if (!m_Inotify.Valid())
+        {
+            m_Inotify.Reset(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+            m_StopWatch.Reset(::eventfd(0, EFD_CLOEXEC));
+            if (!m_Inotify.Valid() || !m_StopWatch.Valid())
+            {
+                m_Inotify.Close();
+                return false;
+            }
+
+            m_Watcher = std::thread([this] { WatchNotifications(); });
+        }
+
+        auto const watch = ::inotify_add_watch(m_Inotify, watched.c_str(),
+                                               IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        if (watch < 0)
+        {
+            return false;
+        }
+
+        m_Watches[watch] = std::move(watched);
+        return true;
+#endif
+    }
+
+    /*
+     * @brief Number of cached handles, exact only while no other thread uses the cache
+     */
+    [[nodiscard]] std::size_t Size() noexcept
+    {
+        return Sum([](Shard const& shard) { return shard.m_Lru.size(); });
+    }
+
+    [[nodiscard]] std::size_t Hits() noexcept
+    {
+        return Sum([](Shard const& shard) { return shard.m_Hits; });
+    }
+
+    [[nodiscard]] std::size_t Misses() noexcept
+    {
+        return Sum([](Shard const& shard) { return shard.m_Misses; });
+    }
+
+private:
+    /*
+     * @brief Absolute path without `.`/`..` components or repeated separators, already what Normalize() returns
+     *
+     * Conservative, anything unusual takes the slow path.
+     */
+    [[nodiscard]] static bool IsNormal(PathString const& path) noexcept
+    {
+        constexpr auto separator = std::filesystem::path::preferred_separator;
+
+#if defined(_WIN32)
+        if (path.size() < 3 || path[1] != L':' || path[2] != separator)
+        {
+            return false;
+        }
+#else
+        if (path.empty() || path[0] != separator)
+        {
+            return false;
+        }
+#endif
+
+        for (std::size_t i = 0; i < path.size(); ++i)
+        {
+#if defined(_WIN32)
+            if (path[i] == L'/')
+            {
+                return false;
+            }
+#endif
+            if (path[i] != separator || i + 1 == path.size())
+            {
+                continue;
+            }
+
+            auto const next = path[i + 1];
+            if (next == separator)
+            {
+                return false;
+            }
+
+            if (next == '.')
+            {
+                auto const end = path.find(separator, i + 1);
+                auto const length = (end == PathString::npos ? path.size() : end) - (i + 1);
+                if (length == 1 || (length == 2 && path[i + 2] == '.'))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] static PathString Normalize(std::filesystem::path const& path)
+    {
+        if (IsNormal(path.native()))
+        {
+            return path.native();
+        }
+
+        std::error_code error;
+        auto absolute = std::filesystem::absolute(path, error);
+        return (error ? path : absolute).lexically_normal().native();
+    }
+
+    [[nodiscard]] Shard& ShardFor(PathString const& path) noexcept
+    {
+        return m_Shards[std::hash<PathString>{}(path) % m_ShardCount];
+    }
+
+    [[nodiscard]] static FileHandle OpenFile(Key const& key) noexcept
+    {
+#if defined(_WIN32)
+        return FileHandle(::CreateFileW(key.m_Path.c_str(), key.m_Mode.m_Access, key.m_Mode.m_Share, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL, nullptr));
+#else
+        return FileHandle(::open(key.m_Path.c_str(), static_cast<int>(key.m_Mode.m_Access) | O_CLOEXEC));
+#endif
+    }
+
+    template<typename _Predicate>
+    void DropIf(_Predicate&& predicate)
+    {
+        for (std::size_t i = 0; i < m_ShardCount; ++i)
+        {
+            auto& shard = m_Shards[i];
+
+            std::list<Entry> dropped;
+            std::lock_guard lock(shard.m_Lock);
+
+            ++shard.m_Generation;
+            for (auto it = shard.m_Lru.begin(); it != shard.m_Lru.end();)
+            {
+                auto const next = std::next(it);
+                if (predicate(it->m_Key.m_Path))
+                {
+                    shard.m_Index.erase(it->m_Key);
+                    dropped.splice(dropped.end(), shard.m_Lru, it);
+                }
+
+                it = next;
+            }
+        }
+    }
+
+    /*
+     * @brief Drops the normalized `directory` and everything cached below it
+     *
+     * Watchers call this and DropChild, they compare in place instead of building paths whose
+     * allocation could fail on their noexcept threads.
+     */
+    void DropTree(PathString const& directory) noexcept
+    {
+        constexpr auto separator = std::filesystem::path::preferred_separator;
+
+        DropIf([&](PathString const& path) noexcept
+        {
+            return path.starts_with(directory)
+                && (path.size() == directory.size() || directory.empty() || directory.back() == separator
+                    || path[directory.size()] == separator);
+        });
+    }
+
+    /*
+     * @brief Drops `name` in the normalized `directory`, with everything below it when `tree`
+     */
+    void DropChild(PathString const& directory, std::basic_string_view<PathString::value_type> name, bool tree) noexcept
+    {
+        constexpr auto separator = std::filesystem::path::preferred_separator;
+
+        DropIf([&](PathString const& path) noexcept
+        {
+            std::basic_string_view<PathString::value_type> rest(path);
+            if (!rest.starts_with(directory))
+            {
+                return false;
+            }
+
+            rest.remove_prefix(directory.size());
+            if (directory.empty() || directory.back() != separator)
+            {
+                if (rest.empty() || rest.front() != separator)
+                {
+                    return false;
+                }
+
+                rest.remove_prefix(1);
+            }
+
+            if (!rest.starts_with(name))
+            {
+                return false;
+            }
+
+            rest.remove_prefix(name.size());
+            return rest.empty() || (tree && rest.front() == separator);
+        });
+    }
+
+    template<typename _Field>
+    [[nodiscard]] std::size_t Sum(_Field&& field) noexcept
+    {
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < m_ShardCount; ++i)
+        {
+            std::lock_guard lock(m_Shards[i].m_Lock);
+            sum += field(m_Shards[i]);
+        }
+
+        return sum;
+    }
+
+    void StopWatching() noexcept
+    {
+        {
+            std::lock_guard lock(m_WatchLock);
+            if (!m_StopWatch.Valid())
+            {
+                return;
+            }
+
+            m_StopWatching.store(true, std::memory_order_release);
+#if defined(_WIN32)
+            ::SetEvent(m_StopWatch);
+#else
+            (void)::eventfd_write(m_StopWatch, 1);
+#endif
+        }
+
+        // Watchers take m_WatchLock themselves, join without holding it
+#if defined(_WIN32)
+        for (auto& watcher : m_Watchers)
+        {
+            watcher.join();
+        }
+#else
+        if (m_Watcher.joinable())
+        {
+            m_Watcher.join();
+        }
+#endif
+    }
+
+#if defined(_WIN32)
+    void WatchDirectory(std::filesystem::path const& directory, FileHandle const& handle, EventHandle const& completed) noexcept
+    {
+        alignas(DWORD) std::byte buffer[16 * 1024];
+
+        while (!m_StopWatching.load(std::memory_order_acquire))
+        {
+            OVERLAPPED overlapped{};
+            overlapped.hEvent = completed;
+            ::ResetEvent(completed);
+
+            if (!::ReadDirectoryChangesW(handle, buffer, sizeof(buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME,
+                                         nullptr, &overlapped, nullptr))
+            {
+                return;
+            }
+
+            HANDLE const objects[] = { m_StopWatch, completed };
+            if (::WaitForMultipleObjects(2, objects, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+            {
+                DWORD ignored;
+                ::CancelIoEx(handle, &overlapped);
+                ::GetOverlappedResult(handle, &overlapped, &ignored, TRUE);
+                return;
+            }
+
+            DWORD bytes = 0;
+            if (!::GetOverlappedResult(handle, &overlapped, &bytes, FALSE))
+            {
+                return;
+            }
+
+            // The notification buffer overflowed, anything in the directory may have changed
+            if (bytes == 0)
+            {
+                DropTree(directory.native());
+                continue;
+            }
+
+            for (std::size_t offset = 0;;)
+            {
+                auto const* notification = reinterpret_cast<FILE_NOTIFY_INFORMATION const*>(buffer + offset);
+
+                if (notification->Action == FILE_ACTION_REMOVED
+                    || notification->Action == FILE_ACTION_RENAMED_OLD_NAME
+                    || notification->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                {
+                    // The entry may have been a directory, which cannot be told after the fact
+                    DropChild(directory.native(), std::wstring_view(notification->FileName, notification->FileNameLength / sizeof(WCHAR)), true);
+                }
+
+                if (notification->NextEntryOffset == 0)
+                {
+                    break;
+                }
+
+                offset += notification->NextEntryOffset;
+            }
+        }
+    }
+#else
+    void WatchNotifications() noexcept
+    {
+        alignas(inotify_event) char buffer[16 * 1024];
+
+        for (;;)
+        {
+            pollfd descriptors[] = { { m_Inotify, POLLIN, 0 }, { m_StopWatch, POLLIN, 0 } };
+            if (::poll(descriptors, 2, -1) < 0 && errno != EINTR)
+            {
+                return;
+            }
+
+            if (m_StopWatching.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            auto const length = ::read(m_Inotify, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;)
+            {
+                auto const* event = reinterpret_cast<inotify_event const*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    Clear();
+                    continue;
+                }
+
+                // Held while dropping, so the directory is used in place instead of copied
+                std::lock_guard lock(m_WatchLock);
+
+                auto const found = m_Watches.find(event->wd);
+                if (found == m_Watches.end())
+                {
+                    continue;
+                }
+
+                if (event->mask & IN_IGNORED)
+                {
+                    m_Watches.erase(found);
+                    continue;
+                }
+
+                auto const& directory = found->second.native();
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                {
+                    DropTree(directory);
+                }
+                else if (event->len != 0)
+                {
+                    DropChild(directory, event->name, (event->mask & IN_ISDIR) != 0);
+                }
+            }
+        }
+    }
+#endif
+};
@@ -2,82 +2,229 @@
 #include <type_traits>
 #include <cstdint>
 #include <concepts>
-#include <windows.h>
 #include <bit>
+#include <memory>
+#include <utility>
+
+#include "handle_tracker.hpp"
+
+#if defined(_WIN32)
+// Before windows.h, which otherwise pulls in the conflicting winsock.h
+#include <winsock2.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 /*
  * @brief Creates a HandleTraits<_Ty> specialization
  *
  * @param Handle type
- * @param Invalid handle value for specified handle type
+ * @param Integer encoding of the invalid handle value for specified handle type
  * @param Closing function for specified handle type
  */
-#define CREATE_HANDLE_TRAITS(type, invalidHandleValue, handleCloseFunction)             \
-template<>                                                                              \
-struct HandleTraits<type>                                                               \
-{                                                                                       \
-    using Type = type;                                                                  \
-                                                                                        \
-    inline static const Type InvalidHandleValue = invalidHandleValue;                   \
-                                                                                        \
-    static void Close(Type handle) noexcept { ::handleCloseFunction(handle);  }         \
-    static bool Valid(Type handle) noexcept { return handle != InvalidHandleValue; }    \
+#define CREATE_HANDLE_TRAITS(type, invalidHandleBits, handleCloseFunction)                                  \
+template<>                                                                                                  \
+struct HandleTraits<type>                                                                                   \
+{                                                                                                           \
+    using Type = type;                                                                                      \
+                                                                                                            \
+    static constexpr std::intptr_t InvalidHandleBits = invalidHandleBits;                                   \
+                                                                                                            \
+    [[nodiscard]] static constexpr Type InvalidHandleValue() noexcept                                       \
+    {                                                                                                       \
+        return HandleFromBits<Type>(InvalidHandleBits);                                                     \
+    }                                                                                                       \
+                                                                                                            \
+    static void Close(Type handle) noexcept { ::handleCloseFunction(handle);  }                             \
+    [[nodiscard]] static constexpr bool Valid(Type handle) noexcept                                         \
+    {                                                                                                       \
+        return HandleToBits(handle) != InvalidHandleBits;                                                   \
+    }                                                                                                       \
 };
 
+/*
+ * @brief Integer encoding of a handle value
+ *
+ * Pointer sentinels like INVALID_HANDLE_VALUE are reinterpret_casts and can never be
+ * constexpr, so traits keep the integer encoding instead. Both conversions compile to
+ * nothing, which lets `Valid()` fold into a single compare against an immediate.
+ */
+template<typename _Ty>
+[[nodiscard]] constexpr std::intptr_t HandleToBits(_Ty handle) noexcept
+{
+    if constexpr (std::is_pointer_v<_Ty>)
+    {
+        return reinterpret_cast<std::intptr_t>(handle);
+    }
+    else
+    {
+        return static_cast<std::intptr_t>(handle);
+    }
+}
+
+template<typename _Ty>
+[[nodiscard]] constexpr _Ty HandleFromBits(std::intptr_t bits) noexcept
+{
+    if constexpr (std::is_pointer_v<_Ty>)
+    {
+        return reinterpret_cast<_Ty>(bits);
+    }
+    else
+    {
+        return static_cast<_Ty>(bits);
+    }
+}
+
+/*
+ * @brief Platform handle type wrapped by TaggedHandle
+ */
+#if defined(_WIN32)
+using NativeHandle = HANDLE;
+#else
+using NativeHandle = int;
+#endif
+
+/*
+ * @brief What a kernel object behind a tag supports, declared by every HandleType tag
+ */
+enum class HandleCapabilities : std::uint32_t
+{
+    None       = 0,
+    Waitable   = 1 << 0, // WaitForSingleObject / poll readiness
+    Overlapped = 1 << 1, // OVERLAPPED I/O / io_uring
+    Duplicable = 1 << 2, // DuplicateHandle / dup
+};
+
+[[nodiscard]] constexpr HandleCapabilities operator|(HandleCapabilities lhs, HandleCapabilities rhs) noexcept
+{
+    return static_cast<HandleCapabilities>(static_cast<std::uint32_t>(lhs) | static_cast<std::uint32_t>(rhs));
+}
+
+[[nodiscard]] constexpr HandleCapabilities operator&(HandleCapabilities lhs, HandleCapabilities rhs) noexcept
+{
+    return static_cast<HandleCapabilities>(static_cast<std::uint32_t>(lhs) & static_cast<std::uint32_t>(rhs));
+}
+
+/*
+ * @brief Bases for HandleType tags sharing a sentinel and a closing function
+ */
+namespace HandleKind
+{
+#if defined(_WIN32)
+    struct NullKernelObject
+    {
+        static constexpr std::intptr_t InvalidHandleBits = 0;
+
+        static void Close(HANDLE handle) noexcept { ::CloseHandle(handle); }
+    };
+
+    struct InvalidKernelObject
+    {
+        // INVALID_HANDLE_VALUE is ((HANDLE)(LONG_PTR)-1)
+        static constexpr std::intptr_t InvalidHandleBits = -1;
+
+        static void Close(HANDLE handle) noexcept { ::CloseHandle(handle); }
+    };
+#else
+    struct Descriptor
+    {
+        static constexpr std::intptr_t InvalidHandleBits = -1;
+
+        // close(2) releases the descriptor even when it fails with EINTR. Retrying
+        // could close a descriptor that another thread has just been handed.
+        static void Close(int handle) noexcept { ::close(handle); }
+    };
+#endif
+
+    /*
+     * @brief Base for tags without an equivalent on the current platform, fails HandleTag
+     */
+    struct Unsupported {};
+}
+
 /*
  * @brief HANDLE tags for TaggedHandle struct
  *
  * HANDLE is reponsible for many types of different resources. Tags provide a way
- * to distinguish them from each other. First part of the namespace has resources
- * that default to NULL. Second part has resources that default to INVALID_HANDLE_VALUE
+ * to distinguish them from each other. Every tag is the single place declaring its
+ * invalid value (InvalidHandleBits), how it is closed (Close) and what it supports
+ * (Capabilities). Adding a kernel object type means adding one tag per platform block.
+ *
+ * On POSIX the tags map onto file descriptors: Event is an eventfd, Semaphore an
+ * EFD_SEMAPHORE eventfd, WaitableTimer a timerfd, Process a pidfd, IoCompletionPort an
+ * epoll instance, Job a cgroup v2 directory, FileMapping a memfd, Snapshot a /proc
+ * directory, NamedPipe a pipe/FIFO end, Socket a socket and File a regular file.
  */
 namespace HandleType
 {
-    struct Event            {};
-    struct Mutex            {};
-    struct Semaphore        {};
-    struct Process          {};
-    struct Thread           {};
-    struct IoCompletionPort {};
-    struct Job              {};
-    struct WaitableTimer    {};
-
-    struct File        {};
-    struct NamedPipe   {};
-    struct MailSlot    {};
-    struct FileMapping {};
-    struct Snapshot    {};
+#if defined(_WIN32)
+    struct Event            : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Mutex            : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Semaphore        : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Process          : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Thread           : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct IoCompletionPort : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::None; };
+    struct Job              : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct WaitableTimer    : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+
+    struct File             : HandleKind::InvalidKernelObject { static constexpr auto Capabilities = HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+    struct NamedPipe        : HandleKind::InvalidKernelObject { static constexpr auto Capabilities = HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+    struct MailSlot         : HandleKind::InvalidKernelObject { static constexpr auto Capabilities = HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+    // CreateFileMapping fails with NULL, the sentinel was INVALID_HANDLE_VALUE before
+    struct FileMapping      : HandleKind::NullKernelObject    { static constexpr auto Capabilities = HandleCapabilities::Duplicable; };
+    struct Snapshot         : HandleKind::InvalidKernelObject { static constexpr auto Capabilities = HandleCapabilities::None; };
+
+    // SOCKET is not a HANDLE, see HandleTraits<SOCKET>
+    struct Socket           : HandleKind::Unsupported {};
+#else
+    struct Event            : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Semaphore        : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct Process          : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+    struct IoCompletionPort : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable; };
+    struct Job              : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Duplicable; };
+    struct WaitableTimer    : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Duplicable; };
+
+    struct File             : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+    struct NamedPipe        : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+    struct FileMapping      : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Duplicable; };
+    struct Snapshot         : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::None; };
+    struct Socket           : HandleKind::Descriptor { static constexpr auto Capabilities = HandleCapabilities::Waitable | HandleCapabilities::Overlapped | HandleCapabilities::Duplicable; };
+
+    // No descriptor equivalent
+    struct Mutex            : HandleKind::Unsupported {};
+    struct Thread           : HandleKind::Unsupported {};
+    struct MailSlot         : HandleKind::Unsupported {};
+#endif
 }
 
+/*
+ * @brief A tag usable with TaggedHandle on the current platform
+ */
 template<typename _Tag>
-concept HandleValueNull = std::is_same_v<_Tag, HandleType::Event> || 
-                          std::is_same_v<_Tag, HandleType::Mutex> ||
-                          std::is_same_v<_Tag, HandleType::Process> ||
-                          std::is_same_v<_Tag, HandleType::Thread> ||
-                          std::is_same_v<_Tag, HandleType::Job> ||
-                          std::is_same_v<_Tag, HandleType::WaitableTimer> ||
-                          std::is_same_v<_Tag, HandleType::IoCompletionPort>;
-
-template<typename _Tag>
-concept HandleValueInvalid = std::is_same_v<_Tag, HandleType::File> ||
-                             std::is_same_v<_Tag, HandleType::NamedPipe> ||
-                             std::is_same_v<_Tag, HandleType::FileMapping> ||
-                             std::is_same_v<_Tag, HandleType::MailSlot> ||
-                             std::is_same_v<_Tag, HandleType::Snapshot>;
+concept HandleTag = requires(NativeHandle handle)
+{
+    { _Tag::Close(handle) } noexcept;
+    requires std::same_as<std::remove_cv_t<decltype(_Tag::InvalidHandleBits)>, std::intptr_t>;
+    requires std::same_as<std::remove_cv_t<decltype(_Tag::Capabilities)>, HandleCapabilities>;
+    std::integral_constant<std::intptr_t, _Tag::InvalidHandleBits>{};
+};
 
 /*
- * @brief TaggedHandle wraps HANDLE type and adds a HandleType::<Tag> to it for clarity.
+ * @brief TaggedHandle wraps HANDLE (or a file descriptor on POSIX) and adds a HandleType::<Tag> to it for clarity.
  */
 template<typename _Tag>
 struct TaggedHandle
 {
+    static_assert(HandleTag<_Tag>, "Handle type is not available on this platform");
+
     using Tag = _Tag;
-    using Type = HANDLE;
+    using Type = NativeHandle;
 
     Type m_Handle;
 
 public:
-    constexpr explicit TaggedHandle() noexcept
+    explicit TaggedHandle() noexcept
         : m_Handle(GetHandleInvalidValue())
     {}
 
@@ -85,20 +232,17 @@ public:
         : m_Handle(handle)
     {}
 
-    [[nodiscard]] static constexpr HANDLE GetHandleInvalidValue() noexcept
+    /*
+     * @brief Integer encoding of the invalid value, usable in constant expressions
+     */
+    [[nodiscard]] static constexpr std::intptr_t GetHandleInvalidBits() noexcept
     {
-        if constexpr (HandleValueNull<_Tag>)
-        {
-            return nullptr;
-        }
-        else if constexpr (HandleValueInvalid<_Tag>)
-        {
-            return INVALID_HANDLE_VALUE;
-        }
-        else
-        {
-            static_assert(sizeof(_Tag) == 0, "Unhandled handle type");
-        }
+        return _Tag::InvalidHandleBits;
+    }
+
+    [[nodiscard]] static constexpr Type GetHandleInvalidValue() noexcept
+    {
+        return HandleFromBits<Type>(GetHandleInvalidBits());
     }
 };
 
@@ -111,7 +255,7 @@ template<typename _Ty>
 struct HandleTraits;
 
 /*
- * @brief HandleTraits specialization for TaggedHandle types
+ * @brief HandleTraits specialization for TaggedHandle types, generated from the tag
  *
  * @tparam HandleType tag
  */
@@ -122,30 +266,105 @@ struct HandleTraits<TaggedHandle<_Tag>>
     using Type   = Handle::Type;
     using Tag    = Handle::Tag;
 
-    inline static const Type InvalidHandleValue = Handle::GetHandleInvalidValue();
+    static constexpr std::intptr_t      InvalidHandleBits = Handle::GetHandleInvalidBits();
+    static constexpr HandleCapabilities Capabilities      = _Tag::Capabilities;
+
+    [[nodiscard]] static constexpr Type InvalidHandleValue() noexcept
+    {
+        return HandleFromBits<Type>(InvalidHandleBits);
+    }
 
     static void Close(Type handle) noexcept 
     { 
-        ::CloseHandle(handle); 
+        _Tag::Close(handle);
     }
     
-    [[nodiscard]] static bool Valid(Type handle) noexcept 
+    [[nodiscard]] static constexpr bool Valid(Type handle) noexcept 
     { 
-        return handle != InvalidHandleValue; 
+        return HandleToBits(handle) != InvalidHandleBits; 
+    }
+};
+
+/*
+ * @brief Whether HandleTraits<_Ty> declares all of `capability`, false for traits without capabilities
+ */
+template<typename _Ty>
+[[nodiscard]] constexpr bool HandleHasCapability(HandleCapabilities capability) noexcept
+{
+    if constexpr (requires { HandleTraits<_Ty>::Capabilities; })
+    {
+        return (HandleTraits<_Ty>::Capabilities & capability) == capability;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename _Ty>
+concept WaitableHandleType = HandleHasCapability<_Ty>(HandleCapabilities::Waitable);
+
+template<typename _Ty>
+concept OverlappedHandleType = HandleHasCapability<_Ty>(HandleCapabilities::Overlapped);
+
+template<typename _Ty>
+concept DuplicableHandleType = HandleHasCapability<_Ty>(HandleCapabilities::Duplicable);
+
+#if defined(_WIN32)
+/*
+ * @brief SOCKET is an unsigned integer, not a HANDLE, closed with closesocket
+ *
+ * Its sentinel is INVALID_SOCKET (~0); 0 is a valid socket value. Sockets opened with
+ * WSA_FLAG_OVERLAPPED (the socket() default) support overlapped I/O, but DuplicateHandle
+ * and waiting on them are not supported.
+ */
+template<>
+struct HandleTraits<SOCKET>
+{
+    using Type = SOCKET;
+
+    static constexpr std::intptr_t InvalidHandleBits = HandleToBits(INVALID_SOCKET);
+    static constexpr HandleCapabilities Capabilities = HandleCapabilities::Overlapped;
+
+    [[nodiscard]] static constexpr Type InvalidHandleValue() noexcept
+    {
+        return HandleFromBits<Type>(InvalidHandleBits);
+    }
+
+    static void Close(Type handle) noexcept { ::closesocket(handle); }
+    [[nodiscard]] static constexpr bool Valid(Type handle) noexcept
+    {
+        return HandleToBits(handle) != InvalidHandleBits;
     }
 };
 
-CREATE_HANDLE_TRAITS(SOCKET,    NULL,    closesocket)
-CREATE_HANDLE_TRAITS(HKEY,      nullptr, RegCloseKey)
-CREATE_HANDLE_TRAITS(HWND,      nullptr, DestroyWindow)
-CREATE_HANDLE_TRAITS(HMENU,     nullptr, DestroyMenu)
-CREATE_HANDLE_TRAITS(HICON,     nullptr, DestroyIcon)
-CREATE_HANDLE_TRAITS(HDC,       nullptr, DeleteDC)
-CREATE_HANDLE_TRAITS(HBITMAP,   nullptr, DeleteObject)
-CREATE_HANDLE_TRAITS(HPEN,      nullptr, DeleteObject)
-CREATE_HANDLE_TRAITS(HBRUSH,    nullptr, DeleteObject)
-CREATE_HANDLE_TRAITS(HPALETTE,  nullptr, DeleteObject)
-CREATE_HANDLE_TRAITS(HINSTANCE, nullptr, FreeLibrary)
+CREATE_HANDLE_TRAITS(HKEY,      0, RegCloseKey)
+CREATE_HANDLE_TRAITS(HWND,      0, DestroyWindow)
+CREATE_HANDLE_TRAITS(HMENU,     0, DestroyMenu)
+CREATE_HANDLE_TRAITS(HICON,     0, DestroyIcon)
+CREATE_HANDLE_TRAITS(HDC,       0, DeleteDC)
+CREATE_HANDLE_TRAITS(HBITMAP,   0, DeleteObject)
+CREATE_HANDLE_TRAITS(HPEN,      0, DeleteObject)
+CREATE_HANDLE_TRAITS(HBRUSH,    0, DeleteObject)
+CREATE_HANDLE_TRAITS(HPALETTE,  0, DeleteObject)
+CREATE_HANDLE_TRAITS(HINSTANCE, 0, FreeLibrary)
+
+static_assert(HandleTag<HandleType::Event> && HandleTag<HandleType::Mutex> && HandleTag<HandleType::Semaphore> &&
+              HandleTag<HandleType::Process> && HandleTag<HandleType::Thread> && HandleTag<HandleType::IoCompletionPort> &&
+              HandleTag<HandleType::Job> && HandleTag<HandleType::WaitableTimer> && HandleTag<HandleType::File> &&
+              HandleTag<HandleType::NamedPipe> && HandleTag<HandleType::MailSlot> && HandleTag<HandleType::FileMapping> &&
+              HandleTag<HandleType::Snapshot>);
+static_assert(HandleTraits<TaggedHandle<HandleType::Event>>::InvalidHandleBits == 0);
+static_assert(HandleTraits<TaggedHandle<HandleType::File>>::InvalidHandleBits == -1);
+static_assert(HandleTraits<SOCKET>::InvalidHandleBits == -1 && !HandleTraits<SOCKET>::Valid(INVALID_SOCKET) && HandleTraits<SOCKET>::Valid(0));
+#else
+static_assert(HandleTag<HandleType::Event> && HandleTag<HandleType::Semaphore> && HandleTag<HandleType::Process> &&
+              HandleTag<HandleType::IoCompletionPort> && HandleTag<HandleType::Job> && HandleTag<HandleType::WaitableTimer> &&
+              HandleTag<HandleType::File> && HandleTag<HandleType::NamedPipe> && HandleTag<HandleType::FileMapping> &&
+              HandleTag<HandleType::Snapshot> && HandleTag<HandleType::Socket>);
+static_assert(HandleTraits<TaggedHandle<HandleType::Event>>::InvalidHandleBits == -1);
+static_assert(HandleTraits<TaggedHandle<HandleType::File>>::InvalidHandleBits == -1);
+#endif
 
 template<typename _Ty>
 struct HandleBaseType
@@ -160,35 +379,78 @@ struct HandleBaseType<TaggedHandle<_Tag>>
 };
 
 /*
- * @brief RAII Wrapper around Windows API handles
+ * @brief Default Handle close policy, closes on the calling thread
+ */
+struct CloseImmediately
+{
+    template<typename _Traits>
+    static void Close(typename _Traits::Type handle) noexcept
+    {
+        _Traits::Close(handle);
+    }
+};
+
+/*
+ * @brief RAII Wrapper around Windows API handles and POSIX file descriptors
  *
  * @tparam Handle type
+ * @tparam Policy deciding where and when a valid handle gets closed
  */
-template<typename _Ty>
-class Handle
+template<typename _Ty, typename _ClosePolicy = CloseImmediately>
+class Handle : private HandleTracking<_Ty>
 {
-private:
+public:
     using Traits = HandleTraits<_Ty>;
     using Type   = typename HandleBaseType<_Ty>::Type;
 
+private:
+    using Tracking = HandleTracking<_Ty>;
+
     Type m_Handle;
 
 public:
-    constexpr Handle(Type handle = Traits::InvalidHandleValue) noexcept
+    /*
+     * @param Handle to own
+     * @param Where the handle was created, only recorded with HANDLE_TRACK_CALL_SITES
+     */
+    constexpr Handle(Type handle = Traits::InvalidHandleValue(), HandleCallSite site = HandleCallSite::current()) noexcept
         : m_Handle(handle)
-    {}
+    {
+        if (Traits::Valid(m_Handle))
+        {
+            Tracking::TrackOpen(HandleToBits(m_Handle), site);
+        }
+    }
 
     Handle(Handle const&) = delete;
     Handle& operator=(Handle const&) = delete;
 
-    Handle& operator=(Type handle) noexcept
+    /*
+     * @brief Transfers ownership from `other`, leaving it invalid. Never closes anything.
+     */
+    Handle(Handle&& other) noexcept
+        : Tracking(std::move(other))
+        , m_Handle(std::exchange(other.m_Handle, Traits::InvalidHandleValue()))
+    {}
+
+    /*
+     * @brief Closes the currently owned handle and takes ownership from `other`.
+     */
+    Handle& operator=(Handle&& other) noexcept
     {
-        if (Valid())
+        if (this != std::addressof(other))
         {
             Close();
+            m_Handle = std::exchange(other.m_Handle, Traits::InvalidHandleValue());
+            Tracking::operator=(std::move(other));
         }
 
-        m_Handle = handle;
+        return *this;
+    }
+
+    Handle& operator=(Type handle) noexcept
+    {
+        Reset(handle, HandleCallSite{});
         return *this;
     }
 
@@ -207,8 +469,37 @@ public:
     {
         if (Traits::Valid(m_Handle))
         {
-            Traits::Close(m_Handle);
-            m_Handle = Traits::InvalidHandleValue;
+            Tracking::TrackClose(HandleToBits(m_Handle));
+            _ClosePolicy::template Close<Traits>(m_Handle);
+            m_Handle = Traits::InvalidHandleValue();
+        }
+    }
+
+    /*
+     * @brief Gives up ownership without closing
+     *
+     * @return Previously owned handle, caller becomes responsible for closing it
+     */
+    [[nodiscard]] Type Release() noexcept
+    {
+        Tracking::TrackRelease(HandleToBits(m_Handle));
+        return std::exchange(m_Handle, Traits::InvalidHandleValue());
+    }
+
+    /*
+     * @brief Closes the currently owned handle (if valid) and takes ownership of `handle`
+     *
+     * @param New handle to own, defaults to type specific invalid value
+     * @param Where the handle was created, only recorded with HANDLE_TRACK_CALL_SITES
+     */
+    void Reset(Type handle = Traits::InvalidHandleValue(), HandleCallSite site = HandleCallSite::current()) noexcept
+    {
+        Close();
+        m_Handle = handle;
+
+        if (Traits::Valid(m_Handle))
+        {
+            Tracking::TrackOpen(HandleToBits(m_Handle), site);
         }
     }
 
@@ -235,6 +526,7 @@ public:
     }
 };
 
+#if defined(_WIN32)
 using EventHandle            = Handle<TaggedHandle<HandleType::Event>>;
 using MutexHandle            = Handle<TaggedHandle<HandleType::Mutex>>;
 using SemaphoreHandle        = Handle<TaggedHandle<HandleType::Semaphore>>;
@@ -248,4 +540,19 @@ using FileHandle        = Handle<TaggedHandle<HandleType::File>>;
 using NamedPipeHandle   = Handle<TaggedHandle<HandleType::NamedPipe>>;
 using MailSlotHandle    = Handle<TaggedHandle<HandleType::MailSlot>>;
 using FileMappingHandle = Handle<TaggedHandle<HandleType::FileMapping>>;
-using SnapshotHandle    = Handle<TaggedHandle<HandleType::Snapshot>>;
\ No newline at end of file
+using SnapshotHandle    = Handle<TaggedHandle<HandleType::Snapshot>>;
+using SocketHandle      = Handle<SOCKET>;
+#else
+using EventHandle            = Handle<TaggedHandle<HandleType::Event>>;
+using SemaphoreHandle        = Handle<TaggedHandle<HandleType::Semaphore>>;
+using ProcessHandle          = Handle<TaggedHandle<HandleType::Process>>;
+using IoCompletionPortHandle = Handle<TaggedHandle<HandleType::IoCompletionPort>>;
+using JobHandle              = Handle<TaggedHandle<HandleType::Job>>;
+using WaitableTimerHandle    = Handle<TaggedHandle<HandleType::WaitableTimer>>;
+
+using FileHandle        = Handle<TaggedHandle<HandleType::File>>;
+using NamedPipeHandle   = Handle<TaggedHandle<HandleType::NamedPipe>>;
+using FileMappingHandle = Handle<TaggedHandle<HandleType::FileMapping>>;
+using SnapshotHandle    = Handle<TaggedHandle<HandleType::Snapshot>>;
+using SocketHandle      = Handle<TaggedHandle<HandleType::Socket>>;
+#endif
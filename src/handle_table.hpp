@@ -0,0 +1,259 @@
+#pragma once
+#include "handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+ * @brief Stable reference to a handle stored in a HandleTable
+ *
+ * The generation is bumped every time a slot is freed, so an id kept around after its handle
+ * was erased never resolves to whatever handle later reuses the slot (or the raw value).
+ */
+struct HandleId
+{
+    static constexpr std::uint32_t InvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t m_Index      = InvalidIndex;
+    std::uint32_t m_Generation = 0;
+
+    [[nodiscard]] constexpr bool Valid() const noexcept
+    {
+        return m_Index != InvalidIndex;
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(HandleId, HandleId) noexcept = default;
+};
+
+/*
+ * @brief Generational slot map owning Handle<_Ty> objects
+ *
+ * Live handles are packed into a dense array (with a parallel array pointing back at their
+ * slots) so iteration touches live handles only and nothing else. Slots form a sparse
+ * indirection with an intrusive free list. Insert, lookup and erase are O(1); erase moves
+ * the last dense element into the hole.
+ *
+ * @tparam Handle type
+ * @tparam Close policy of the stored handles
+ */
+template<typename _Ty, typename _ClosePolicy = CloseImmediately>
+class HandleTable
+{
+public:
+    using Owned = Handle<_Ty, _ClosePolicy>;
+    using Type  = typename Owned::Type;
+
+private:
+    struct Slot
+    {
+        // Dense index while occupied, next free slot while free
+        std::uint32_t m_Index;
+        std::uint32_t m_Generation;
+    };
+
+    std::vector<Owned>         m_Handles;
+    std::vector<std::uint32_t> m_DenseToSlot;
+    std::vector<Slot>          m_Slots;
+    std::uint32_t              m_FreeHead = HandleId::InvalidIndex;
+
+public:
+    HandleTable() = default;
+
+    HandleTable(HandleTable const&) = delete;
+    HandleTable& operator=(HandleTable const&) = delete;
+
+    HandleTable(HandleTable&&) noexcept = default;
+    HandleTable& operator=(HandleTable&&) noexcept = default;
+
+public:
+    /*
+     * @brief Takes ownership of `handle`
+     *
+     * @return Id resolving to the handle until it is erased or extracted
+     */
+    [[nodiscard]] HandleId Insert(Owned&& handle)
+    {
+        // Grow all arrays up front, nothing below can throw once this succeeds
+        if (m_Handles.size() == m_Handles.capacity())
+        {
+            Reserve(m_Handles.empty() ? 16 : m_Handles.size() * 2);
+        }
+
+        auto const dense = static_cast<std::uint32_t>(m_Handles.size());
+        m_Handles.push_back(std::move(handle));
+
+        std::uint32_t slot;
+        if (m_FreeHead != HandleId::InvalidIndex)
+        {
+            slot       = m_FreeHead;
+            m_FreeHead = m_Slots[slot].m_Index;
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(m_Slots.size());
+            m_Slots.push_back({ 0, 0 });
+        }
+
+        m_Slots[slot].m_Index = dense;
+        m_DenseToSlot.push_back(slot);
+
+        return { slot, m_Slots[slot].m_Generation };
+    }
+
+    /*
+     * @brief Closes and removes the handle `id` refers to
+     *
+     * @return false for stale or invalid ids
+     */
+    bool Erase(HandleId id) noexcept
+    {
+        if (!Contains(id))
+        {
+            return false;
+        }
+
+        RemoveDense(Free(id.m_Index));
+        return true;
+    }
+
+    /*
+     * @brief Removes the handle `id` refers to without closing it
+     *
+     * @return The owned handle, or an invalid one for stale ids
+     */
+    [[nodiscard]] Owned Extract(HandleId id) noexcept
+    {
+        if (!Contains(id))
+        {
+            return Owned();
+        }
+
+        auto const dense = Free(id.m_Index);
+        Owned extracted(std::move(m_Handles[dense]));
+        RemoveDense(dense);
+
+        return extracted;
+    }
+
+    [[nodiscard]] bool Contains(HandleId id) const noexcept
+    {
+        return id.m_Index < m_Slots.size() && m_Slots[id.m_Index].m_Generation == id.m_Generation;
+    }
+
+    /*
+     * @return Pointer to the stored handle, nullptr for stale or invalid ids
+     */
+    [[nodiscard]] Owned* Find(HandleId id) noexcept
+    {
+        // Handle overloads operator&
+        return Contains(id) ? std::addressof(m_Handles[m_Slots[id.m_Index].m_Index]) : nullptr;
+    }
+
+    [[nodiscard]] Owned const* Find(HandleId id) const noexcept
+    {
+        return const_cast<HandleTable*>(this)->Find(id);
+    }
+
+    /*
+     * @brief Raw value for `id`, the type specific invalid value for stale ids
+     */
+    [[nodiscard]] Type Get(HandleId id) const noexcept
+    {
+        auto const* handle = Find(id);
+        return handle ? handle->Get() : Owned::Traits::InvalidHandleValue();
+    }
+
+    /*
+     * @brief Id of the handle at position `dense` of the live range
+     */
+    [[nodiscard]] HandleId IdAt(std::size_t dense) const noexcept
+    {
+        auto const slot = m_DenseToSlot[dense];
+        return { slot, m_Slots[slot].m_Generation };
+    }
+
+    void Reserve(std::size_t count)
+    {
+        m_Handles.reserve(count);
+        m_DenseToSlot.reserve(count);
+        m_Slots.reserve(count);
+    }
+
+    /*
+     * @brief Closes every handle, outstanding ids become stale
+     */
+    void Clear() noexcept
+    {
+        while (!m_Handles.empty())
+        {
+            RemoveDense(Free(m_DenseToSlot.back()));
+        }
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept
+    {
+        return m_Handles.size();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept
+    {
+        return m_Handles.empty();
+    }
+
+public:
+    // Iteration covers live handles only, order changes on erase
+    [[nodiscard]] std::span<Owned> Handles() noexcept
+    {
+        return m_Handles;
+    }
+
+    [[nodiscard]] std::span<Owned const> Handles() const noexcept
+    {
+        return m_Handles;
+    }
+
+    [[nodiscard]] auto begin() noexcept       { return m_Handles.begin(); }
+    [[nodiscard]] auto end() noexcept         { return m_Handles.end(); }
+    [[nodiscard]] auto begin() const noexcept { return m_Handles.begin(); }
+    [[nodiscard]] auto end() const noexcept   { return m_Handles.end(); }
+
+private:
+    /*
+     * @brief Retires `slot` onto the free list
+     *
+     * @return Dense index the slot pointed at
+     */
+    std::uint32_t Free(std::uint32_t slot) noexcept
+    {
+        auto& freed = m_Slots[slot];
+        auto const dense = freed.m_Index;
+
+        ++freed.m_Generation;
+        freed.m_Index = m_FreeHead;
+        m_FreeHead    = slot;
+
+        return dense;
+    }
+
+    /*
+     * @brief Destroys dense element `dense` by moving the last element into its place
+     */
+    void RemoveDense(std::uint32_t dense) noexcept
+    {
+        auto const last = static_cast<std::uint32_t>(m_Handles.size() - 1);
+        if (dense != last)
+        {
+            m_Handles[dense]     = std::move(m_Handles[last]);
+            m_DenseToSlot[dense] = m_DenseToSlot[last];
+            m_Slots[m_DenseToSlot[dense]].m_Index = dense;
+        }
+
+        m_Handles.pop_back();
+        m_DenseToSlot.pop_back();
+    }
+};
@@ -0,0 +1,482 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(HANDLE_TRACK_CALL_SITES)
+#include <source_location>
+#endif
+
+/*
+ * @brief Live-handle census and leak tracking
+ *
+ * Handle<_Ty> calls into this only when HANDLE_ENABLE_TRACKING is defined, otherwise it
+ * derives from an empty HandleTracking<_Ty> whose hooks compile to nothing and the census
+ * stays empty. With tracking enabled each handle
+ * type gets relaxed open/close/release counters plus a peak, updated once per transition.
+ * Defining HANDLE_TRACK_CALL_SITES as well records every open and close (with the source
+ * location of the owning Handle's construction) into a per-thread ring buffer that
+ * `HandleTracker::Snapshot()` can collect without stopping the writers.
+ *
+ * Handles filled in through `operator&` bypass the constructor and are not counted.
+ */
+
+/*
+ * @brief Human readable name of a handle type, e.g. "TaggedHandle<HandleType::Event>"
+ */
+template<typename _Ty>
+[[nodiscard]] constexpr std::string_view HandleTypeName() noexcept
+{
+#if defined(_MSC_VER)
+    std::string_view name = __FUNCSIG__;
+    auto const begin = name.find("HandleTypeName<") + std::string_view("HandleTypeName<").size();
+    auto const end   = name.rfind(">(void)");
+#else
+    std::string_view name = __PRETTY_FUNCTION__;
+    auto const begin = name.find("_Ty = ") + std::string_view("_Ty = ").size();
+    auto const end   = name.find_first_of(";]", begin);
+#endif
+    name = name.substr(begin, end - begin);
+
+    for (auto keyword : { std::string_view("struct "), std::string_view("class ") })
+    {
+        if (name.starts_with(keyword))
+        {
+            name.remove_prefix(keyword.size());
+        }
+    }
+
+    return name;
+}
+
+/*
+ * @brief Counters for one handle type, registered in a global list on first use
+ */
+struct HandleTagStats
+{
+    std::string_view           m_Name;
+    std::atomic<std::uint64_t> m_Opened   = 0;
+    std::atomic<std::uint64_t> m_Closed   = 0;
+    std::atomic<std::uint64_t> m_Released = 0;
+    std::atomic<std::uint64_t> m_Peak     = 0;
+    HandleTagStats*            m_Next     = nullptr;
+};
+
+/*
+ * @brief Counters of one handle type at the time of a snapshot
+ */
+struct HandleTagCensus
+{
+    std::string_view m_Name;
+    std::uint64_t    m_Live;
+    std::uint64_t    m_Peak;
+    std::uint64_t    m_Opened;
+    std::uint64_t    m_Closed;
+    std::uint64_t    m_Released;
+};
+
+struct HandleTagRate
+{
+    std::string_view m_Name;
+    double           m_OpensPerSecond;
+    double           m_ClosesPerSecond;
+};
+
+/*
+ * @brief Open or close recorded with HANDLE_TRACK_CALL_SITES
+ *
+ * Closes carry the handle value only; pair them with opens by `m_Handle` to find leaks.
+ */
+struct HandleEvent
+{
+    std::string_view m_Name;
+    std::intptr_t    m_Handle;
+    char const*      m_File;
+    char const*      m_Function;
+    std::uint32_t    m_Line;
+    bool             m_Open;
+    std::int64_t     m_Time;
+};
+
+struct HandleCensus
+{
+    std::chrono::steady_clock::time_point m_Time;
+    std::vector<HandleTagCensus>          m_Tags;
+    std::vector<HandleEvent>              m_Events;
+
+    /*
+     * @brief Open/close rates per handle type between `earlier` and this snapshot
+     */
+    [[nodiscard]] std::vector<HandleTagRate> RatesSince(HandleCensus const& earlier) const
+    {
+        std::vector<HandleTagRate> rates;
+        auto const seconds = std::chrono::duration<double>(m_Time - earlier.m_Time).count();
+
+        for (auto const& tag : m_Tags)
+        {
+            std::uint64_t opened = 0;
+            std::uint64_t closed = 0;
+            for (auto const& before : earlier.m_Tags)
+            {
+                if (before.m_Name == tag.m_Name)
+                {
+                    opened = before.m_Opened;
+                    closed = before.m_Closed + before.m_Released;
+                }
+            }
+
+            rates.push_back({ tag.m_Name,
+                              seconds > 0 ? static_cast<double>(tag.m_Opened - opened) / seconds : 0.0,
+                              seconds > 0 ? static_cast<double>(tag.m_Closed + tag.m_Released - closed) / seconds : 0.0 });
+        }
+
+        return rates;
+    }
+};
+
+#if defined(HANDLE_TRACK_CALL_SITES)
+using HandleCallSite = std::source_location;
+#else
+struct HandleCallSite
+{
+    [[nodiscard]] static constexpr HandleCallSite current() noexcept { return {}; }
+
+    [[nodiscard]] constexpr char const*   file_name() const noexcept     { return ""; }
+    [[nodiscard]] constexpr char const*   function_name() const noexcept { return ""; }
+    [[nodiscard]] constexpr std::uint32_t line() const noexcept          { return 0; }
+};
+#endif
+
+/*
+ * @brief Single-writer ring of recent handle events, one per thread
+ *
+ * Every slot is a small seqlock so readers on other threads can copy it without blocking
+ * the owner. Buffers are never freed; a thread that exits hands its buffer to the next one.
+ */
+class HandleEventBuffer
+{
+public:
+    static constexpr std::size_t Capacity = 1024;
+
+private:
+    struct Slot
+    {
+        std::atomic<std::uint64_t>          m_Sequence = 0;
+        std::atomic<HandleTagStats const*>  m_Tag      = nullptr;
+        std::atomic<std::intptr_t>          m_Handle   = 0;
+        std::atomic<char const*>            m_File     = nullptr;
+        std::atomic<char const*>            m_Function = nullptr;
+        std::atomic<std::uint32_t>          m_Line     = 0;
+        std::atomic<bool>                   m_Open     = false;
+        std::atomic<std::int64_t>           m_Time     = 0;
+    };
+
+    Slot                       m_Slots[Capacity];
+    std::atomic<std::uint64_t> m_Head  = 0;
+    std::atomic<bool>          m_InUse = true;
+    HandleEventBuffer*         m_Next  = nullptr;
+
+    friend class HandleTracker;
+
+public:
+    void Push(HandleTagStats const& tag, std::intptr_t handle, HandleCallSite site, bool open) noexcept
+    {
+        auto const index = m_Head.load(std::memory_order_relaxed);
+        auto& slot = m_Slots[index % Capacity];
+
+        slot.m_Sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.m_Tag.store(&tag, std::memory_order_relaxed);
+        slot.m_Handle.store(handle, std::memory_order_relaxed);
+        slot.m_File.store(site.file_name(), std::memory_order_relaxed);
+        slot.m_Function.store(site.function_name(), std::memory_order_relaxed);
+        slot.m_Line.store(static_cast<std::uint32_t>(site.line()), std::memory_order_relaxed);
+        slot.m_Open.store(open, std::memory_order_relaxed);
+        slot.m_Time.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+        slot.m_Sequence.store(2 * index + 2, std::memory_order_release);
+        m_Head.store(index + 1, std::memory_order_release);
+    }
+
+    void Collect(std::vector<HandleEvent>& events) const
+    {
+        auto const head  = m_Head.load(std::memory_order_acquire);
+        auto const first = head > Capacity ? head - Capacity : 0;
+
+        for (auto index = first; index < head; ++index)
+        {
+            auto const& slot = m_Slots[index % Capacity];
+
+            auto const sequence = slot.m_Sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * index + 2)
+            {
+                continue;
+            }
+
+            HandleEvent event{ slot.m_Tag.load(std::memory_order_relaxed)->m_Name,
+                               slot.m_Handle.load(std::memory_order_relaxed),
+                               slot.m_File.load(std::memory_order_relaxed),
+                               slot.m_Function.load(std::memory_order_relaxed),
+                               slot.m_Line.load(std::memory_order_relaxed),
+                               slot.m_Open.load(std::memory_order_relaxed),
+                               slot.m_Time.load(std::memory_order_relaxed) };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.m_Sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                events.push_back(event);
+            }
+        }
+    }
+};
+
+/*
+ * @brief Registry of per-type counters and per-thread event buffers
+ */
+class HandleTracker
+{
+private:
+    static std::atomic<HandleTagStats*>& TagList() noexcept
+    {
+        static std::atomic<HandleTagStats*> head = nullptr;
+        return head;
+    }
+
+    static std::atomic<HandleEventBuffer*>& BufferList() noexcept
+    {
+        static std::atomic<HandleEventBuffer*> head = nullptr;
+        return head;
+    }
+
+    template<typename _Node>
+    static void Push(std::atomic<_Node*>& head, _Node* node) noexcept
+    {
+        node->m_Next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->m_Next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /*
+     * @brief Returns the calling thread's buffer, claiming an abandoned one before allocating
+     *
+     * nullptr when no buffer was free and allocating one failed, the thread then records nothing.
+     */
+    [[nodiscard]] static HandleEventBuffer* ThreadBuffer() noexcept
+    {
+        struct Lease
+        {
+            HandleEventBuffer* m_Buffer;
+
+            Lease()
+            {
+                for (auto* buffer = BufferList().load(std::memory_order_acquire); buffer; buffer = buffer->m_Next)
+                {
+                    bool expected = false;
+                    if (buffer->m_InUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    {
+                        m_Buffer = buffer;
+                        return;
+                    }
+                }
+
+                m_Buffer = new (std::nothrow) HandleEventBuffer();
+                if (m_Buffer)
+                {
+                    Push(BufferList(), m_Buffer);
+                }
+            }
+
+            ~Lease()
+            {
+                if (m_Buffer)
+                {
+                    m_Buffer->m_InUse.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local Lease lease;
+        return lease.m_Buffer;
+    }
+
+public:
+    /*
+     * @brief Counters of `_Ty`, nullptr when they could not be allocated and `_Ty` goes uncounted
+     */
+    template<typename _Ty>
+    [[nodiscard]] static HandleTagStats* Stats() noexcept
+    {
+        static HandleTagStats* stats = []() noexcept
+        {
+            auto* registered = new (std::nothrow) HandleTagStats{ .m_Name = HandleTypeName<_Ty>() };
+            if (registered)
+            {
+                Push(TagList(), registered);
+            }
+
+            return registered;
+        }();
+
+        return stats;
+    }
+
+    template<typename _Ty>
+    static void OnOpen(std::intptr_t handle, [[maybe_unused]] HandleCallSite site) noexcept
+    {
+        auto* const tag = Stats<_Ty>();
+        if (!tag)
+        {
+            return;
+        }
+
+        auto& stats = *tag;
+
+        auto const opened = stats.m_Opened.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto const live   = opened - stats.m_Closed.load(std::memory_order_relaxed)
+                                   - stats.m_Released.load(std::memory_order_relaxed);
+
+        auto peak = stats.m_Peak.load(std::memory_order_relaxed);
+        while (live > peak && !stats.m_Peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+
+#if defined(HANDLE_TRACK_CALL_SITES)
+        if (auto* buffer = ThreadBuffer())
+        {
+            buffer->Push(stats, handle, site, true);
+        }
+#else
+        (void)handle;
+#endif
+    }
+
+    template<typename _Ty>
+    static void OnClose(std::intptr_t handle) noexcept
+    {
+        auto* const stats = Stats<_Ty>();
+        if (!stats)
+        {
+            return;
+        }
+
+        stats->m_Closed.fetch_add(1, std::memory_order_relaxed);
+
+#if defined(HANDLE_TRACK_CALL_SITES)
+        if (auto* buffer = ThreadBuffer())
+        {
+            buffer->Push(*stats, handle, HandleCallSite{}, false);
+        }
+#else
+        (void)handle;
+#endif
+    }
+
+    template<typename _Ty>
+    static void OnRelease(std::intptr_t) noexcept
+    {
+        if (auto* stats = Stats<_Ty>())
+        {
+            stats->m_Released.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /*
+     * @brief Copies the counters of every handle type seen so far
+     *
+     * @param Also collect the events still held in the per-thread buffers (HANDLE_TRACK_CALL_SITES)
+     */
+    [[nodiscard]] static HandleCensus Snapshot(bool includeEvents = false)
+    {
+        HandleCensus census{ std::chrono::steady_clock::now(), {}, {} };
+
+        for (auto* stats = TagList().load(std::memory_order_acquire); stats; stats = stats->m_Next)
+        {
+            auto const opened   = stats->m_Opened.load(std::memory_order_relaxed);
+            auto const closed   = stats->m_Closed.load(std::memory_order_relaxed);
+            auto const released = stats->m_Released.load(std::memory_order_relaxed);
+
+            census.m_Tags.push_back({ stats->m_Name,
+                                      opened >= closed + released ? opened - closed - released : 0,
+                                      stats->m_Peak.load(std::memory_order_relaxed),
+                                      opened,
+                                      closed,
+                                      released });
+        }
+
+        if (includeEvents)
+        {
+            for (auto* buffer = BufferList().load(std::memory_order_acquire); buffer; buffer = buffer->m_Next)
+            {
+                buffer->Collect(census.m_Events);
+            }
+        }
+
+        return census;
+    }
+};
+
+#if defined(HANDLE_ENABLE_TRACKING)
+/*
+ * @brief Tracking state embedded in Handle<_Ty> when HANDLE_ENABLE_TRACKING is defined
+ *
+ * Remembers whether the current value was counted as open, so handles that came in through
+ * `operator&` are not counted as closed either.
+ */
+template<typename _Ty>
+class HandleTracking
+{
+private:
+    bool m_Tracked = false;
+
+public:
+    HandleTracking() noexcept = default;
+
+    HandleTracking(HandleTracking&& other) noexcept
+        : m_Tracked(std::exchange(other.m_Tracked, false))
+    {}
+
+    HandleTracking& operator=(HandleTracking&& other) noexcept
+    {
+        m_Tracked = std::exchange(other.m_Tracked, false);
+        return *this;
+    }
+
+protected:
+    void TrackOpen(std::intptr_t handle, HandleCallSite site) noexcept
+    {
+        m_Tracked = true;
+        HandleTracker::OnOpen<_Ty>(handle, site);
+    }
+
+    void TrackClose(std::intptr_t handle) noexcept
+    {
+        if (std::exchange(m_Tracked, false))
+        {
+            HandleTracker::OnClose<_Ty>(handle);
+        }
+    }
+
+    void TrackRelease(std::intptr_t handle) noexcept
+    {
+        if (std::exchange(m_Tracked, false))
+        {
+            HandleTracker::OnRelease<_Ty>(handle);
+        }
+    }
+};
+#else
+template<typename _Ty>
+class HandleTracking
+{
+protected:
+    constexpr void TrackOpen(std::intptr_t, HandleCallSite) noexcept {}
+    constexpr void TrackClose(std::intptr_t) noexcept {}
+    constexpr void TrackRelease(std::intptr_t) noexcept {}
+};
+#endif
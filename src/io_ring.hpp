@@ -0,0 +1,248 @@
+#pragma once
+#include "handle.hpp"
+
+#if !defined(_WIN32)
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/*
+ * @brief Minimal io_uring instance driven through the raw system calls
+ *
+ * Owns the ring descriptor (an IoCompletionPortHandle, the closest tag) and the three shared
+ * mappings. Submission entries are handed out with `GetSqe()` and published in bulk by
+ * `Submit()`; completions are drained in place with `DrainCompletions()`. Not thread-safe,
+ * every ring belongs to one thread at a time.
+ */
+class IoRing
+{
+private:
+    IoCompletionPortHandle m_Ring;
+
+    void*         m_SqMap     = MAP_FAILED;
+    std::size_t   m_SqMapSize = 0;
+    void*         m_CqMap     = MAP_FAILED;
+    std::size_t   m_CqMapSize = 0;
+    io_uring_sqe* m_Sqes      = nullptr;
+    std::size_t   m_SqesSize  = 0;
+
+    unsigned*      m_SqHead    = nullptr;
+    unsigned*      m_SqTail    = nullptr;
+    unsigned*      m_SqArray   = nullptr;
+    unsigned       m_SqMask    = 0;
+    unsigned       m_SqEntries = 0;
+    unsigned       m_SqPending = 0;
+
+    unsigned*      m_CqHead = nullptr;
+    unsigned*      m_CqTail = nullptr;
+    unsigned       m_CqMask = 0;
+    io_uring_cqe*  m_Cqes   = nullptr;
+
+    template<typename _Ty>
+    static _Ty* At(void* base, std::uint32_t offset) noexcept
+    {
+        return reinterpret_cast<_Ty*>(static_cast<std::byte*>(base) + offset);
+    }
+
+public:
+    /*
+     * @param Submission queue size, rounded up to a power of two by the kernel
+     */
+    explicit IoRing(unsigned entries) noexcept
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        m_Ring = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (!m_Ring.Valid())
+        {
+            return;
+        }
+
+        m_SqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_CqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        bool const singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+        {
+            m_SqMapSize = m_CqMapSize = m_SqMapSize > m_CqMapSize ? m_SqMapSize : m_CqMapSize;
+        }
+
+        m_SqMap = ::mmap(nullptr, m_SqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Ring, IORING_OFF_SQ_RING);
+        m_CqMap = singleMap
+            ? m_SqMap
+            : ::mmap(nullptr, m_CqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Ring, IORING_OFF_CQ_RING);
+
+        m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Ring, IORING_OFF_SQES);
+
+        if (m_SqMap == MAP_FAILED || m_CqMap == MAP_FAILED || sqes == MAP_FAILED)
+        {
+            if (sqes != MAP_FAILED)
+            {
+                ::munmap(sqes, m_SqesSize);
+            }
+
+            Unmap();
+            m_Ring.Close();
+            return;
+        }
+
+        m_Sqes      = static_cast<io_uring_sqe*>(sqes);
+        m_SqHead    = At<unsigned>(m_SqMap, params.sq_off.head);
+        m_SqTail    = At<unsigned>(m_SqMap, params.sq_off.tail);
+        m_SqArray   = At<unsigned>(m_SqMap, params.sq_off.array);
+        m_SqMask    = *At<unsigned>(m_SqMap, params.sq_off.ring_mask);
+        m_SqEntries = *At<unsigned>(m_SqMap, params.sq_off.ring_entries);
+
+        m_CqHead = At<unsigned>(m_CqMap, params.cq_off.head);
+        m_CqTail = At<unsigned>(m_CqMap, params.cq_off.tail);
+        m_CqMask = *At<unsigned>(m_CqMap, params.cq_off.ring_mask);
+        m_Cqes   = At<io_uring_cqe>(m_CqMap, params.cq_off.cqes);
+    }
+
+    IoRing(IoRing const&) = delete;
+    IoRing& operator=(IoRing const&) = delete;
+
+    ~IoRing()
+    {
+        if (m_Sqes)
+        {
+            ::munmap(m_Sqes, m_SqesSize);
+        }
+
+        Unmap();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Ring.Valid();
+    }
+
+    [[nodiscard]] int Get() const noexcept
+    {
+        return m_Ring.Get();
+    }
+
+    [[nodiscard]] unsigned Entries() const noexcept
+    {
+        return m_SqEntries;
+    }
+
+    /*
+     * @brief Next zeroed submission entry, nullptr while the submission queue is full
+     */
+    [[nodiscard]] io_uring_sqe* GetSqe() noexcept
+    {
+        auto const tail = *m_SqTail + m_SqPending;
+        if (tail - std::atomic_ref(*m_SqHead).load(std::memory_order_acquire) >= m_SqEntries)
+        {
+            return nullptr;
+        }
+
+        auto const index = tail & m_SqMask;
+        m_SqArray[index] = index;
+        ++m_SqPending;
+
+        auto* sqe = &m_Sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    /*
+     * @brief Publishes every entry obtained since the last call and optionally waits for completions
+     *
+     * @param Minimum number of completions to wait for
+     * @return Number of entries consumed by the kernel, or -errno
+     */
+    int Submit(unsigned waitFor = 0) noexcept
+    {
+        auto const tail = *m_SqTail + std::exchange(m_SqPending, 0);
+        std::atomic_ref(*m_SqTail).store(tail, std::memory_order_release);
+
+        auto const toSubmit = tail - std::atomic_ref(*m_SqHead).load(std::memory_order_acquire);
+        if (toSubmit == 0 && waitFor == 0)
+        {
+            return 0;
+        }
+
+        for (;;)
+        {
+            auto const result = ::syscall(__NR_io_uring_enter, m_Ring.Get(), toSubmit, waitFor,
+                                          waitFor ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (result >= 0)
+            {
+                return static_cast<int>(result);
+            }
+
+            if (errno != EINTR)
+            {
+                return -errno;
+            }
+        }
+    }
+
+    /*
+     * @brief Takes back every entry the kernel has not consumed, after Submit() failed or stopped short
+     *
+     * Sound because the ring has no SQPOLL thread, the kernel only reads the submission queue
+     * inside io_uring_enter.
+     *
+     * @return Number of entries withdrawn, the most recently obtained ones
+     */
+    unsigned Withdraw() noexcept
+    {
+        auto const head = std::atomic_ref(*m_SqHead).load(std::memory_order_acquire);
+        auto const tail = *m_SqTail + std::exchange(m_SqPending, 0);
+        std::atomic_ref(*m_SqTail).store(head, std::memory_order_release);
+        return tail - head;
+    }
+
+    /*
+     * @brief Hands available completions to `callback(io_uring_cqe const&)` and retires them
+     *
+     * @param Completion handler
+     * @param Maximum number of completions to drain, the rest stay queued
+     * @return Number of completions drained
+     */
+    template<typename _Callback>
+    unsigned DrainCompletions(_Callback&& callback, unsigned limit = ~0u) noexcept(noexcept(callback(std::declval<io_uring_cqe const&>())))
+    {
+        auto head = *m_CqHead;
+        auto const tail = std::atomic_ref(*m_CqTail).load(std::memory_order_acquire);
+
+        unsigned drained = 0;
+        for (; head != tail && drained < limit; ++head, ++drained)
+        {
+            callback(m_Cqes[head & m_CqMask]);
+        }
+
+        std::atomic_ref(*m_CqHead).store(head, std::memory_order_release);
+        return drained;
+    }
+
+private:
+    void Unmap() noexcept
+    {
+        if (m_CqMap != MAP_FAILED && m_CqMap != m_SqMap)
+        {
+            ::munmap(m_CqMap, m_CqMapSize);
+        }
+
+        if (m_SqMap != MAP_FAILED)
+        {
+            ::munmap(m_SqMap, m_SqMapSize);
+        }
+
+        m_SqMap = m_CqMap = MAP_FAILED;
+    }
+};
+#endif
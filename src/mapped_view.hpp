@@ -0,0 +1,423 @@
+#pragma once
+#include "handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * @brief Page protection of a MappedView
+ */
+enum class MapAccess
+{
+    Read,
+    ReadWrite,
+    // Private copy-on-write pages, writes never reach the mapping
+    Copy,
+};
+
+/*
+ * @brief Access pattern hints for MappedView::Advise
+ */
+enum class MapAdvice
+{
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+    DontNeed,
+};
+
+/*
+ * @brief Alignment the offset of a view must have, SYSTEM_INFO::dwAllocationGranularity or the page size
+ */
+[[nodiscard]] inline std::size_t MapAllocationGranularity() noexcept
+{
+    static std::size_t const granularity = []
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwAllocationGranularity);
+#else
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    }();
+
+    return granularity;
+}
+
+/*
+ * @brief Owns one view of a FileMappingHandle (MapViewOfFile / mmap)
+ *
+ * Any offset can be requested, the view starts at the allocation granularity boundary below
+ * it and `Bytes()` covers exactly the requested window. Writes go through `WritableBytes()`,
+ * which is empty for read-only views. The view keeps the underlying section alive on its
+ * own, the FileMappingHandle may be closed once the view exists.
+ */
+class MappedView
+{
+private:
+    std::byte*  m_Base       = nullptr;
+    std::size_t m_MappedSize = 0;
+    std::byte*  m_Data       = nullptr;
+    std::size_t m_Size       = 0;
+    MapAccess   m_Access     = MapAccess::Read;
+
+public:
+    MappedView() noexcept = default;
+
+    /*
+     * @param Mapping to view (on Linux any mappable descriptor, e.g. a memfd or a regular file)
+     * @param Offset of the first byte, no alignment required
+     * @param Number of bytes, must not be 0
+     * @param Page protection, must be compatible with how the mapping was created
+     */
+    MappedView(FileMappingHandle const& mapping, std::uint64_t offset, std::size_t length, MapAccess access = MapAccess::Read) noexcept
+    {
+        if (!mapping.Valid() || length == 0)
+        {
+            return;
+        }
+
+        auto const aligned = offset - offset % MapAllocationGranularity();
+        auto const delta   = static_cast<std::size_t>(offset - aligned);
+        auto const size    = delta + length;
+
+#if defined(_WIN32)
+        DWORD const desired = access == MapAccess::Read  ? FILE_MAP_READ
+                            : access == MapAccess::Copy  ? FILE_MAP_COPY
+                                                         : FILE_MAP_READ | FILE_MAP_WRITE;
+
+        void* base = ::MapViewOfFile(mapping, desired, static_cast<DWORD>(aligned >> 32), static_cast<DWORD>(aligned), size);
+        if (!base)
+        {
+            return;
+        }
+#else
+        int const protection = access == MapAccess::Read ? PROT_READ : PROT_READ | PROT_WRITE;
+        int const flags      = access == MapAccess::Copy ? MAP_PRIVATE : MAP_SHARED;
+
+        void* base = ::mmap(nullptr, size, protection, flags, mapping, static_cast<off_t>(aligned));
+        if (base == MAP_FAILED)
+        {
+            return;
+        }
+#endif
+
+        m_Base       = static_cast<std::byte*>(base);
+        m_MappedSize = size;
+        m_Data       = m_Base + delta;
+        m_Size       = length;
+        m_Access     = access;
+    }
+
+    MappedView(MappedView const&) = delete;
+    MappedView& operator=(MappedView const&) = delete;
+
+    MappedView(MappedView&& other) noexcept
+        : m_Base(std::exchange(other.m_Base, nullptr))
+        , m_MappedSize(std::exchange(other.m_MappedSize, 0))
+        , m_Data(std::exchange(other.m_Data, nullptr))
+        , m_Size(std::exchange(other.m_Size, 0))
+        , m_Access(std::exchange(other.m_Access, MapAccess::Read))
+    {
+    }
+
+    MappedView& operator=(MappedView&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_Base       = std::exchange(other.m_Base, nullptr);
+            m_MappedSize = std::exchange(other.m_MappedSize, 0);
+            m_Data       = std::exchange(other.m_Data, nullptr);
+            m_Size       = std::exchange(other.m_Size, 0);
+            m_Access     = std::exchange(other.m_Access, MapAccess::Read);
+        }
+
+        return *this;
+    }
+
+    ~MappedView()
+    {
+        Reset();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Base != nullptr;
+    }
+
+    [[nodiscard]] std::byte const* Data() const noexcept
+    {
+        return m_Data;
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    [[nodiscard]] MapAccess Access() const noexcept
+    {
+        return m_Access;
+    }
+
+    [[nodiscard]] std::span<std::byte const> Bytes() const noexcept
+    {
+        return { m_Data, m_Size };
+    }
+
+    /*
+     * @brief Start of the window, nullptr for MapAccess::Read views
+     */
+    [[nodiscard]] std::byte* WritableData() noexcept
+    {
+        return m_Access != MapAccess::Read ? m_Data : nullptr;
+    }
+
+    /*
+     * @brief The window for writing, empty for MapAccess::Read views
+     */
+    [[nodiscard]] std::span<std::byte> WritableBytes() noexcept
+    {
+        if (m_Access == MapAccess::Read)
+        {
+            return {};
+        }
+
+        return { m_Data, m_Size };
+    }
+
+    /*
+     * @brief Unmaps the view, a no-op for invalid views
+     */
+    void Reset() noexcept
+    {
+        if (!m_Base)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        ::UnmapViewOfFile(m_Base);
+#else
+        ::munmap(m_Base, m_MappedSize);
+#endif
+
+        m_Base = m_Data = nullptr;
+        m_MappedSize = m_Size = 0;
+        m_Access = MapAccess::Read;
+    }
+
+    /*
+     * @brief Passes an access pattern hint for [offset, offset + length) of the window
+     *
+     * Windows only implements WillNeed (PrefetchVirtualMemory) and DontNeed (dropping the
+     * pages from the working set), the other hints return false there.
+     *
+     * @param Hint
+     * @param Offset into the window
+     * @param Number of bytes, 0 means up to the end of the window
+     */
+    bool Advise(MapAdvice advice, std::size_t offset = 0, std::size_t length = 0) const noexcept
+    {
+        auto const range = Range(offset, length);
+        if (range.second == 0)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        switch (advice)
+        {
+        case MapAdvice::WillNeed:
+        {
+            WIN32_MEMORY_RANGE_ENTRY entry{ range.first, range.second };
+            return ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &entry, 0);
+        }
+        case MapAdvice::DontNeed:
+            // Unlocking pages that are not locked removes them from the working set
+            ::VirtualUnlock(range.first, range.second);
+            return true;
+        default:
+            return false;
+        }
+#else
+        int const native = advice == MapAdvice::Sequential ? MADV_SEQUENTIAL
+                         : advice == MapAdvice::Random     ? MADV_RANDOM
+                         : advice == MapAdvice::WillNeed   ? MADV_WILLNEED
+                         : advice == MapAdvice::DontNeed   ? MADV_DONTNEED
+                                                           : MADV_NORMAL;
+
+        return ::madvise(range.first, range.second, native) == 0;
+#endif
+    }
+
+    /*
+     * @brief Shorthand for Advise(MapAdvice::WillNeed, ...)
+     */
+    bool Prefetch(std::size_t offset = 0, std::size_t length = 0) const noexcept
+    {
+        return Advise(MapAdvice::WillNeed, offset, length);
+    }
+
+    /*
+     * @brief Writes dirty pages of [offset, offset + length) back to the mapping and waits for it
+     *
+     * On Windows this covers the view only, call FlushFileBuffers on the file for durability.
+     *
+     * @param Offset into the window
+     * @param Number of bytes, 0 means up to the end of the window
+     */
+    bool Flush(std::size_t offset = 0, std::size_t length = 0) const noexcept
+    {
+        auto const range = Range(offset, length);
+        if (range.second == 0)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        return ::FlushViewOfFile(range.first, range.second);
+#else
+        return ::msync(range.first, range.second, MS_SYNC) == 0;
+#endif
+    }
+
+private:
+    /*
+     * @brief Page aligned address range covering [offset, offset + length) of the window
+     */
+    [[nodiscard]] std::pair<void*, std::size_t> Range(std::size_t offset, std::size_t length) const noexcept
+    {
+        if (!m_Base || offset >= m_Size)
+        {
+            return { nullptr, 0 };
+        }
+
+        if (length == 0 || length > m_Size - offset)
+        {
+            length = m_Size - offset;
+        }
+
+        // m_Base is granularity aligned, which implies page alignment
+#if defined(_WIN32)
+        static std::size_t const page = []
+        {
+            SYSTEM_INFO info;
+            ::GetSystemInfo(&info);
+            return static_cast<std::size_t>(info.dwPageSize);
+        }();
+#else
+        auto const page = MapAllocationGranularity();
+#endif
+
+        auto const first = static_cast<std::size_t>(m_Data - m_Base) + offset;
+        auto const start = first - first % page;
+
+        return { m_Base + start, first + length - start };
+    }
+};
+
+/*
+ * @brief Read-only view of a whole file
+ *
+ * Opens the file, maps it and drops the file and mapping handles again, only the view is
+ * kept. Empty files are valid and yield an empty span.
+ */
+class MappedFile
+{
+private:
+    MappedView    m_View;
+    std::uint64_t m_Size  = 0;
+    bool          m_Valid = false;
+
+public:
+    MappedFile() noexcept = default;
+
+    explicit MappedFile(std::filesystem::path const& path) noexcept
+    {
+#if defined(_WIN32)
+        FileHandle file(::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+
+        LARGE_INTEGER size;
+        if (!file.Valid() || !::GetFileSizeEx(file, &size))
+        {
+            return;
+        }
+
+        m_Size = static_cast<std::uint64_t>(size.QuadPart);
+        if (m_Size == 0)
+        {
+            m_Valid = true;
+            return;
+        }
+
+        FileMappingHandle mapping(::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr));
+#else
+        FileHandle file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+
+        struct stat status;
+        if (!file.Valid() || ::fstat(file, &status) != 0)
+        {
+            return;
+        }
+
+        m_Size = static_cast<std::uint64_t>(status.st_size);
+        if (m_Size == 0)
+        {
+            m_Valid = true;
+            return;
+        }
+
+        // mmap takes any descriptor, the mapping simply borrows the file's
+        FileMappingHandle mapping(file.Release());
+#endif
+
+        m_View  = MappedView(mapping, 0, static_cast<std::size_t>(m_Size));
+        m_Valid = m_View.Valid();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Valid;
+    }
+
+    [[nodiscard]] std::uint64_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    [[nodiscard]] std::span<std::byte const> Bytes() const noexcept
+    {
+        return m_View.Bytes();
+    }
+
+    [[nodiscard]] MappedView const& View() const noexcept
+    {
+        return m_View;
+    }
+
+    bool Advise(MapAdvice advice, std::size_t offset = 0, std::size_t length = 0) const noexcept
+    {
+        return m_View.Advise(advice, offset, length);
+    }
+
+    bool Prefetch(std::size_t offset = 0, std::size_t length = 0) const noexcept
+    {
+        return m_View.Prefetch(offset, length);
+    }
+};
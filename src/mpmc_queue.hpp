@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+ * @brief Bounded lock-free multi-producer multi-consumer ring (Vyukov's bounded queue)
+ *
+ * Every cell carries a sequence number telling whether it is free for the producer of its
+ * position or filled for the consumer, so neither side takes a lock and a full or empty ring
+ * is detected without reading the other side's index. A single consumer is just as fine.
+ *
+ * @tparam Element type, default constructible and move assignable
+ */
+template<typename _Ty>
+class BoundedMpmcQueue
+{
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> m_Sequence;
+        _Ty                      m_Value;
+    };
+
+    std::unique_ptr<Cell[]> m_Cells;
+    std::size_t             m_Mask;
+
+    alignas(64) std::atomic<std::size_t> m_EnqueuePosition = 0;
+    alignas(64) std::atomic<std::size_t> m_DequeuePosition = 0;
+
+public:
+    /*
+     * @param Number of elements, rounded up to a power of two, at least 2
+     */
+    explicit BoundedMpmcQueue(std::size_t capacity)
+        : m_Cells(std::make_unique<Cell[]>(std::bit_ceil(capacity < 2 ? 2 : capacity)))
+        , m_Mask(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1)
+    {
+        for (std::size_t i = 0; i <= m_Mask; ++i)
+        {
+            m_Cells[i].m_Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpmcQueue(BoundedMpmcQueue const&) = delete;
+    BoundedMpmcQueue& operator=(BoundedMpmcQueue const&) = delete;
+
+public:
+    /*
+     * @brief Appends `value`, fails when the ring is full
+     */
+    [[nodiscard]] bool TryPush(_Ty value) noexcept
+    {
+        auto position = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& cell     = m_Cells[position & m_Mask];
+            auto sequence  = cell.m_Sequence.load(std::memory_order_acquire);
+            auto const gap = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (gap == 0)
+            {
+                if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.m_Value = std::move(value);
+                    cell.m_Sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (gap < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_EnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * @brief Takes the oldest element into `value`, fails when the ring is empty
+     */
+    [[nodiscard]] bool TryPop(_Ty& value) noexcept
+    {
+        auto position = m_DequeuePosition.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& cell     = m_Cells[position & m_Mask];
+            auto sequence  = cell.m_Sequence.load(std::memory_order_acquire);
+            auto const gap = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+            if (gap == 0)
+            {
+                if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(cell.m_Value);
+                    cell.m_Sequence.store(position + m_Mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (gap < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_DequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * @brief Whether the oldest element is not yet published, a consumer-side emptiness check
+     */
+    [[nodiscard]] bool Empty() const noexcept
+    {
+        auto const position = m_DequeuePosition.load(std::memory_order_relaxed);
+        return m_Cells[position & m_Mask].m_Sequence.load(std::memory_order_acquire) != position + 1;
+    }
+
+    /*
+     * @brief Elements pushed so far, counting ones whose push is still finishing
+     */
+    [[nodiscard]] std::size_t Pushed() const noexcept
+    {
+        return m_EnqueuePosition.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::size_t Capacity() const noexcept
+    {
+        return m_Mask + 1;
+    }
+};
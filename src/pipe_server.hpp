@@ -0,0 +1,613 @@
+#pragma once
+#include "completion_engine.hpp"
+#include "coroutine_io.hpp"
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*
+ * @brief Connects to the PipeServer listening at `name`, waiting while all its instances are busy
+ *
+ * `name` is `\\.\pipe\...` on Windows and a socket path on Linux. The returned end is blocking
+ * and message based, use PipeSend() / PipeReceive() or associate it with an engine.
+ */
+[[nodiscard]] inline NamedPipeHandle PipeConnect(std::filesystem::path const& name) noexcept
+{
+#if defined(_WIN32)
+    for (;;)
+    {
+        NamedPipeHandle pipe(::CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr));
+        if (pipe.Valid())
+        {
+            DWORD mode = PIPE_READMODE_MESSAGE;
+            return ::SetNamedPipeHandleState(pipe.Get(), &mode, nullptr, nullptr) ? std::move(pipe) : NamedPipeHandle();
+        }
+
+        if (::GetLastError() != ERROR_PIPE_BUSY || !::WaitNamedPipeW(name.c_str(), NMPWAIT_WAIT_FOREVER))
+        {
+            return {};
+        }
+    }
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (name.native().size() >= sizeof(address.sun_path))
+    {
+        return {};
+    }
+
+    std::memcpy(address.sun_path, name.c_str(), name.native().size());
+
+    NamedPipeHandle pipe(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+    if (!pipe.Valid() || ::connect(pipe.Get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        return {};
+    }
+
+    return pipe;
+#endif
+}
+
+/*
+ * @brief Sends one message on a blocking pipe end
+ *
+ * @return Bytes sent, or -error
+ */
+[[nodiscard]] inline std::int64_t PipeSend(NamedPipeHandle const& pipe, std::span<std::byte const> message) noexcept
+{
+#if defined(_WIN32)
+    DWORD written = 0;
+    return ::WriteFile(pipe.Get(), message.data(), static_cast<DWORD>(message.size()), &written, nullptr)
+        ? static_cast<std::int64_t>(written)
+        : -static_cast<std::int64_t>(::GetLastError());
+#else
+    auto const sent = ::send(pipe.Get(), message.data(), message.size(), MSG_NOSIGNAL);
+    return sent >= 0 ? sent : -errno;
+#endif
+}
+
+/*
+ * @brief Receives one message on a blocking pipe end
+ *
+ * @return Message size, 0 once the peer disconnected, or -error
+ */
+[[nodiscard]] inline std::int64_t PipeReceive(NamedPipeHandle const& pipe, std::span<std::byte> buffer) noexcept
+{
+#if defined(_WIN32)
+    DWORD read = 0;
+    if (::ReadFile(pipe.Get(), buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr))
+    {
+        return read;
+    }
+
+    auto const error = ::GetLastError();
+    return error == ERROR_BROKEN_PIPE ? 0 : -static_cast<std::int64_t>(error);
+#else
+    auto const received = ::recv(pipe.Get(), buffer.data(), buffer.size(), 0);
+    return received >= 0 ? received : -errno;
+#endif
+}
+
+class PipeServer;
+
+/*
+ * @brief Server end of an accepted client, with a receive buffer lent by its PipeServer
+ *
+ * Messages are framed by the transport, a message-mode pipe on Windows and a SOCK_SEQPACKET
+ * socket on Linux, so every Receive() yields exactly one message the client sent. Messages
+ * must be non-empty and at most PipeServer::MaxMessageSize() bytes: longer ones fail on
+ * Windows and are truncated on Linux.
+ */
+class PipeConnection
+{
+private:
+    using ReadAwaitable = decltype(ReadAsync(std::declval<CompletionEngine&>(), std::declval<NamedPipeHandle const&>(), std::span<std::byte>()));
+
+    PipeServer*                  m_Server = nullptr;
+    NamedPipeHandle              m_Pipe;
+    std::unique_ptr<std::byte[]> m_Buffer;
+
+public:
+    /*
+     * @brief Yields the received message as a view of the connection's buffer, valid until the
+     *        next Receive(), or an empty span once the client disconnected or on error
+     */
+    class ReceiveAwaitable
+    {
+    private:
+        ReadAwaitable    m_Read;
+        std::byte const* m_Buffer;
+
+    public:
+        ReceiveAwaitable(ReadAwaitable read, std::byte const* buffer) noexcept
+            : m_Read(std::move(read))
+            , m_Buffer(buffer)
+        {}
+
+        [[nodiscard]] bool await_ready() const noexcept
+        {
+            return m_Read.await_ready();
+        }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) noexcept
+        {
+            return m_Read.await_suspend(coroutine);
+        }
+
+        [[nodiscard]] std::span<std::byte const> await_resume() noexcept
+        {
+            auto const result = m_Read.await_resume();
+            return result > 0 ? std::span(m_Buffer, static_cast<std::size_t>(result)) : std::span<std::byte const>();
+        }
+    };
+
+    PipeConnection() noexcept = default;
+
+    PipeConnection(PipeServer& server, NamedPipeHandle pipe) noexcept;
+
+    PipeConnection(PipeConnection&& other) noexcept
+        : m_Server(std::exchange(other.m_Server, nullptr))
+        , m_Pipe(std::move(other.m_Pipe))
+        , m_Buffer(std::move(other.m_Buffer))
+    {}
+
+    PipeConnection& operator=(PipeConnection&& other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+            Close();
+            m_Server = std::exchange(other.m_Server, nullptr);
+            m_Pipe   = std::move(other.m_Pipe);
+            m_Buffer = std::move(other.m_Buffer);
+        }
+
+        return *this;
+    }
+
+    PipeConnection(PipeConnection const&) = delete;
+    PipeConnection& operator=(PipeConnection const&) = delete;
+
+    ~PipeConnection()
+    {
+        Close();
+    }
+
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Pipe.Valid() && m_Buffer;
+    }
+
+    [[nodiscard]] NamedPipeHandle const& Pipe() const noexcept
+    {
+        return m_Pipe;
+    }
+
+    /*
+     * @brief Receives the next message, the connection must be Valid()
+     */
+    [[nodiscard]] ReceiveAwaitable Receive() noexcept;
+
+    /*
+     * @brief Sends one message on a Valid() connection, `co_await` yields the bytes sent or -error
+     */
+    [[nodiscard]] auto Send(std::span<std::byte const> message) noexcept;
+
+    /*
+     * @brief Disconnects the client and hands the buffer back to the server
+     */
+    void Close() noexcept;
+};
+
+/*
+ * @brief Message server keeping `instances` accepts pending so a connecting client never waits for one
+ *
+ * Windows: `instances` overlapped message-mode pipe instances wait in ConnectNamedPipe on the
+ * engine's completion port, and each one that connects is replaced by a fresh instance from
+ * the completion, before the client is handed out. Linux: a SOCK_SEQPACKET Unix-domain
+ * listener with `instances` accepts parked on the engine.
+ *
+ * Connections are taken with `co_await server.Accept()`. Their receive buffers are recycled
+ * through the server, so steady connect/disconnect churn allocates nothing. The engine must keep
+ * running until the server is destroyed, and the server must outlive its connections.
+ */
+class PipeServer
+{
+    friend class PipeConnection;
+
+public:
+    static constexpr std::size_t DefaultInstances      = 16;
+    static constexpr std::size_t DefaultMaxMessageSize = 4096;
+
+    class AcceptAwaitable;
+
+private:
+    struct Instance
+    {
+        PipeServer*     m_Server;
+#if defined(_WIN32)
+        NamedPipeHandle m_Pipe;
+#endif
+    };
+
+    CompletionEngine&                         m_Engine;
+    std::filesystem::path                     m_Name;
+    std::size_t                               m_MaxMessageSize;
+    std::unique_ptr<Instance[]>               m_Instances;
+    std::size_t                               m_InstanceCount = 0;
+    bool                                      m_Listening = false;
+#if !defined(_WIN32)
+    SocketHandle                              m_Listener;
+#endif
+
+    std::mutex                                m_Lock;
+    std::condition_variable                   m_Idle;
+    std::size_t                               m_Pending = 0;
+    bool                                      m_Stopping = false;
+    std::deque<NamedPipeHandle>               m_Connected;
+    AcceptAwaitable*                          m_WaitersHead = nullptr;
+    AcceptAwaitable*                          m_WaitersTail = nullptr;
+    std::vector<std::unique_ptr<std::byte[]>> m_Buffers;
+
+public:
+    /*
+     * @brief Awaits the next client, yields an invalid PipeConnection once the server stops
+     */
+    class AcceptAwaitable
+    {
+        friend class PipeServer;
+
+    private:
+        PipeServer&             m_Server;
+        std::coroutine_handle<> m_Coroutine;
+        NamedPipeHandle         m_Pipe;
+        AcceptAwaitable*        m_Next = nullptr;
+
+    public:
+        explicit AcceptAwaitable(PipeServer& server) noexcept
+            : m_Server(server)
+        {}
+
+        [[nodiscard]] bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) noexcept
+        {
+            std::lock_guard lock(m_Server.m_Lock);
+            if (!m_Server.m_Connected.empty())
+            {
+                m_Pipe = std::move(m_Server.m_Connected.front());
+                m_Server.m_Connected.pop_front();
+                return false;
+            }
+
+            if (m_Server.m_Stopping)
+            {
+                return false;
+            }
+
+            m_Coroutine = coroutine;
+            (m_Server.m_WaitersTail ? m_Server.m_WaitersTail->m_Next : m_Server.m_WaitersHead) = this;
+            m_Server.m_WaitersTail = this;
+            return true;
+        }
+
+        [[nodiscard]] PipeConnection await_resume() noexcept
+        {
+            return m_Pipe.Valid() ? PipeConnection(m_Server, std::move(m_Pipe)) : PipeConnection();
+        }
+    };
+
+    /*
+     * @param name `\\.\pipe\...` on Windows, a socket path on Linux (replaced if it exists)
+     */
+    PipeServer(CompletionEngine& engine, std::filesystem::path name, std::size_t instances = DefaultInstances,
+               std::size_t maxMessageSize = DefaultMaxMessageSize)
+        : m_Engine(engine)
+        , m_Name(std::move(name))
+        , m_MaxMessageSize(maxMessageSize)
+        , m_Instances(new (std::nothrow) Instance[instances]{})
+    {
+        if (!m_Instances || instances == 0)
+        {
+            return;
+        }
+
+#if !defined(_WIN32)
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (m_Name.native().size() >= sizeof(address.sun_path))
+        {
+            return;
+        }
+
+        std::memcpy(address.sun_path, m_Name.c_str(), m_Name.native().size());
+        ::unlink(m_Name.c_str());
+
+        SocketHandle listener(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+        if (!listener.Valid()
+            || ::bind(listener.Get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listener.Get(), SOMAXCONN) != 0
+            || !m_Engine.Associate(listener))
+        {
+            return;
+        }
+
+        m_Listener = std::move(listener);
+#endif
+
+        std::lock_guard lock(m_Lock);
+        for (; m_InstanceCount < instances; ++m_InstanceCount)
+        {
+            m_Instances[m_InstanceCount].m_Server = this;
+            if (!Arm(m_Instances[m_InstanceCount]))
+            {
+                return;
+            }
+        }
+
+        m_Listening = true;
+    }
+
+    PipeServer(PipeServer const&) = delete;
+    PipeServer& operator=(PipeServer const&) = delete;
+
+    /*
+     * @brief Cancels the pending instances, waits for their completions and resumes waiting Accept()s
+     */
+    ~PipeServer()
+    {
+        AcceptAwaitable* waiters;
+        {
+            std::lock_guard lock(m_Lock);
+            m_Stopping = true;
+            waiters    = std::exchange(m_WaitersHead, nullptr);
+            m_WaitersTail = nullptr;
+
+#if defined(_WIN32)
+            for (std::size_t i = 0; i < m_InstanceCount; ++i)
+            {
+                ::CancelIoEx(m_Instances[i].m_Pipe.Get(), nullptr);
+            }
+#endif
+        }
+
+#if !defined(_WIN32)
+        if (m_Listener.Valid())
+        {
+            // Completes the parked accepts with -ECANCELED
+            m_Engine.Disassociate(m_Listener);
+        }
+#endif
+
+        {
+            std::unique_lock lock(m_Lock);
+            m_Idle.wait(lock, [this] { return m_Pending == 0; });
+        }
+
+        while (waiters)
+        {
+            std::exchange(waiters, waiters->m_Next)->m_Coroutine.resume();
+        }
+
+#if !defined(_WIN32)
+        if (m_Listener.Valid())
+        {
+            m_Listener.Close();
+            ::unlink(m_Name.c_str());
+        }
+#endif
+    }
+
+    /*
+     * @brief True when every instance started listening
+     */
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Listening;
+    }
+
+    [[nodiscard]] std::size_t MaxMessageSize() const noexcept
+    {
+        return m_MaxMessageSize;
+    }
+
+    [[nodiscard]] CompletionEngine& Engine() const noexcept
+    {
+        return m_Engine;
+    }
+
+    [[nodiscard]] AcceptAwaitable Accept() noexcept
+    {
+        return AcceptAwaitable(*this);
+    }
+
+private:
+    /*
+     * @brief Starts the wait for the next client on `instance`, with m_Lock held
+     */
+    bool Arm(Instance& instance) noexcept
+    {
+#if defined(_WIN32)
+        auto const size = static_cast<DWORD>(m_MaxMessageSize);
+
+        // A client may connect and leave before ConnectNamedPipe ran, which breaks that instance only
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            instance.m_Pipe.Reset(::CreateNamedPipeW(m_Name.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+                                                     PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                                     PIPE_UNLIMITED_INSTANCES, size, size, 0, nullptr));
+            if (!instance.m_Pipe.Valid() || !m_Engine.Associate(instance.m_Pipe))
+            {
+                instance.m_Pipe.Close();
+                return false;
+            }
+
+            if (m_Engine.Connect(instance.m_Pipe, &OnConnected, std::addressof(instance)))
+            {
+                ++m_Pending;
+                return true;
+            }
+        }
+
+        instance.m_Pipe.Close();
+        return false;
+#else
+        if (!m_Engine.Accept(m_Listener, {}, &OnConnected, std::addressof(instance)))
+        {
+            return false;
+        }
+
+        ++m_Pending;
+        return true;
+#endif
+    }
+
+    static void OnConnected(IoOperation& operation, std::int64_t result) noexcept
+    {
+        auto& instance = *static_cast<Instance*>(operation.m_Context);
+        auto& server   = *instance.m_Server;
+
+        NamedPipeHandle pipe;
+        AcceptAwaitable* waiter = nullptr;
+        {
+            std::lock_guard lock(server.m_Lock);
+
+#if defined(_WIN32)
+            pipe = std::move(instance.m_Pipe);
+            if (result < 0)
+            {
+                pipe.Close();
+            }
+#else
+            if (result >= 0)
+            {
+                pipe.Reset(static_cast<int>(result));
+            }
+#endif
+
+            if (!server.m_Stopping)
+            {
+                // Replace the instance before handing out the client
+                server.Arm(instance);
+
+                if (pipe.Valid())
+                {
+                    waiter = server.m_WaitersHead;
+                    if (waiter)
+                    {
+                        server.m_WaitersHead = waiter->m_Next;
+                        if (!server.m_WaitersHead)
+                        {
+                            server.m_WaitersTail = nullptr;
+                        }
+
+                        waiter->m_Pipe = std::move(pipe);
+                    }
+                    else
+                    {
+                        server.m_Connected.push_back(std::move(pipe));
+                    }
+                }
+            }
+
+            // Settled before the resume, which may destroy the server
+            if (--server.m_Pending == 0 && server.m_Stopping)
+            {
+                server.m_Idle.notify_all();
+            }
+        }
+
+        if (waiter)
+        {
+            waiter->m_Coroutine.resume();
+        }
+    }
+
+    [[nodiscard]] std::unique_ptr<std::byte[]> AcquireBuffer() noexcept
+    {
+        {
+            std::lock_guard lock(m_Lock);
+            if (!m_Buffers.empty())
+            {
+                auto buffer = std::move(m_Buffers.back());
+                m_Buffers.pop_back();
+                return buffer;
+            }
+        }
+
+        return std::unique_ptr<std::byte[]>(new (std::nothrow) std::byte[m_MaxMessageSize]);
+    }
+
+    void ReleaseBuffer(std::unique_ptr<std::byte[]> buffer) noexcept
+    {
+        std::lock_guard lock(m_Lock);
+        m_Buffers.push_back(std::move(buffer));
+    }
+};
+
+inline PipeConnection::PipeConnection(PipeServer& server, NamedPipeHandle pipe) noexcept
+    : m_Server(std::addressof(server))
+    , m_Pipe(std::move(pipe))
+    , m_Buffer(server.AcquireBuffer())
+{
+#if !defined(_WIN32)
+    // Windows instances are associated before they connect
+    if (m_Pipe.Valid() && !server.m_Engine.Associate(m_Pipe))
+    {
+        m_Pipe.Close();
+    }
+#endif
+}
+
+inline PipeConnection::ReceiveAwaitable PipeConnection::Receive() noexcept
+{
+    auto const size = m_Buffer ? m_Server->MaxMessageSize() : 0;
+    return ReceiveAwaitable(ReadAsync(m_Server->Engine(), m_Pipe, std::span(m_Buffer.get(), size)), m_Buffer.get());
+}
+
+inline auto PipeConnection::Send(std::span<std::byte const> message) noexcept
+{
+    return WriteAsync(m_Server->Engine(), m_Pipe, message);
+}
+
+inline void PipeConnection::Close() noexcept
+{
+    if (!m_Server)
+    {
+        return;
+    }
+
+    if (m_Pipe.Valid())
+    {
+        m_Server->Engine().Disassociate(m_Pipe);
+        m_Pipe.Close();
+    }
+
+    if (m_Buffer)
+    {
+        m_Server->ReleaseBuffer(std::move(m_Buffer));
+    }
+
+    m_Server = nullptr;
+}
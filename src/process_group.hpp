@@ -0,0 +1,638 @@
+#pragma once
+#include "handle.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * @brief Process id behind a ProcessHandle (GetProcessId / the Pid line of the pidfd's fdinfo), 0 on failure
+ */
+[[nodiscard]] inline std::uint32_t ProcessIdOf(ProcessHandle const& process) noexcept
+{
+#if defined(_WIN32)
+    return ::GetProcessId(process.Get());
+#else
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/self/fdinfo/%d", process.Get());
+
+    FileHandle info(::open(path, O_RDONLY | O_CLOEXEC));
+    if (!info.Valid())
+    {
+        return 0;
+    }
+
+    char buffer[512];
+    auto const read = ::read(info.Get(), buffer, sizeof(buffer) - 1);
+    if (read <= 0)
+    {
+        return 0;
+    }
+
+    std::string_view const text(buffer, static_cast<std::size_t>(read));
+    auto const line = text.find("\nPid:");
+    if (line == std::string_view::npos)
+    {
+        return 0;
+    }
+
+    auto const value = text.find_first_not_of(" \t", line + 5);
+    std::int64_t pid = 0;
+    if (value == std::string_view::npos || std::from_chars(text.data() + value, text.data() + text.size(), pid).ec != std::errc()
+        || pid <= 0)
+    {
+        return 0;
+    }
+
+    return static_cast<std::uint32_t>(pid);
+#endif
+}
+
+/*
+ * @brief Notification delivered by ProcessGroup::WaitEvents
+ */
+enum class ProcessGroupEvent
+{
+    // JOB_OBJECT_MSG_ACTIVE_PROCESS_LIMIT / pids.events max
+    ActiveProcessLimit,
+    // JOB_OBJECT_MSG_JOB_MEMORY_LIMIT and PROCESS_MEMORY_LIMIT / memory.events max and oom_kill
+    MemoryLimit,
+    // JOB_OBJECT_MSG_ACTIVE_PROCESS_ZERO / cgroup.events populated 0
+    Empty,
+    // JOB_OBJECT_MSG_EXIT_PROCESS and ABNORMAL_EXIT_PROCESS, Windows only
+    ProcessExited,
+};
+
+/*
+ * @brief Resource governor for a set of processes on a JobHandle
+ *
+ * Windows: a job object, limits through SetInformationJobObject and notifications through a
+ * completion port associated with the job (JobObjectAssociateCompletionPortInformation).
+ *
+ * Linux: a cgroup v2 directory below `root`, the JobHandle is the directory descriptor and
+ * every operation writes one of its control files, the way `echo value > file` does:
+ * cgroup.procs, cpu.max, memory.max, pids.max and cgroup.kill. Notifications come from inotify
+ * watches on cgroup.events, memory.events and pids.events, whose counters are compared with
+ * the last values seen. Limits need the cpu, memory and pids controllers, which the
+ * constructor tries to enable in the root's cgroup.subtree_control. Any writable directory
+ * works as a fake root: control files are then created as plain files, which is enough to
+ * exercise the group without a delegated cgroup.
+ *
+ * Processes stay in the group until they exit. With kill-on-close they are killed when the
+ * group is destroyed; otherwise they keep running, and on Linux the directory then stays
+ * behind as well.
+ */
+class ProcessGroup
+{
+private:
+    JobHandle                            m_Job;
+#if defined(_WIN32)
+    IoCompletionPortHandle               m_Port;
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION m_Limits{};
+#else
+    std::filesystem::path                m_Path;
+    FileHandle                           m_Events;
+    bool                                 m_KillOnClose  = false;
+    bool                                 m_Populated    = false;
+    std::uint64_t                        m_MemoryEvents = 0;
+    std::uint64_t                        m_PidsEvents   = 0;
+#endif
+
+public:
+    static constexpr std::chrono::milliseconds Infinite{ -1 };
+
+#if !defined(_WIN32)
+    /*
+     * @brief The cgroup v2 mount, /sys/fs/cgroup/unified on hybrid hosts
+     */
+    [[nodiscard]] static std::filesystem::path DefaultRoot()
+    {
+        std::error_code error;
+        return std::filesystem::exists("/sys/fs/cgroup/unified/cgroup.procs", error) ? "/sys/fs/cgroup/unified" : "/sys/fs/cgroup";
+    }
+#endif
+
+    /*
+     * @param Name of the job object / cgroup directory, empty for an anonymous job or a
+     *        generated directory name
+     * @param Linux only, parent cgroup (or fake root) the group is created in
+     */
+#if defined(_WIN32)
+    explicit ProcessGroup(std::wstring_view name = {})
+    {
+        m_Job.Reset(::CreateJobObjectW(nullptr, name.empty() ? nullptr : std::wstring(name).c_str()));
+        m_Port.Reset(::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1));
+        if (!m_Job.Valid() || !m_Port.Valid())
+        {
+            m_Job.Close();
+            return;
+        }
+
+        JOBOBJECT_ASSOCIATE_COMPLETION_PORT association{ m_Job.Get(), m_Port.Get() };
+        if (!::SetInformationJobObject(m_Job, JobObjectAssociateCompletionPortInformation, &association, sizeof(association)))
+        {
+            m_Job.Close();
+        }
+    }
+#else
+    explicit ProcessGroup(std::string_view name = {}, std::filesystem::path const& root = DefaultRoot())
+    {
+        static std::atomic<std::uint32_t> s_Generated = 0;
+
+        m_Path = root / (name.empty() ? "handle-" + std::to_string(::getpid()) + "-" + std::to_string(s_Generated++) : std::string(name));
+
+        // Best effort, limits of controllers that stay disabled fail later
+        FileHandle parent(::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (parent.Valid() && ::faccessat(parent.Get(), "cgroup.subtree_control", W_OK, 0) == 0)
+        {
+            for (auto const controller : { "+cpu", "+memory", "+pids" })
+            {
+                WriteControl(parent.Get(), "cgroup.subtree_control", O_TRUNC, controller);
+            }
+        }
+
+        if (::mkdir(m_Path.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            return;
+        }
+
+        m_Job.Reset(::open(m_Path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (!m_Job.Valid())
+        {
+            return;
+        }
+
+        m_Events.Reset(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+        if (m_Events.Valid())
+        {
+            for (auto const file : { "cgroup.events", "memory.events", "pids.events" })
+            {
+                ::inotify_add_watch(m_Events.Get(), (m_Path / file).c_str(), IN_MODIFY);
+            }
+        }
+
+        ReadCounters(m_Populated, m_MemoryEvents, m_PidsEvents);
+    }
+#endif
+
+    ProcessGroup(ProcessGroup&&) noexcept = default;
+
+    // The current group is closed first, with kill-on-close and directory removal like ~ProcessGroup
+    ProcessGroup& operator=(ProcessGroup&& other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+            Destroy();
+
+            m_Job          = std::move(other.m_Job);
+#if defined(_WIN32)
+            m_Port         = std::move(other.m_Port);
+            m_Limits       = other.m_Limits;
+#else
+            m_Path         = std::move(other.m_Path);
+            m_Events       = std::move(other.m_Events);
+            m_KillOnClose  = other.m_KillOnClose;
+            m_Populated    = other.m_Populated;
+            m_MemoryEvents = other.m_MemoryEvents;
+            m_PidsEvents   = other.m_PidsEvents;
+#endif
+        }
+
+        return *this;
+    }
+
+    ProcessGroup(ProcessGroup const&) = delete;
+    ProcessGroup& operator=(ProcessGroup const&) = delete;
+
+    ~ProcessGroup()
+    {
+        Destroy();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Job.Valid();
+    }
+
+    [[nodiscard]] JobHandle const& Job() const noexcept
+    {
+        return m_Job;
+    }
+
+#if defined(_WIN32)
+    /*
+     * @brief Port receiving the job notifications, WaitEvents() dequeues it
+     */
+    [[nodiscard]] IoCompletionPortHandle const& Port() const noexcept
+    {
+        return m_Port;
+    }
+#else
+    /*
+     * @brief inotify descriptor that turns readable on notifications, for a WaitSet or an engine
+     */
+    [[nodiscard]] FileHandle const& Port() const noexcept
+    {
+        return m_Events;
+    }
+
+    [[nodiscard]] std::filesystem::path const& Path() const noexcept
+    {
+        return m_Path;
+    }
+#endif
+
+    /*
+     * @brief Moves `process` into the group
+     */
+    bool Assign(ProcessHandle const& process) noexcept
+    {
+#if defined(_WIN32)
+        return ::AssignProcessToJobObject(m_Job, process);
+#else
+        auto const pid = ProcessIdOf(process);
+        return pid != 0 && WriteControl(m_Job.Get(), "cgroup.procs", O_APPEND, pid);
+#endif
+    }
+
+    /*
+     * @brief Hard cap on the CPU time of all processes together, in percent of all processors, 0 removes it
+     */
+    bool SetCpuRate(unsigned percent) noexcept
+    {
+        percent = std::min(percent, 100u);
+
+#if defined(_WIN32)
+        JOBOBJECT_CPU_RATE_CONTROL_INFORMATION rate{};
+        if (percent != 0)
+        {
+            rate.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP;
+            rate.CpuRate      = percent * 100;
+        }
+
+        return ::SetInformationJobObject(m_Job, JobObjectCpuRateControlInformation, &rate, sizeof(rate));
+#else
+        constexpr std::uint64_t Period = 100'000;
+
+        if (percent == 0)
+        {
+            return WriteControl(m_Job.Get(), "cpu.max", O_TRUNC, "max ", Period);
+        }
+
+        auto const processors = std::max(1u, std::thread::hardware_concurrency());
+        return WriteControl(m_Job.Get(), "cpu.max", O_TRUNC, Period * processors * percent / 100, " ", Period);
+#endif
+    }
+
+    /*
+     * @brief Limit on the committed memory of all processes together, 0 removes it
+     */
+    bool SetMemoryLimit(std::uint64_t bytes) noexcept
+    {
+#if defined(_WIN32)
+        m_Limits.JobMemoryLimit = static_cast<SIZE_T>(bytes);
+        return UpdateLimit(JOB_OBJECT_LIMIT_JOB_MEMORY, bytes != 0);
+#else
+        return bytes != 0 ? WriteControl(m_Job.Get(), "memory.max", O_TRUNC, bytes) : WriteControl(m_Job.Get(), "memory.max", O_TRUNC, "max");
+#endif
+    }
+
+    /*
+     * @brief Limit on the number of live processes, 0 removes it
+     *
+     * On Linux pids.max counts threads as well.
+     */
+    bool SetActiveProcessLimit(std::uint32_t count) noexcept
+    {
+#if defined(_WIN32)
+        m_Limits.BasicLimitInformation.ActiveProcessLimit = count;
+        return UpdateLimit(JOB_OBJECT_LIMIT_ACTIVE_PROCESS, count != 0);
+#else
+        return count != 0 ? WriteControl(m_Job.Get(), "pids.max", O_TRUNC, count) : WriteControl(m_Job.Get(), "pids.max", O_TRUNC, "max");
+#endif
+    }
+
+    /*
+     * @brief Whether destroying the group kills its processes
+     */
+    bool SetKillOnClose(bool kill) noexcept
+    {
+#if defined(_WIN32)
+        return UpdateLimit(JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE, kill);
+#else
+        m_KillOnClose = kill;
+        return true;
+#endif
+    }
+
+    /*
+     * @brief Kills every process in the group
+     *
+     * Linux writes cgroup.kill, before kernel 5.14 each listed process gets SIGKILL instead.
+     */
+    bool Terminate(std::uint32_t exitCode = 1) noexcept
+    {
+#if defined(_WIN32)
+        return ::TerminateJobObject(m_Job, exitCode);
+#else
+        (void)exitCode;
+
+        if (WriteControl(m_Job.Get(), "cgroup.kill", O_TRUNC, "1") && ::faccessat(m_Job.Get(), "cgroup.controllers", F_OK, 0) == 0)
+        {
+            return true;
+        }
+
+        return ForEachLine("cgroup.procs", [](std::string_view line) noexcept
+        {
+            int pid = 0;
+            if (std::from_chars(line.data(), line.data() + line.size(), pid).ec == std::errc() && pid > 0)
+            {
+                ::kill(pid, SIGKILL);
+            }
+        });
+#endif
+    }
+
+    /*
+     * @brief Waits up to `timeout` for notifications and passes each to `handler(ProcessGroupEvent, std::uint32_t pid)`
+     *
+     * The pid is 0 where the platform does not tell it (all Linux events, Windows Empty).
+     *
+     * @return Number of notifications delivered
+     */
+    template<typename _Handler>
+    std::size_t WaitEvents(_Handler&& handler, std::chrono::milliseconds timeout = Infinite) noexcept
+    {
+#if defined(_WIN32)
+        OVERLAPPED_ENTRY entries[16];
+        ULONG removed = 0;
+        if (!::GetQueuedCompletionStatusEx(m_Port, entries, 16, &removed, timeout < std::chrono::milliseconds::zero() ? INFINITE : static_cast<DWORD>(timeout.count()), FALSE))
+        {
+            return 0;
+        }
+
+        std::size_t delivered = 0;
+        for (ULONG i = 0; i < removed; ++i)
+        {
+            auto const pid = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(entries[i].lpOverlapped));
+
+            switch (entries[i].dwNumberOfBytesTransferred)
+            {
+            case JOB_OBJECT_MSG_ACTIVE_PROCESS_LIMIT:
+                handler(ProcessGroupEvent::ActiveProcessLimit, pid);
+                break;
+            case JOB_OBJECT_MSG_JOB_MEMORY_LIMIT:
+            case JOB_OBJECT_MSG_PROCESS_MEMORY_LIMIT:
+                handler(ProcessGroupEvent::MemoryLimit, pid);
+                break;
+            case JOB_OBJECT_MSG_ACTIVE_PROCESS_ZERO:
+                handler(ProcessGroupEvent::Empty, std::uint32_t(0));
+                break;
+            case JOB_OBJECT_MSG_EXIT_PROCESS:
+            case JOB_OBJECT_MSG_ABNORMAL_EXIT_PROCESS:
+                handler(ProcessGroupEvent::ProcessExited, pid);
+                break;
+            default:
+                continue;
+            }
+
+            ++delivered;
+        }
+
+        return delivered;
+#else
+        pollfd readable{ m_Events.Get(), POLLIN, 0 };
+        if (::poll(&readable, 1, timeout < std::chrono::milliseconds::zero() ? -1 : static_cast<int>(timeout.count())) <= 0)
+        {
+            return 0;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        while (::read(m_Events.Get(), buffer, sizeof(buffer)) > 0)
+        {
+        }
+
+        bool populated;
+        std::uint64_t memoryEvents, pidsEvents;
+        ReadCounters(populated, memoryEvents, pidsEvents);
+
+        std::size_t delivered = 0;
+        if (pidsEvents > m_PidsEvents)
+        {
+            handler(ProcessGroupEvent::ActiveProcessLimit, std::uint32_t(0));
+            ++delivered;
+        }
+
+        if (memoryEvents > m_MemoryEvents)
+        {
+            handler(ProcessGroupEvent::MemoryLimit, std::uint32_t(0));
+            ++delivered;
+        }
+
+        if (m_Populated && !populated)
+        {
+            handler(ProcessGroupEvent::Empty, std::uint32_t(0));
+            ++delivered;
+        }
+
+        m_Populated    = populated;
+        m_MemoryEvents = memoryEvents;
+        m_PidsEvents   = pidsEvents;
+        return delivered;
+#endif
+    }
+
+private:
+    /*
+     * @brief Closes the group, killing its processes with kill-on-close and removing the directory on Linux
+     */
+    void Destroy() noexcept
+    {
+#if defined(_WIN32)
+        // Closing the last job handle kills the processes with JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE
+        m_Job.Close();
+        m_Port.Close();
+#else
+        if (!m_Job.Valid())
+        {
+            return;
+        }
+
+        if (m_KillOnClose)
+        {
+            Terminate();
+        }
+
+        // Killed processes leave the group asynchronously
+        for (int attempt = 0; attempt < 1000; ++attempt)
+        {
+            if (::rmdir(m_Path.c_str()) == 0 || errno != EBUSY || !m_KillOnClose)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // A fake root holds plain control files, a cgroup directory refuses their removal
+        if (::access(m_Path.c_str(), F_OK) == 0 && ::faccessat(m_Job.Get(), "cgroup.controllers", F_OK, 0) != 0)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_Path, error);
+        }
+
+        m_Job.Close();
+        m_Events.Close();
+#endif
+    }
+
+#if defined(_WIN32)
+    bool UpdateLimit(DWORD flag, bool enable) noexcept
+    {
+        auto& flags = m_Limits.BasicLimitInformation.LimitFlags;
+        flags = enable ? flags | flag : flags & ~flag;
+
+        return ::SetInformationJobObject(m_Job, JobObjectExtendedLimitInformation, &m_Limits, sizeof(m_Limits));
+    }
+#else
+    /*
+     * @brief Writes `parts`, strings and integers, as one line to the control file `name`, creating it in a fake root
+     *
+     * The line is built on the stack, control values are short.
+     */
+    template<typename... _Parts>
+    static bool WriteControl(int directory, char const* name, int mode, _Parts... parts) noexcept
+    {
+        char line[64];
+        auto* position  = line;
+        auto* const end = line + sizeof(line) - 1;
+
+        auto const append = [&](auto part) noexcept
+        {
+            if constexpr (std::is_integral_v<decltype(part)>)
+            {
+                auto const [next, error] = std::to_chars(position, end, part);
+                position = next;
+                return error == std::errc();
+            }
+            else
+            {
+                std::string_view const text(part);
+                if (text.size() > static_cast<std::size_t>(end - position))
+                {
+                    return false;
+                }
+
+                std::memcpy(position, text.data(), text.size());
+                position += text.size();
+                return true;
+            }
+        };
+
+        if (!(append(parts) && ...))
+        {
+            return false;
+        }
+
+        *position++ = '\n';
+
+        FileHandle file(::openat(directory, name, O_WRONLY | O_CREAT | O_CLOEXEC | mode, 0644));
+        return file.Valid() && ::write(file.Get(), line, static_cast<std::size_t>(position - line)) == position - line;
+    }
+
+    /*
+     * @brief Calls `line(std::string_view)` for every line of the control file `name`, without allocating
+     *
+     * A line longer than the read buffer is handed out in pieces, control files have none.
+     */
+    template<typename _Line>
+    bool ForEachLine(char const* name, _Line&& line) const noexcept
+    {
+        FileHandle file(::openat(m_Job.Get(), name, O_RDONLY | O_CLOEXEC));
+        if (!file.Valid())
+        {
+            return false;
+        }
+
+        char buffer[4096];
+        std::size_t kept = 0;
+        for (ssize_t read; (read = ::read(file.Get(), buffer + kept, sizeof(buffer) - kept)) > 0;)
+        {
+            std::string_view contents(buffer, kept + static_cast<std::size_t>(read));
+            for (auto end = contents.find('\n'); end != std::string_view::npos; end = contents.find('\n'))
+            {
+                line(contents.substr(0, end));
+                contents.remove_prefix(end + 1);
+            }
+
+            if (contents.size() == sizeof(buffer))
+            {
+                line(contents);
+                contents = {};
+            }
+
+            // The unfinished line moves to the front and is completed by the next read
+            kept = contents.size();
+            std::memmove(buffer, contents.data(), kept);
+        }
+
+        if (kept != 0)
+        {
+            line(std::string_view(buffer, kept));
+        }
+
+        return true;
+    }
+
+    /*
+     * @brief Sum of the `keys` counters of a flat keyed file like memory.events
+     */
+    [[nodiscard]] std::uint64_t SumCounters(char const* name, std::initializer_list<std::string_view> keys) const noexcept
+    {
+        std::uint64_t sum = 0;
+        ForEachLine(name, [&](std::string_view line) noexcept
+        {
+            auto const space = line.find(' ');
+
+            std::uint64_t value = 0;
+            if (space != std::string_view::npos && std::find(keys.begin(), keys.end(), line.substr(0, space)) != keys.end()
+                && std::from_chars(line.data() + space + 1, line.data() + line.size(), value).ec == std::errc())
+            {
+                sum += value;
+            }
+        });
+
+        return sum;
+    }
+
+    void ReadCounters(bool& populated, std::uint64_t& memoryEvents, std::uint64_t& pidsEvents) const noexcept
+    {
+        populated    = SumCounters("cgroup.events", { "populated" }) != 0;
+        memoryEvents = SumCounters("memory.events", { "max", "oom_kill" });
+        pidsEvents   = SumCounters("pids.events", { "max" });
+    }
+#endif
+};
@@ -0,0 +1,866 @@
+#pragma once
+#include "handle.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <tlhelp32.h>
+#include <winternl.h>
+#else
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+using SnapshotName = std::wstring_view;
+#else
+using SnapshotName = std::string_view;
+#endif
+
+/*
+ * @brief Entries yielded by the ProcessSnapshot ranges
+ *
+ * Names point into the snapshot's buffer and are valid until the iterator advances.
+ */
+struct ProcessEntry
+{
+    std::uint32_t m_ProcessId = 0;
+    std::uint32_t m_ParentId  = 0;
+    std::uint32_t m_Threads   = 0;
+    SnapshotName  m_Name;
+};
+
+struct ThreadEntry
+{
+    std::uint32_t m_ThreadId       = 0;
+    std::uint32_t m_OwnerProcessId = 0;
+};
+
+struct ModuleEntry
+{
+    std::uintptr_t m_Base = 0;
+    std::size_t    m_Size = 0;
+    SnapshotName   m_Name;
+    SnapshotName   m_Path;
+};
+
+struct HeapEntry
+{
+    std::uintptr_t m_Id        = 0;
+    std::uint32_t  m_ProcessId = 0;
+    bool           m_Default   = false;
+};
+
+/*
+ * @brief What a ProcessSnapshot captures, the TH32CS_SNAP* flags
+ */
+enum class SnapshotContents : std::uint32_t
+{
+    Processes = 1 << 0,
+    Threads   = 1 << 1,
+    Modules   = 1 << 2,
+    Heaps     = 1 << 3,
+    All       = Processes | Threads | Modules | Heaps,
+};
+
+[[nodiscard]] constexpr SnapshotContents operator|(SnapshotContents lhs, SnapshotContents rhs) noexcept
+{
+    return static_cast<SnapshotContents>(static_cast<std::uint32_t>(lhs) | static_cast<std::uint32_t>(rhs));
+}
+
+[[nodiscard]] constexpr bool operator&(SnapshotContents lhs, SnapshotContents rhs) noexcept
+{
+    return (static_cast<std::uint32_t>(lhs) & static_cast<std::uint32_t>(rhs)) != 0;
+}
+
+class ProcessSnapshot;
+
+/*
+ * @brief Input iterator over one kind of snapshot entry, every step overwrites the same entry
+ */
+template<typename _Entry>
+class SnapshotIterator
+{
+private:
+    ProcessSnapshot* m_Snapshot = nullptr;
+    _Entry           m_Entry;
+
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = _Entry;
+    using difference_type   = std::ptrdiff_t;
+
+    SnapshotIterator() noexcept = default;
+
+    explicit SnapshotIterator(ProcessSnapshot& snapshot) noexcept;
+
+    [[nodiscard]] _Entry const& operator*() const noexcept
+    {
+        return m_Entry;
+    }
+
+    [[nodiscard]] _Entry const* operator->() const noexcept
+    {
+        return std::addressof(m_Entry);
+    }
+
+    SnapshotIterator& operator++() noexcept;
+
+    void operator++(int) noexcept
+    {
+        ++*this;
+    }
+
+    [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept
+    {
+        return m_Snapshot == nullptr;
+    }
+};
+
+template<typename _Entry>
+class SnapshotRange
+{
+private:
+    ProcessSnapshot* m_Snapshot;
+
+public:
+    explicit SnapshotRange(ProcessSnapshot& snapshot) noexcept
+        : m_Snapshot(std::addressof(snapshot))
+    {
+    }
+
+    /*
+     * @brief Restarts the enumeration, a snapshot runs one enumeration at a time
+     */
+    [[nodiscard]] SnapshotIterator<_Entry> begin() const noexcept
+    {
+        return SnapshotIterator<_Entry>(*m_Snapshot);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept
+    {
+        return std::default_sentinel;
+    }
+};
+
+#if !defined(_WIN32)
+namespace SnapshotDetail
+{
+    /*
+     * @brief getdents64 over a directory into a caller provided area, yielding numeric names only
+     */
+    class DirectoryReader
+    {
+    private:
+        int         m_Directory = -1;
+        char*       m_Buffer    = nullptr;
+        std::size_t m_Capacity  = 0;
+        std::size_t m_Size      = 0;
+        std::size_t m_Offset    = 0;
+
+        struct LinuxDirent64
+        {
+            std::uint64_t  d_ino;
+            std::int64_t   d_off;
+            unsigned short d_reclen;
+            unsigned char  d_type;
+            char           d_name[1];
+        };
+
+    public:
+        DirectoryReader() noexcept = default;
+
+        DirectoryReader(char* buffer, std::size_t capacity) noexcept
+            : m_Buffer(buffer)
+            , m_Capacity(capacity)
+        {
+        }
+
+        void Rewind(int directory) noexcept
+        {
+            m_Directory = directory;
+            m_Size      = 0;
+            m_Offset    = 0;
+            ::lseek(directory, 0, SEEK_SET);
+        }
+
+        /*
+         * @return The next all-digit entry as a number, 0 at the end
+         */
+        [[nodiscard]] std::uint32_t Next() noexcept
+        {
+            for (;;)
+            {
+                if (m_Offset == m_Size)
+                {
+                    auto const read = ::syscall(SYS_getdents64, m_Directory, m_Buffer, m_Capacity);
+                    if (read <= 0)
+                    {
+                        return 0;
+                    }
+
+                    m_Size   = static_cast<std::size_t>(read);
+                    m_Offset = 0;
+                }
+
+                auto const* entry = reinterpret_cast<LinuxDirent64 const*>(m_Buffer + m_Offset);
+                m_Offset += entry->d_reclen;
+
+                std::string_view const name(entry->d_name);
+                std::uint32_t id = 0;
+                if (std::from_chars(name.data(), name.data() + name.size(), id).ptr == name.data() + name.size() && id != 0)
+                {
+                    return id;
+                }
+            }
+        }
+    };
+
+    /*
+     * @brief Reads a whole /proc file below `directory` into `contents`, which only ever grows
+     */
+    inline bool ReadFile(int directory, char const* path, std::vector<char>& contents, std::size_t& size) noexcept
+    {
+        FileHandle file(::openat(directory, path, O_RDONLY | O_CLOEXEC));
+        if (!file.Valid())
+        {
+            return false;
+        }
+
+        size = 0;
+        for (;;)
+        {
+            if (size == contents.size())
+            {
+                contents.resize(std::max<std::size_t>(contents.size() * 2, 4096));
+            }
+
+            auto const read = ::read(file.Get(), contents.data() + size, contents.size() - size);
+            if (read < 0)
+            {
+                return false;
+            }
+
+            if (read == 0)
+            {
+                return true;
+            }
+
+            size += static_cast<std::size_t>(read);
+        }
+    }
+
+    /*
+     * @brief One line of /proc/<pid>/maps
+     */
+    struct Mapping
+    {
+        std::uintptr_t   m_Start = 0;
+        std::uintptr_t   m_End   = 0;
+        std::string_view m_Path;
+    };
+
+    inline bool ParseMapping(std::string_view line, Mapping& mapping) noexcept
+    {
+        auto const* const end = line.data() + line.size();
+
+        auto parsed = std::from_chars(line.data(), end, mapping.m_Start, 16);
+        if (parsed.ec != std::errc() || parsed.ptr == end || *parsed.ptr != '-')
+        {
+            return false;
+        }
+
+        parsed = std::from_chars(parsed.ptr + 1, end, mapping.m_End, 16);
+        if (parsed.ec != std::errc())
+        {
+            return false;
+        }
+
+        // perms offset dev inode, then the path padded with spaces
+        auto position = static_cast<std::size_t>(parsed.ptr - line.data());
+        for (int field = 0; field < 4 && position != std::string_view::npos; ++field)
+        {
+            position = line.find_first_not_of(' ', position);
+            position = position == std::string_view::npos ? position : line.find(' ', position);
+        }
+
+        position       = position == std::string_view::npos ? position : line.find_first_not_of(' ', position);
+        mapping.m_Path = position == std::string_view::npos ? std::string_view() : line.substr(position);
+        return true;
+    }
+}
+#endif
+
+/*
+ * @brief Processes, threads, modules and heaps of the system or of one process
+ *
+ * Windows: a CreateToolhelp32Snapshot SnapshotHandle, walked with Process32FirstW and its siblings
+ * into one entry union. Linux has no point in time snapshot: the SnapshotHandle is
+ * the /proc directory, processes and threads are read with getdents64 and /proc/<pid>/stat,
+ * modules and heaps from /proc/<pid>/maps (file backed mappings, the [heap] mapping). On both
+ * the entries live in buffers owned by the snapshot, so walking it again allocates nothing.
+ *
+ * Threads of the whole system on Linux walk every /proc/<pid>/task directory.
+ */
+class ProcessSnapshot
+{
+private:
+    template<typename _Entry>
+    friend class SnapshotIterator;
+
+    SnapshotHandle   m_Snapshot;
+    std::uint32_t    m_ProcessId = 0;
+
+#if defined(_WIN32)
+    union
+    {
+        PROCESSENTRY32W m_Process;
+        THREADENTRY32   m_Thread;
+        MODULEENTRY32W  m_Module;
+        HEAPLIST32      m_Heap;
+    };
+#else
+    static constexpr std::size_t DirectoryBufferSize = 32 << 10;
+
+    std::unique_ptr<char[]>           m_Directories;
+    SnapshotDetail::DirectoryReader   m_Outer;
+    SnapshotDetail::DirectoryReader   m_Inner;
+    FileHandle                        m_Tasks;
+    std::uint32_t                     m_Owner = 0;
+
+    std::vector<char>                 m_File;
+    std::size_t                       m_FileSize   = 0;
+    std::size_t                       m_FileOffset = 0;
+#endif
+
+public:
+    /*
+     * @param What to capture, Linux reads everything lazily and ignores it
+     * @param Process whose threads, modules and heaps are listed, 0 for the caller's modules
+     *        and heaps and the threads of every process
+     */
+    explicit ProcessSnapshot(SnapshotContents contents = SnapshotContents::Processes | SnapshotContents::Threads,
+                             std::uint32_t processId = 0) noexcept
+        : m_ProcessId(processId)
+    {
+#if defined(_WIN32)
+        DWORD flags = 0;
+        flags |= contents & SnapshotContents::Processes ? TH32CS_SNAPPROCESS : 0;
+        flags |= contents & SnapshotContents::Threads ? TH32CS_SNAPTHREAD : 0;
+        flags |= contents & SnapshotContents::Modules ? TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32 : 0;
+        flags |= contents & SnapshotContents::Heaps ? TH32CS_SNAPHEAPLIST : 0;
+
+        // Modules and heaps of a process still starting fail with ERROR_BAD_LENGTH until it settles
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            m_Snapshot.Reset(::CreateToolhelp32Snapshot(flags, processId));
+            if (m_Snapshot.Valid() || ::GetLastError() != ERROR_BAD_LENGTH)
+            {
+                break;
+            }
+        }
+#else
+        (void)contents;
+
+        m_Snapshot.Reset(::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        m_Directories.reset(new (std::nothrow) char[DirectoryBufferSize * 2]);
+        if (!m_Directories)
+        {
+            m_Snapshot.Close();
+            return;
+        }
+
+        m_Outer = SnapshotDetail::DirectoryReader(m_Directories.get(), DirectoryBufferSize);
+        m_Inner = SnapshotDetail::DirectoryReader(m_Directories.get() + DirectoryBufferSize, DirectoryBufferSize);
+#endif
+    }
+
+    ProcessSnapshot(ProcessSnapshot const&) = delete;
+    ProcessSnapshot& operator=(ProcessSnapshot const&) = delete;
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Snapshot.Valid();
+    }
+
+    [[nodiscard]] SnapshotHandle const& Snapshot() const noexcept
+    {
+        return m_Snapshot;
+    }
+
+    [[nodiscard]] SnapshotRange<ProcessEntry> Processes() noexcept
+    {
+        return SnapshotRange<ProcessEntry>(*this);
+    }
+
+    [[nodiscard]] SnapshotRange<ThreadEntry> Threads() noexcept
+    {
+        return SnapshotRange<ThreadEntry>(*this);
+    }
+
+    [[nodiscard]] SnapshotRange<ModuleEntry> Modules() noexcept
+    {
+        return SnapshotRange<ModuleEntry>(*this);
+    }
+
+    [[nodiscard]] SnapshotRange<HeapEntry> Heaps() noexcept
+    {
+        return SnapshotRange<HeapEntry>(*this);
+    }
+
+private:
+#if defined(_WIN32)
+    bool Advance(ProcessEntry& entry, bool first) noexcept
+    {
+        m_Process.dwSize = sizeof(m_Process);
+        if (!(first ? ::Process32FirstW(m_Snapshot, &m_Process) : ::Process32NextW(m_Snapshot, &m_Process)))
+        {
+            return false;
+        }
+
+        entry.m_ProcessId = m_Process.th32ProcessID;
+        entry.m_ParentId  = m_Process.th32ParentProcessID;
+        entry.m_Threads   = m_Process.cntThreads;
+        entry.m_Name      = m_Process.szExeFile;
+        return true;
+    }
+
+    bool Advance(ThreadEntry& entry, bool first) noexcept
+    {
+        m_Thread.dwSize = sizeof(m_Thread);
+        for (;;)
+        {
+            if (!(first ? ::Thread32First(m_Snapshot, &m_Thread) : ::Thread32Next(m_Snapshot, &m_Thread)))
+            {
+                return false;
+            }
+
+            // The thread list is always system wide
+            if (m_ProcessId == 0 || m_Thread.th32OwnerProcessID == m_ProcessId)
+            {
+                entry.m_ThreadId       = m_Thread.th32ThreadID;
+                entry.m_OwnerProcessId = m_Thread.th32OwnerProcessID;
+                return true;
+            }
+
+            first = false;
+        }
+    }
+
+    bool Advance(ModuleEntry& entry, bool first) noexcept
+    {
+        m_Module.dwSize = sizeof(m_Module);
+        if (!(first ? ::Module32FirstW(m_Snapshot, &m_Module) : ::Module32NextW(m_Snapshot, &m_Module)))
+        {
+            return false;
+        }
+
+        entry.m_Base = reinterpret_cast<std::uintptr_t>(m_Module.modBaseAddr);
+        entry.m_Size = m_Module.modBaseSize;
+        entry.m_Name = m_Module.szModule;
+        entry.m_Path = m_Module.szExePath;
+        return true;
+    }
+
+    bool Advance(HeapEntry& entry, bool first) noexcept
+    {
+        m_Heap.dwSize = sizeof(m_Heap);
+        if (!(first ? ::Heap32ListFirst(m_Snapshot, &m_Heap) : ::Heap32ListNext(m_Snapshot, &m_Heap)))
+        {
+            return false;
+        }
+
+        entry.m_Id        = m_Heap.th32HeapID;
+        entry.m_ProcessId = m_Heap.th32ProcessID;
+        entry.m_Default   = (m_Heap.dwFlags & HF32_DEFAULT) != 0;
+        return true;
+    }
+#else
+    bool Advance(ProcessEntry& entry, bool first) noexcept
+    {
+        if (first)
+        {
+            m_Outer.Rewind(m_Snapshot.Get());
+        }
+
+        // Processes exiting meanwhile are skipped
+        for (std::uint32_t pid; (pid = m_Outer.Next()) != 0;)
+        {
+            char path[32];
+            std::snprintf(path, sizeof(path), "%u/stat", pid);
+            if (ParseStat(path, entry))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool Advance(ThreadEntry& entry, bool first) noexcept
+    {
+        if (first)
+        {
+            m_Tasks.Close();
+            if (m_ProcessId == 0)
+            {
+                m_Outer.Rewind(m_Snapshot.Get());
+            }
+            else if (!OpenTasks(m_ProcessId))
+            {
+                return false;
+            }
+        }
+
+        for (;;)
+        {
+            if (m_Tasks.Valid())
+            {
+                if (auto const tid = m_Inner.Next(); tid != 0)
+                {
+                    entry.m_ThreadId       = tid;
+                    entry.m_OwnerProcessId = m_Owner;
+                    return true;
+                }
+
+                m_Tasks.Close();
+            }
+
+            if (m_ProcessId != 0)
+            {
+                return false;
+            }
+
+            auto const pid = m_Outer.Next();
+            if (pid == 0)
+            {
+                return false;
+            }
+
+            OpenTasks(pid);
+        }
+    }
+
+    bool Advance(ModuleEntry& entry, bool first) noexcept
+    {
+        if (first && !ReadMaps())
+        {
+            return false;
+        }
+
+        // Consecutive mappings of one file form its module
+        SnapshotDetail::Mapping mapping;
+        bool found = false;
+        while (m_FileOffset < m_FileSize)
+        {
+            auto const start = m_FileOffset;
+            if (!NextMapping(mapping) || mapping.m_Path.empty() || mapping.m_Path.front() != '/')
+            {
+                continue;
+            }
+
+            if (!found)
+            {
+                found        = true;
+                entry.m_Base = mapping.m_Start;
+                entry.m_Path = mapping.m_Path;
+            }
+            else if (mapping.m_Path != entry.m_Path)
+            {
+                m_FileOffset = start;
+                break;
+            }
+
+            entry.m_Size = mapping.m_End - entry.m_Base;
+        }
+
+        if (found)
+        {
+            auto const slash = entry.m_Path.rfind('/');
+            entry.m_Name     = entry.m_Path.substr(slash + 1);
+        }
+
+        return found;
+    }
+
+    bool Advance(HeapEntry& entry, bool first) noexcept
+    {
+        if (first && !ReadMaps())
+        {
+            return false;
+        }
+
+        SnapshotDetail::Mapping mapping;
+        while (m_FileOffset < m_FileSize)
+        {
+            if (NextMapping(mapping) && mapping.m_Path == "[heap]")
+            {
+                entry.m_Id        = mapping.m_Start;
+                entry.m_ProcessId = m_ProcessId != 0 ? m_ProcessId : static_cast<std::uint32_t>(::getpid());
+                entry.m_Default   = true;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*
+     * @brief Parses "pid (comm) state ppid ... num_threads ..." into `entry`, comm may hold spaces and parentheses
+     */
+    bool ParseStat(char const* path, ProcessEntry& entry) noexcept
+    {
+        if (!SnapshotDetail::ReadFile(m_Snapshot.Get(), path, m_File, m_FileSize))
+        {
+            return false;
+        }
+
+        std::string_view const stat(m_File.data(), m_FileSize);
+        auto const open  = stat.find('(');
+        auto const close = stat.rfind(')');
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open)
+        {
+            return false;
+        }
+
+        std::from_chars(stat.data(), stat.data() + open, entry.m_ProcessId);
+        entry.m_Name = stat.substr(open + 1, close - open - 1);
+
+        // Fields after comm: state ppid ... num_threads is the 18th
+        std::uint32_t field = 0;
+        for (auto position = close + 1; position < stat.size() && field < 18;)
+        {
+            position = stat.find_first_not_of(' ', position);
+            if (position == std::string_view::npos)
+            {
+                break;
+            }
+
+            auto const end = std::min(stat.find(' ', position), stat.size());
+            if (++field == 2)
+            {
+                std::from_chars(stat.data() + position, stat.data() + end, entry.m_ParentId);
+            }
+            else if (field == 18)
+            {
+                std::from_chars(stat.data() + position, stat.data() + end, entry.m_Threads);
+            }
+
+            position = end;
+        }
+
+        return field == 18;
+    }
+
+    bool OpenTasks(std::uint32_t pid) noexcept
+    {
+        char path[32];
+        std::snprintf(path, sizeof(path), "%u/task", pid);
+
+        m_Tasks.Reset(::openat(m_Snapshot.Get(), path, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (!m_Tasks.Valid())
+        {
+            return false;
+        }
+
+        m_Owner = pid;
+        m_Inner.Rewind(m_Tasks.Get());
+        return true;
+    }
+
+    bool ReadMaps() noexcept
+    {
+        char path[32];
+        if (m_ProcessId != 0)
+        {
+            std::snprintf(path, sizeof(path), "%u/maps", m_ProcessId);
+        }
+        else
+        {
+            std::snprintf(path, sizeof(path), "self/maps");
+        }
+
+        m_FileOffset = 0;
+        return SnapshotDetail::ReadFile(m_Snapshot.Get(), path, m_File, m_FileSize);
+    }
+
+    bool NextMapping(SnapshotDetail::Mapping& mapping) noexcept
+    {
+        std::string_view const contents(m_File.data(), m_FileSize);
+        auto const end  = std::min(contents.find('\n', m_FileOffset), contents.size());
+        auto const line = contents.substr(m_FileOffset, end - m_FileOffset);
+
+        m_FileOffset = end + 1;
+        return SnapshotDetail::ParseMapping(line, mapping);
+    }
+#endif
+};
+
+template<typename _Entry>
+SnapshotIterator<_Entry>::SnapshotIterator(ProcessSnapshot& snapshot) noexcept
+    : m_Snapshot(snapshot.Valid() ? std::addressof(snapshot) : nullptr)
+{
+    if (m_Snapshot && !m_Snapshot->Advance(m_Entry, true))
+    {
+        m_Snapshot = nullptr;
+    }
+}
+
+template<typename _Entry>
+SnapshotIterator<_Entry>& SnapshotIterator<_Entry>::operator++() noexcept
+{
+    if (!m_Snapshot->Advance(m_Entry, false))
+    {
+        m_Snapshot = nullptr;
+    }
+
+    return *this;
+}
+
+#if defined(_WIN32)
+/*
+ * @brief Every process in one NtQuerySystemInformation(SystemProcessInformation) call
+ *
+ * One system call instead of a snapshot section plus a call per entry, the buffer is kept
+ * and only grows between refreshes. Linux has no bulk equivalent, ProcessSnapshot reads /proc
+ * directly.
+ */
+class SystemProcessList
+{
+private:
+    using NtQuerySystemInformationFunction = NTSTATUS(NTAPI*)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+    static constexpr NTSTATUS InfoLengthMismatch = static_cast<NTSTATUS>(0xC0000004L);
+
+    std::unique_ptr<std::byte[]> m_Buffer;
+    ULONG                        m_Capacity = 0;
+    ULONG                        m_Size     = 0;
+
+public:
+    class Iterator
+    {
+    private:
+        std::byte const* m_Current = nullptr;
+        ProcessEntry     m_Entry;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = ProcessEntry;
+        using difference_type   = std::ptrdiff_t;
+
+        Iterator() noexcept = default;
+
+        explicit Iterator(std::byte const* current) noexcept
+            : m_Current(current)
+        {
+            Load();
+        }
+
+        [[nodiscard]] ProcessEntry const& operator*() const noexcept
+        {
+            return m_Entry;
+        }
+
+        [[nodiscard]] ProcessEntry const* operator->() const noexcept
+        {
+            return std::addressof(m_Entry);
+        }
+
+        Iterator& operator++() noexcept
+        {
+            auto const next = reinterpret_cast<SYSTEM_PROCESS_INFORMATION const*>(m_Current)->NextEntryOffset;
+            m_Current = next != 0 ? m_Current + next : nullptr;
+            Load();
+            return *this;
+        }
+
+        void operator++(int) noexcept
+        {
+            ++*this;
+        }
+
+        [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept
+        {
+            return m_Current == nullptr;
+        }
+
+    private:
+        void Load() noexcept
+        {
+            if (m_Current == nullptr)
+            {
+                return;
+            }
+
+            auto const* information = reinterpret_cast<SYSTEM_PROCESS_INFORMATION const*>(m_Current);
+            m_Entry.m_ProcessId = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(information->UniqueProcessId));
+            // Reserved2 is InheritedFromUniqueProcessId
+            m_Entry.m_ParentId = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(information->Reserved2));
+            m_Entry.m_Threads  = information->NumberOfThreads;
+            m_Entry.m_Name     = SnapshotName(information->ImageName.Buffer, information->ImageName.Length / sizeof(wchar_t));
+        }
+    };
+
+public:
+    /*
+     * @brief Replaces the list with the current processes
+     */
+    bool Refresh() noexcept
+    {
+        static auto const query = reinterpret_cast<NtQuerySystemInformationFunction>(
+            ::GetProcAddress(::GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation"));
+        if (query == nullptr)
+        {
+            return false;
+        }
+
+        for (;;)
+        {
+            ULONG needed = 0;
+            NTSTATUS const status = query(SystemProcessInformation, m_Buffer.get(), m_Capacity, &needed);
+            if (status >= 0)
+            {
+                m_Size = needed;
+                return true;
+            }
+
+            if (status != InfoLengthMismatch)
+            {
+                m_Size = 0;
+                return false;
+            }
+
+            // Processes start between the calls, leave some room
+            m_Capacity = needed + needed / 8 + 4096;
+            m_Buffer.reset(new (std::nothrow) std::byte[m_Capacity]);
+            if (!m_Buffer)
+            {
+                m_Capacity = 0;
+                m_Size     = 0;
+                return false;
+            }
+        }
+    }
+
+    [[nodiscard]] Iterator begin() const noexcept
+    {
+        return Iterator(m_Size != 0 ? m_Buffer.get() : nullptr);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept
+    {
+        return std::default_sentinel;
+    }
+};
+#endif
@@ -0,0 +1,457 @@
+#pragma once
+#include "handle.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <array>
+#else
+#include <csignal>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 39)
+#include <sys/pidfd.h>
+#endif
+
+extern char** environ;
+#endif
+
+/*
+ * @brief What Spawn() starts and which handles the child receives
+ */
+struct SpawnOptions
+{
+    // Searched on PATH when it has no directory part
+    std::filesystem::path             m_Program;
+    // Arguments after the program name, UTF-8
+    std::span<std::string_view const> m_Arguments;
+    // Empty keeps the working directory of the caller
+    std::filesystem::path             m_WorkingDirectory;
+
+    // Standard handles of the child, unset ones are the caller's
+    std::optional<NativeHandle>       m_Input;
+    std::optional<NativeHandle>       m_Output;
+    std::optional<NativeHandle>       m_Error;
+
+    /*
+     * Handles passed to the child on top of the standard ones, nothing else is inherited.
+     * Windows keeps their values and marks them inheritable. On Linux the child finds them
+     * at descriptors 3, 4, ... in this order, like LISTEN_FDS.
+     */
+    std::span<NativeHandle const>     m_Inherit;
+
+    // Windows only, the primary thread waits for SpawnedProcess::Resume()
+    bool                              m_Suspended = false;
+};
+
+/*
+ * @brief Owned handles of a started process: a pidfd on Linux, process and primary thread on Windows
+ */
+struct SpawnedProcess
+{
+    ProcessHandle m_Process;
+#if defined(_WIN32)
+    ThreadHandle  m_Thread;
+#endif
+    std::uint32_t m_ProcessId = 0;
+
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Process.Valid();
+    }
+
+    /*
+     * @brief Starts the primary thread of a process spawned with m_Suspended
+     */
+    bool Resume() noexcept
+    {
+#if defined(_WIN32)
+        return ::ResumeThread(m_Thread) != static_cast<DWORD>(-1);
+#else
+        return true;
+#endif
+    }
+
+    /*
+     * @brief Blocks until the process exits, on Linux the process is reaped through the pidfd
+     *
+     * @return Exit code, 128 + signal number for a killed Linux process, -1 on failure
+     */
+    int Wait() noexcept
+    {
+#if defined(_WIN32)
+        DWORD code = 0;
+        if (::WaitForSingleObject(m_Process, INFINITE) != WAIT_OBJECT_0 || !::GetExitCodeProcess(m_Process, &code))
+        {
+            return -1;
+        }
+
+        return static_cast<int>(code);
+#else
+        siginfo_t info{};
+        int result;
+        do
+        {
+            result = ::waitid(static_cast<idtype_t>(P_PIDFD), static_cast<id_t>(m_Process.Get()), &info, WEXITED);
+        }
+        while (result != 0 && errno == EINTR);
+
+        if (result != 0)
+        {
+            return -1;
+        }
+
+        return info.si_code == CLD_EXITED ? info.si_status : 128 + info.si_status;
+#endif
+    }
+};
+
+namespace SpawnDetail
+{
+#if defined(_WIN32)
+    [[nodiscard]] inline std::wstring Widen(std::string_view text)
+    {
+        std::wstring wide;
+        if (text.empty())
+        {
+            return wide;
+        }
+
+        wide.resize(static_cast<std::size_t>(::MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0)));
+        ::MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), wide.data(), static_cast<int>(wide.size()));
+        return wide;
+    }
+
+    /*
+     * @brief Appends `argument` quoted so that CommandLineToArgvW gives it back unchanged
+     */
+    inline void AppendArgument(std::wstring& commandLine, std::wstring_view argument)
+    {
+        if (!commandLine.empty())
+        {
+            commandLine += L' ';
+        }
+
+        if (!argument.empty() && argument.find_first_of(L" \t\n\v\"") == std::wstring_view::npos)
+        {
+            commandLine += argument;
+            return;
+        }
+
+        commandLine += L'"';
+        for (std::size_t i = 0;; ++i)
+        {
+            std::size_t backslashes = 0;
+            for (; i < argument.size() && argument[i] == L'\\'; ++i)
+            {
+                ++backslashes;
+            }
+
+            if (i == argument.size())
+            {
+                // Doubled, the closing quote follows
+                commandLine.append(backslashes * 2, L'\\');
+                break;
+            }
+
+            if (argument[i] == L'"')
+            {
+                commandLine.append(backslashes * 2 + 1, L'\\');
+            }
+            else
+            {
+                commandLine.append(backslashes, L'\\');
+            }
+
+            commandLine += argument[i];
+        }
+
+        commandLine += L'"';
+    }
+
+    /*
+     * @brief Makes handles inheritable for one CreateProcessW and clears the flag again on the
+     *        ones that were not inheritable before, on every path out of Spawn()
+     */
+    struct InheritScope
+    {
+        std::vector<HANDLE> m_Changed;
+
+        [[nodiscard]] bool Add(HANDLE handle)
+        {
+            DWORD flags = 0;
+            if (!::GetHandleInformation(handle, &flags))
+            {
+                return false;
+            }
+
+            if (flags & HANDLE_FLAG_INHERIT)
+            {
+                return true;
+            }
+
+            if (!::SetHandleInformation(handle, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT))
+            {
+                return false;
+            }
+
+            m_Changed.push_back(handle);
+            return true;
+        }
+
+        InheritScope() = default;
+
+        ~InheritScope()
+        {
+            DWORD const error = ::GetLastError();
+            for (auto const handle : m_Changed)
+            {
+                ::SetHandleInformation(handle, HANDLE_FLAG_INHERIT, 0);
+            }
+
+            ::SetLastError(error);
+        }
+
+        InheritScope(InheritScope const&) = delete;
+        InheritScope& operator=(InheritScope const&) = delete;
+    };
+#else
+    /*
+     * @brief posix_spawn file actions and attributes, released on every path out of Spawn()
+     */
+    struct SpawnAttributes
+    {
+        posix_spawn_file_actions_t m_Actions;
+        posix_spawnattr_t          m_Attributes;
+
+        SpawnAttributes() noexcept
+        {
+            ::posix_spawn_file_actions_init(&m_Actions);
+            ::posix_spawnattr_init(&m_Attributes);
+        }
+
+        ~SpawnAttributes()
+        {
+            ::posix_spawnattr_destroy(&m_Attributes);
+            ::posix_spawn_file_actions_destroy(&m_Actions);
+        }
+
+        SpawnAttributes(SpawnAttributes const&) = delete;
+        SpawnAttributes& operator=(SpawnAttributes const&) = delete;
+    };
+#endif
+}
+
+/*
+ * @brief Starts `options.m_Program` and returns its owned handles
+ *
+ * Only the standard handles and `m_Inherit` reach the child, whatever else the caller left
+ * inheritable. Windows passes them through PROC_THREAD_ATTRIBUTE_HANDLE_LIST and clears
+ * HANDLE_FLAG_INHERIT again afterwards on the ones that did not have it, so concurrent Spawn()
+ * calls must not share a handle that is not inheritable on its own. Linux spawns
+ * with posix_spawn, which is a vfork-style clone in glibc, and closes every descriptor above
+ * the inherited ones in the child. With glibc 2.39 the pidfd comes from pidfd_spawnp.
+ * Otherwise it is opened right after the spawn. That is race free only while nothing else
+ * reaps children, so SIGCHLD must not be ignored and no waitpid(-1) may run.
+ *
+ * @return Invalid on failure, GetLastError() / errno tells why
+ */
+[[nodiscard]] inline SpawnedProcess Spawn(SpawnOptions const& options)
+{
+    SpawnedProcess spawned;
+
+#if defined(_WIN32)
+    std::wstring commandLine;
+    SpawnDetail::AppendArgument(commandLine, options.m_Program.native());
+    for (auto const argument : options.m_Arguments)
+    {
+        SpawnDetail::AppendArgument(commandLine, SpawnDetail::Widen(argument));
+    }
+
+    STARTUPINFOEXW startup{};
+    startup.StartupInfo.cb = sizeof(startup);
+
+    std::vector<HANDLE> inherit(options.m_Inherit.begin(), options.m_Inherit.end());
+    if (options.m_Input || options.m_Output || options.m_Error)
+    {
+        startup.StartupInfo.dwFlags    = STARTF_USESTDHANDLES;
+        startup.StartupInfo.hStdInput  = options.m_Input.value_or(::GetStdHandle(STD_INPUT_HANDLE));
+        startup.StartupInfo.hStdOutput = options.m_Output.value_or(::GetStdHandle(STD_OUTPUT_HANDLE));
+        startup.StartupInfo.hStdError  = options.m_Error.value_or(::GetStdHandle(STD_ERROR_HANDLE));
+
+        for (auto const standard : { startup.StartupInfo.hStdInput, startup.StartupInfo.hStdOutput, startup.StartupInfo.hStdError })
+        {
+            if (standard != nullptr && standard != INVALID_HANDLE_VALUE)
+            {
+                inherit.push_back(standard);
+            }
+        }
+    }
+
+    // The list rejects duplicates, every entry has to be inheritable while CreateProcessW runs
+    std::sort(inherit.begin(), inherit.end());
+    inherit.erase(std::unique(inherit.begin(), inherit.end()), inherit.end());
+
+    SpawnDetail::InheritScope scope;
+    for (auto const handle : inherit)
+    {
+        if (!scope.Add(handle))
+        {
+            return spawned;
+        }
+    }
+
+    // One attribute, 48 bytes on x64
+    alignas(std::max_align_t) std::array<std::byte, 128> attributes;
+    SIZE_T size = 0;
+    ::InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
+    if (size > attributes.size())
+    {
+        ::SetLastError(ERROR_INSUFFICIENT_BUFFER);
+        return spawned;
+    }
+
+    startup.lpAttributeList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributes.data());
+    if (!::InitializeProcThreadAttributeList(startup.lpAttributeList, 1, 0, &size))
+    {
+        return spawned;
+    }
+
+    // An empty list is invalid, inheritance is switched off instead
+    if (!inherit.empty()
+        && !::UpdateProcThreadAttribute(startup.lpAttributeList, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherit.data(),
+                                        inherit.size() * sizeof(HANDLE), nullptr, nullptr))
+    {
+        ::DeleteProcThreadAttributeList(startup.lpAttributeList);
+        return spawned;
+    }
+
+    DWORD const flags = EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | (options.m_Suspended ? CREATE_SUSPENDED : 0);
+
+    PROCESS_INFORMATION information{};
+    BOOL const created = ::CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, !inherit.empty(), flags, nullptr,
+                                          options.m_WorkingDirectory.empty() ? nullptr : options.m_WorkingDirectory.c_str(),
+                                          &startup.StartupInfo, &information);
+
+    DWORD const error = ::GetLastError();
+    ::DeleteProcThreadAttributeList(startup.lpAttributeList);
+    if (!created)
+    {
+        ::SetLastError(error);
+        return spawned;
+    }
+
+    spawned.m_Process.Reset(information.hProcess);
+    spawned.m_Thread.Reset(information.hThread);
+    spawned.m_ProcessId = information.dwProcessId;
+    return spawned;
+#else
+    SpawnDetail::SpawnAttributes spawn;
+
+    // Sources move above the target range first, so no dup2 overwrites a later source
+    int const firstFree = 3 + static_cast<int>(options.m_Inherit.size());
+    std::vector<FileHandle> sources;
+    sources.reserve(options.m_Inherit.size() + 3);
+
+    auto const map = [&](int source, int target) noexcept
+    {
+        sources.emplace_back(::fcntl(source, F_DUPFD_CLOEXEC, firstFree));
+        return sources.back().Valid() && ::posix_spawn_file_actions_adddup2(&spawn.m_Actions, sources.back().Get(), target) == 0;
+    };
+
+    int target = 0;
+    for (auto const standard : { options.m_Input, options.m_Output, options.m_Error })
+    {
+        if (standard && !map(*standard, target))
+        {
+            return spawned;
+        }
+
+        ++target;
+    }
+
+    for (auto const handle : options.m_Inherit)
+    {
+        if (!map(handle, target++))
+        {
+            return spawned;
+        }
+    }
+
+    if (::posix_spawn_file_actions_addclosefrom_np(&spawn.m_Actions, firstFree) != 0
+        || (!options.m_WorkingDirectory.empty()
+            && ::posix_spawn_file_actions_addchdir_np(&spawn.m_Actions, options.m_WorkingDirectory.c_str()) != 0))
+    {
+        return spawned;
+    }
+
+    // Workers may block signals, the child starts with none blocked
+    sigset_t mask;
+    sigemptyset(&mask);
+    ::posix_spawnattr_setsigmask(&spawn.m_Attributes, &mask);
+    ::posix_spawnattr_setflags(&spawn.m_Attributes, POSIX_SPAWN_SETSIGMASK);
+
+    std::vector<std::string> storage;
+    storage.reserve(options.m_Arguments.size());
+    std::vector<char*> arguments;
+    arguments.reserve(options.m_Arguments.size() + 2);
+
+    arguments.push_back(const_cast<char*>(options.m_Program.c_str()));
+    for (auto const argument : options.m_Arguments)
+    {
+        arguments.push_back(storage.emplace_back(argument).data());
+    }
+
+    arguments.push_back(nullptr);
+
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 39)
+    int pidfd = -1;
+    int const result = ::pidfd_spawnp(&pidfd, options.m_Program.c_str(), &spawn.m_Actions, &spawn.m_Attributes, arguments.data(), environ);
+    if (result != 0)
+    {
+        errno = result;
+        return spawned;
+    }
+
+    spawned.m_Process.Reset(pidfd);
+    spawned.m_ProcessId = static_cast<std::uint32_t>(::pidfd_getpid(pidfd));
+#else
+    pid_t pid = 0;
+    int const result = ::posix_spawnp(&pid, options.m_Program.c_str(), &spawn.m_Actions, &spawn.m_Attributes, arguments.data(), environ);
+    if (result != 0)
+    {
+        errno = result;
+        return spawned;
+    }
+
+    // An unreaped child keeps its pid, even after it exited
+    spawned.m_Process.Reset(static_cast<int>(::syscall(SYS_pidfd_open, pid, 0)));
+    spawned.m_ProcessId = static_cast<std::uint32_t>(pid);
+    if (!spawned.m_Process.Valid())
+    {
+        // Without a handle the child would be unreachable
+        int const error = errno;
+        int status      = 0;
+        ::kill(pid, SIGKILL);
+        ::waitpid(pid, &status, 0);
+        errno = error;
+    }
+#endif
+
+    return spawned;
+#endif
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include "handle.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/*
+ * @brief Thread-safe reference count for SharedHandle
+ *
+ * Increments are relaxed since a new reference can only be made from an existing one.
+ * Decrements release so that every use of the handle happens-before the final close,
+ * and the thread that drops the last reference acquires before closing.
+ */
+class AtomicRefCount
+{
+private:
+    std::atomic<std::uint32_t> m_Count;
+
+public:
+    explicit AtomicRefCount(std::uint32_t count) noexcept
+        : m_Count(count)
+    {}
+
+    void Increment() noexcept
+    {
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*
+     * @return true when the count dropped to zero
+     */
+    [[nodiscard]] bool Decrement() noexcept
+    {
+        if (m_Count.fetch_sub(1, std::memory_order_release) == 1)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        return false;
+    }
+
+    /*
+     * @brief Increments unless the count already reached zero, used to lock weak references
+     */
+    [[nodiscard]] bool IncrementIfNotZero() noexcept
+    {
+        auto count = m_Count.load(std::memory_order_relaxed);
+        while (count != 0)
+        {
+            if (m_Count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] std::uint32_t Load() const noexcept
+    {
+        return m_Count.load(std::memory_order_relaxed);
+    }
+};
+
+/*
+ * @brief Plain reference count for SharedHandle instances that never leave one thread
+ */
+class LocalRefCount
+{
+private:
+    std::uint32_t m_Count;
+
+public:
+    explicit LocalRefCount(std::uint32_t count) noexcept
+        : m_Count(count)
+    {}
+
+    void Increment() noexcept
+    {
+        ++m_Count;
+    }
+
+    [[nodiscard]] bool Decrement() noexcept
+    {
+        return --m_Count == 0;
+    }
+
+    [[nodiscard]] bool IncrementIfNotZero() noexcept
+    {
+        if (m_Count == 0)
+        {
+            return false;
+        }
+
+        ++m_Count;
+        return true;
+    }
+
+    [[nodiscard]] std::uint32_t Load() const noexcept
+    {
+        return m_Count;
+    }
+};
+
+template<typename _Ty, typename _RefCount>
+class WeakHandle;
+
+/*
+ * @brief Reference counted owner of a handle, closed through HandleTraits<_Ty> when the last owner goes away
+ *
+ * The handle value and both counts live in one control block allocated once per shared
+ * handle. Every SharedHandle also caches the value itself so `Get()` never touches the block.
+ * Strong references collectively hold one weak reference, the block is freed when the weak
+ * count reaches zero.
+ *
+ * @tparam Handle type
+ * @tparam AtomicRefCount (default) or LocalRefCount
+ */
+template<typename _Ty, typename _RefCount = AtomicRefCount>
+class SharedHandle
+{
+public:
+    using Traits = HandleTraits<_Ty>;
+    using Type   = typename HandleBaseType<_Ty>::Type;
+
+private:
+    friend class WeakHandle<_Ty, _RefCount>;
+
+    struct ControlBlock
+    {
+        _RefCount m_Strong{ 1 };
+        _RefCount m_Weak{ 1 };
+        Type      m_Handle;
+    };
+
+    ControlBlock* m_Block  = nullptr;
+    Type          m_Handle = Traits::InvalidHandleValue();
+
+    explicit SharedHandle(ControlBlock* block) noexcept
+        : m_Block(block)
+        , m_Handle(block->m_Handle)
+    {}
+
+public:
+    constexpr SharedHandle() noexcept = default;
+
+    /*
+     * @brief Takes shared ownership of `handle`
+     *
+     * Invalid handles do not allocate. If allocating the control block throws, `handle`
+     * keeps ownership and closes normally.
+     */
+    explicit SharedHandle(Handle<_Ty>&& handle)
+    {
+        if (handle.Valid())
+        {
+            m_Block  = new ControlBlock{ .m_Handle = handle.Get() };
+            m_Handle = handle.Release();
+        }
+    }
+
+    SharedHandle(SharedHandle const& other) noexcept
+        : m_Block(other.m_Block)
+        , m_Handle(other.m_Handle)
+    {
+        if (m_Block)
+        {
+            m_Block->m_Strong.Increment();
+        }
+    }
+
+    SharedHandle(SharedHandle&& other) noexcept
+        : m_Block(std::exchange(other.m_Block, nullptr))
+        , m_Handle(std::exchange(other.m_Handle, Traits::InvalidHandleValue()))
+    {}
+
+    SharedHandle& operator=(SharedHandle const& other) noexcept
+    {
+        SharedHandle(other).Swap(*this);
+        return *this;
+    }
+
+    SharedHandle& operator=(SharedHandle&& other) noexcept
+    {
+        SharedHandle(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    ~SharedHandle()
+    {
+        Reset();
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return Traits::Valid(m_Handle);
+    }
+
+    /*
+     * @brief Drops this reference, closing the handle if it was the last one
+     */
+    void Reset() noexcept
+    {
+        auto* block = std::exchange(m_Block, nullptr);
+        m_Handle = Traits::InvalidHandleValue();
+
+        if (block && block->m_Strong.Decrement())
+        {
+            Traits::Close(block->m_Handle);
+
+            if (block->m_Weak.Decrement())
+            {
+                delete block;
+            }
+        }
+    }
+
+    void Swap(SharedHandle& other) noexcept
+    {
+        std::swap(m_Block, other.m_Block);
+        std::swap(m_Handle, other.m_Handle);
+    }
+
+    /*
+     * @brief Number of strong references, only a hint when shared across threads
+     */
+    [[nodiscard]] std::uint32_t UseCount() const noexcept
+    {
+        return m_Block ? m_Block->m_Strong.Load() : 0;
+    }
+
+public:
+    // Mirrors Handle<_Ty>
+    [[nodiscard]] operator Type() const noexcept
+    {
+        return m_Handle;
+    }
+
+    [[nodiscard]] Type Get() const noexcept
+    {
+        return m_Handle;
+    }
+};
+
+template<typename _Ty>
+SharedHandle(Handle<_Ty>&&) -> SharedHandle<_Ty>;
+
+/*
+ * @brief Non-owning reference to a SharedHandle, `Lock()` yields an owner while the handle is still open
+ */
+template<typename _Ty, typename _RefCount = AtomicRefCount>
+class WeakHandle
+{
+private:
+    using Shared       = SharedHandle<_Ty, _RefCount>;
+    using ControlBlock = typename Shared::ControlBlock;
+
+    ControlBlock* m_Block = nullptr;
+
+public:
+    constexpr WeakHandle() noexcept = default;
+
+    WeakHandle(Shared const& shared) noexcept
+        : m_Block(shared.m_Block)
+    {
+        if (m_Block)
+        {
+            m_Block->m_Weak.Increment();
+        }
+    }
+
+    WeakHandle(WeakHandle const& other) noexcept
+        : m_Block(other.m_Block)
+    {
+        if (m_Block)
+        {
+            m_Block->m_Weak.Increment();
+        }
+    }
+
+    WeakHandle(WeakHandle&& other) noexcept
+        : m_Block(std::exchange(other.m_Block, nullptr))
+    {}
+
+    WeakHandle& operator=(WeakHandle const& other) noexcept
+    {
+        WeakHandle(other).Swap(*this);
+        return *this;
+    }
+
+    WeakHandle& operator=(WeakHandle&& other) noexcept
+    {
+        WeakHandle(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    ~WeakHandle()
+    {
+        Reset();
+    }
+
+public:
+    [[nodiscard]] Shared Lock() const noexcept
+    {
+        if (m_Block && m_Block->m_Strong.IncrementIfNotZero())
+        {
+            return Shared(m_Block);
+        }
+
+        return Shared();
+    }
+
+    [[nodiscard]] bool Expired() const noexcept
+    {
+        return !m_Block || m_Block->m_Strong.Load() == 0;
+    }
+
+    void Reset() noexcept
+    {
+        auto* block = std::exchange(m_Block, nullptr);
+        if (block && block->m_Weak.Decrement())
+        {
+            delete block;
+        }
+    }
+
+    void Swap(WeakHandle& other) noexcept
+    {
+        std::swap(m_Block, other.m_Block);
+    }
+};
+
+template<typename _Ty, typename _RefCount>
+WeakHandle(SharedHandle<_Ty, _RefCount> const&) -> WeakHandle<_Ty, _RefCount>;
+
+/*
+ * @brief SharedHandle/WeakHandle with a non-atomic count, for handles confined to a single thread
+ */
+template<typename _Ty>
+using LocalSharedHandle = SharedHandle<_Ty, LocalRefCount>;
+
+template<typename _Ty>
+using LocalWeakHandle = WeakHandle<_Ty, LocalRefCount>;
@@ -0,0 +1,603 @@
+#pragma once
+#include "handle.hpp"
+#include "mapped_view.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * @brief Whether one or several producers send into a SharedRing
+ */
+enum class RingProducers : std::uint32_t
+{
+    Single = 1,
+    Multiple,
+};
+
+namespace SharedRingDetail
+{
+    inline constexpr std::uint32_t Magic = 0x474e4952; // "RING"
+
+    /*
+     * @brief Control block at the start of the shared region, the messages follow it
+     *
+     * Positions are byte offsets that only grow, the ring index is position & (capacity - 1).
+     */
+    struct Header
+    {
+        alignas(64) std::atomic<std::uint64_t> m_Head;
+        alignas(64) std::atomic<std::uint64_t> m_Tail;
+        // Futex word on Linux, 1 while the consumer sleeps or is about to
+        alignas(64) std::atomic<std::uint32_t> m_Sleeping;
+        alignas(64) std::atomic<std::uint32_t> m_Magic;
+        RingProducers                          m_Producers;
+        std::uint64_t                          m_Capacity;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+                  "the control block is shared between processes");
+
+    // Record header: payload length << 32 | kind, 0 while a record is not committed yet
+    inline constexpr std::size_t   RecordHeaderSize = sizeof(std::uint64_t);
+    inline constexpr std::uint64_t MessageRecord    = 1;
+    inline constexpr std::uint64_t PaddingRecord    = 2;
+
+    [[nodiscard]] constexpr std::size_t RecordSize(std::size_t payload) noexcept
+    {
+        return (RecordHeaderSize + payload + 7) & ~std::size_t(7);
+    }
+
+    [[nodiscard]] constexpr std::size_t RegionSize(std::size_t capacity) noexcept
+    {
+        return sizeof(Header) + capacity;
+    }
+}
+
+/*
+ * @brief Message ring between processes in a named shared memory region
+ *
+ * The region holds a control block with the head, the tail and the sleep flag on separate
+ * cache lines, followed by `capacity` bytes of 8-byte aligned records. Each record is a
+ * length header and the payload. A record that would straddle the end of the ring is
+ * preceded by a padding record and written at the start instead, so every message is one
+ * contiguous span that TryReceive() hands out in place.
+ *
+ * Single: the producer publishes records by storing the head, and each side caches the other
+ * side's index and only rereads it when it seems to be out of space or messages.
+ * Multiple: producers reserve space with a CAS on the head and commit each record by storing
+ * its header last. The consumer stops at the first uncommitted header and zeroes what it
+ * consumed, so stale bytes never look like a committed header.
+ *
+ * The consumer sleeps only when it found the ring empty. Producers then see the sleep flag
+ * and wake it through a named auto-reset EventHandle on Windows, or a futex on the flag
+ * itself on Linux, since an eventfd cannot be opened by name from another process. A busy
+ * consumer costs producers one load of the flag.
+ *
+ * One process creates the ring, any number open it by name. The creator unlinks the name on
+ * Linux when it is destroyed; processes that opened it keep their mapping.
+ *
+ * @tparam Single or multiple producers, must match between the creator and the openers
+ */
+template<RingProducers _Producers>
+class SharedRing
+{
+public:
+    static constexpr std::size_t   DefaultCapacity = 1 << 20;
+    static constexpr std::uint32_t Infinite        = std::numeric_limits<std::uint32_t>::max();
+
+private:
+    // Polls made before the consumer goes to sleep
+    static constexpr int IdleSpins = 64;
+
+    using Header = SharedRingDetail::Header;
+
+    MappedView    m_View;
+    Header*       m_Header   = nullptr;
+    std::byte*    m_Data     = nullptr;
+    std::uint64_t m_Capacity = 0;
+#if defined(_WIN32)
+    EventHandle   m_Wake;
+#else
+    std::string   m_Unlink;
+#endif
+
+    // Single only, the last seen index of the other side
+    std::uint64_t m_CachedTail = 0;
+    std::uint64_t m_CachedHead = 0;
+
+public:
+    SharedRing() noexcept = default;
+
+    /*
+     * @brief Creates the ring `name`
+     *
+     * On Linux a leftover ring of that name is unlinked and a new object created in its place,
+     * processes still mapping the old one keep it. On Windows creation fails while another
+     * ring of that name is open.
+     *
+     * @param ASCII name, `Local\name` on Windows and `/name` under /dev/shm on Linux
+     * @param Bytes of records, rounded up to a power of two, at least 4KB
+     */
+    SharedRing(std::string_view name, std::size_t capacity) noexcept
+    {
+        capacity = std::bit_ceil(std::max<std::size_t>(capacity, 4096));
+        auto const size = SharedRingDetail::RegionSize(capacity);
+
+#if defined(_WIN32)
+        auto const native = NativeName(name);
+
+        FileMappingHandle mapping(::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                                       static_cast<DWORD>(std::uint64_t(size) >> 32), static_cast<DWORD>(size),
+                                                       native.c_str()));
+
+        // A live ring of that name, Windows removes stale ones with their last handle
+        if (::GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            return;
+        }
+
+        m_Wake.Reset(::CreateEventW(nullptr, FALSE, FALSE, (native + L".wake").c_str()));
+        if (!mapping.Valid() || !m_Wake.Valid())
+        {
+            return;
+        }
+#else
+        auto native = NativeName(name);
+
+        // O_TRUNC would shrink a ring others still map under their feet, a fresh object is
+        // sized before the magic is published, openers check its size before mapping it
+        ::shm_unlink(native.c_str());
+        FileMappingHandle mapping(::shm_open(native.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600));
+        if (!mapping.Valid())
+        {
+            return;
+        }
+
+        m_Unlink = std::move(native);
+        if (::ftruncate(mapping, static_cast<off_t>(size)) != 0)
+        {
+            return;
+        }
+#endif
+
+        m_View = MappedView(mapping, 0, size, MapAccess::ReadWrite);
+        if (!m_View.Valid())
+        {
+            return;
+        }
+
+        auto* header = ::new (m_View.WritableData()) Header{};
+        header->m_Producers = _Producers;
+        header->m_Capacity  = capacity;
+        header->m_Magic.store(SharedRingDetail::Magic, std::memory_order_release);
+
+        Attach(header, capacity);
+    }
+
+    /*
+     * @brief Opens the ring `name` created by another SharedRing with the same producer mode
+     */
+    explicit SharedRing(std::string_view name) noexcept
+    {
+#if defined(_WIN32)
+        auto const native = NativeName(name);
+
+        FileMappingHandle mapping(::OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, native.c_str()));
+        m_Wake.Reset(::OpenEventW(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, (native + L".wake").c_str()));
+        if (!mapping.Valid() || !m_Wake.Valid())
+        {
+            return;
+        }
+#else
+        FileMappingHandle mapping(::shm_open(NativeName(name).c_str(), O_RDWR | O_CLOEXEC, 0));
+
+        // The creator may not have sized the object yet, mapping past its end raises SIGBUS
+        struct stat status;
+        if (!mapping.Valid() || ::fstat(mapping, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(Header))
+        {
+            return;
+        }
+#endif
+
+        // The control block tells the capacity, then the whole region is mapped
+        MappedView control(mapping, 0, sizeof(Header), MapAccess::ReadWrite);
+        if (!control.Valid())
+        {
+            return;
+        }
+
+        auto const* header = reinterpret_cast<Header const*>(control.Data());
+        if (header->m_Magic.load(std::memory_order_acquire) != SharedRingDetail::Magic || header->m_Producers != _Producers
+            || !std::has_single_bit(header->m_Capacity))
+        {
+            return;
+        }
+
+        auto const capacity = header->m_Capacity;
+#if !defined(_WIN32)
+        if (static_cast<std::size_t>(status.st_size) < SharedRingDetail::RegionSize(static_cast<std::size_t>(capacity)))
+        {
+            return;
+        }
+#endif
+
+        m_View = MappedView(mapping, 0, SharedRingDetail::RegionSize(static_cast<std::size_t>(capacity)), MapAccess::ReadWrite);
+        if (m_View.Valid())
+        {
+            Attach(reinterpret_cast<Header*>(m_View.WritableData()), capacity);
+        }
+    }
+
+    SharedRing(SharedRing&& other) noexcept
+        : m_View(std::move(other.m_View))
+        , m_Header(std::exchange(other.m_Header, nullptr))
+        , m_Data(std::exchange(other.m_Data, nullptr))
+        , m_Capacity(std::exchange(other.m_Capacity, 0))
+#if defined(_WIN32)
+        , m_Wake(std::move(other.m_Wake))
+#else
+        , m_Unlink(std::move(other.m_Unlink))
+#endif
+        , m_CachedTail(other.m_CachedTail)
+        , m_CachedHead(other.m_CachedHead)
+    {
+#if !defined(_WIN32)
+        other.m_Unlink.clear();
+#endif
+    }
+
+    SharedRing& operator=(SharedRing&& other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+#if defined(_WIN32)
+            m_Wake = std::move(other.m_Wake);
+#else
+            if (!m_Unlink.empty())
+            {
+                ::shm_unlink(m_Unlink.c_str());
+            }
+
+            m_Unlink = std::exchange(other.m_Unlink, {});
+#endif
+            m_View       = std::move(other.m_View);
+            m_Header     = std::exchange(other.m_Header, nullptr);
+            m_Data       = std::exchange(other.m_Data, nullptr);
+            m_Capacity   = std::exchange(other.m_Capacity, 0);
+            m_CachedTail = other.m_CachedTail;
+            m_CachedHead = other.m_CachedHead;
+        }
+
+        return *this;
+    }
+
+    SharedRing(SharedRing const&) = delete;
+    SharedRing& operator=(SharedRing const&) = delete;
+
+    ~SharedRing()
+    {
+#if !defined(_WIN32)
+        if (!m_Unlink.empty())
+        {
+            ::shm_unlink(m_Unlink.c_str());
+        }
+#endif
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Header != nullptr;
+    }
+
+    [[nodiscard]] std::size_t Capacity() const noexcept
+    {
+        return static_cast<std::size_t>(m_Capacity);
+    }
+
+    /*
+     * @brief Largest message the ring takes, a quarter of the capacity so a full-size message never waits for the ring to drain completely
+     */
+    [[nodiscard]] std::size_t MaxMessageSize() const noexcept
+    {
+        return static_cast<std::size_t>(m_Capacity / 4) - SharedRingDetail::RecordHeaderSize;
+    }
+
+    /*
+     * @brief Copies `message` into the ring, false when it is full or the message is empty or too large
+     */
+    bool TrySend(std::span<std::byte const> message) noexcept
+    {
+        using namespace SharedRingDetail;
+
+        if (message.empty() || message.size() > MaxMessageSize())
+        {
+            return false;
+        }
+
+        auto const record = RecordSize(message.size());
+
+        std::uint64_t head;
+        std::uint64_t needed;
+        if constexpr (_Producers == RingProducers::Single)
+        {
+            head   = m_Header->m_Head.load(std::memory_order_relaxed);
+            needed = Needed(head, record);
+
+            if (head + needed - m_CachedTail > m_Capacity)
+            {
+                m_CachedTail = m_Header->m_Tail.load(std::memory_order_acquire);
+                if (head + needed - m_CachedTail > m_Capacity)
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            head = m_Header->m_Head.load(std::memory_order_relaxed);
+            do
+            {
+                needed = Needed(head, record);
+                if (head + needed - m_Header->m_Tail.load(std::memory_order_acquire) > m_Capacity)
+                {
+                    return false;
+                }
+            } while (!m_Header->m_Head.compare_exchange_weak(head, head + needed, std::memory_order_relaxed));
+        }
+
+        auto index = static_cast<std::size_t>(head & (m_Capacity - 1));
+        if (needed != record)
+        {
+            Commit(index, (needed - record - RecordHeaderSize) << 32 | PaddingRecord);
+            index = 0;
+        }
+
+        std::memcpy(m_Data + index + RecordHeaderSize, message.data(), message.size());
+        Commit(index, std::uint64_t(message.size()) << 32 | MessageRecord);
+
+        if constexpr (_Producers == RingProducers::Single)
+        {
+            m_Header->m_Head.store(head + needed, std::memory_order_release);
+        }
+
+        WakeConsumer();
+        return true;
+    }
+
+    /*
+     * @brief Copies `message` into the ring, yielding while it is full
+     *
+     * @return false only for an empty or too large message
+     */
+    bool Send(std::span<std::byte const> message) noexcept
+    {
+        if (message.empty() || message.size() > MaxMessageSize())
+        {
+            return false;
+        }
+
+        while (!TrySend(message))
+        {
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+    /*
+     * @brief Hands every message available right now to `consumer(std::span<std::byte const>)`, in place
+     *
+     * The span is only valid during the call. The space is released to the producers once all
+     * of them were consumed. Single consumer only.
+     *
+     * @return Number of messages consumed
+     */
+    template<typename _Consumer>
+    std::size_t TryReceive(_Consumer&& consumer) noexcept
+    {
+        using namespace SharedRingDetail;
+
+        auto const start = m_Header->m_Tail.load(std::memory_order_relaxed);
+        auto tail        = start;
+
+        std::size_t consumed = 0;
+        for (;;)
+        {
+            if constexpr (_Producers == RingProducers::Single)
+            {
+                if (tail == m_CachedHead)
+                {
+                    m_CachedHead = m_Header->m_Head.load(std::memory_order_acquire);
+                    if (tail == m_CachedHead)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            auto const index  = static_cast<std::size_t>(tail & (m_Capacity - 1));
+            auto const header = std::atomic_ref(*reinterpret_cast<std::uint64_t*>(m_Data + index)).load(std::memory_order_acquire);
+            if (header == 0)
+            {
+                break;
+            }
+
+            auto const length = static_cast<std::size_t>(header >> 32);
+            auto const record = RecordSize(length);
+            if ((header & 0xffffffff) == MessageRecord)
+            {
+                consumer(std::span<std::byte const>(m_Data + index + RecordHeaderSize, length));
+                ++consumed;
+            }
+
+            if constexpr (_Producers == RingProducers::Multiple)
+            {
+                std::memset(m_Data + index, 0, record);
+            }
+
+            tail += record;
+        }
+
+        if (tail != start)
+        {
+            m_Header->m_Tail.store(tail, std::memory_order_release);
+        }
+
+        return consumed;
+    }
+
+    /*
+     * @brief TryReceive() that waits for messages, polling briefly before sleeping
+     *
+     * @return Number of messages consumed, 0 once `timeoutMs` elapsed
+     */
+    template<typename _Consumer>
+    std::size_t Receive(_Consumer&& consumer, std::uint32_t timeoutMs = Infinite) noexcept
+    {
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        for (int spin = 0;; ++spin)
+        {
+            if (auto const consumed = TryReceive(consumer); consumed != 0)
+            {
+                return consumed;
+            }
+
+            if (spin < IdleSpins)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::uint32_t remaining = Infinite;
+            if (timeoutMs != Infinite)
+            {
+                auto const left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0)
+                {
+                    return 0;
+                }
+
+                remaining = static_cast<std::uint32_t>(left);
+            }
+
+            // Pairs with the fence in WakeConsumer(), either the producer sees the flag or we see its message
+            m_Header->m_Sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!Empty())
+            {
+                m_Header->m_Sleeping.store(0, std::memory_order_relaxed);
+                continue;
+            }
+
+            Sleep(remaining);
+            m_Header->m_Sleeping.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+#if defined(_WIN32)
+    [[nodiscard]] static std::wstring NativeName(std::string_view name)
+    {
+        return L"Local\\" + std::wstring(name.begin(), name.end());
+    }
+#else
+    [[nodiscard]] static std::string NativeName(std::string_view name)
+    {
+        return "/" + std::string(name);
+    }
+#endif
+
+    void Attach(Header* header, std::uint64_t capacity) noexcept
+    {
+        m_Header     = header;
+        m_Data       = reinterpret_cast<std::byte*>(header) + sizeof(Header);
+        m_Capacity   = capacity;
+        m_CachedTail = header->m_Tail.load(std::memory_order_acquire);
+        m_CachedHead = header->m_Head.load(std::memory_order_acquire);
+    }
+
+    /*
+     * @brief Bytes a record of `record` bytes takes at `head`, including the padding up to the end of the ring
+     */
+    [[nodiscard]] std::uint64_t Needed(std::uint64_t head, std::size_t record) const noexcept
+    {
+        auto const contiguous = m_Capacity - (head & (m_Capacity - 1));
+        return record <= contiguous ? record : contiguous + record;
+    }
+
+    void Commit(std::size_t index, std::uint64_t header) noexcept
+    {
+        std::atomic_ref(*reinterpret_cast<std::uint64_t*>(m_Data + index)).store(header, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool Empty() const noexcept
+    {
+        auto const tail = m_Header->m_Tail.load(std::memory_order_relaxed);
+        if constexpr (_Producers == RingProducers::Single)
+        {
+            return m_Header->m_Head.load(std::memory_order_acquire) == tail;
+        }
+        else
+        {
+            auto const index = static_cast<std::size_t>(tail & (m_Capacity - 1));
+            return std::atomic_ref(*reinterpret_cast<std::uint64_t*>(m_Data + index)).load(std::memory_order_acquire) == 0;
+        }
+    }
+
+    void WakeConsumer() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Header->m_Sleeping.load(std::memory_order_relaxed) == 0 || m_Header->m_Sleeping.exchange(0) == 0)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        ::SetEvent(m_Wake);
+#else
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(std::addressof(m_Header->m_Sleeping)), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    void Sleep(std::uint32_t timeoutMs) noexcept
+    {
+#if defined(_WIN32)
+        ::WaitForSingleObject(m_Wake, timeoutMs == Infinite ? INFINITE : timeoutMs);
+#else
+        timespec timeout{ static_cast<time_t>(timeoutMs / 1000), static_cast<long>(timeoutMs % 1000) * 1'000'000 };
+
+        // Returns right away if a producer already cleared the flag
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(std::addressof(m_Header->m_Sleeping)), FUTEX_WAIT, 1,
+                  timeoutMs == Infinite ? nullptr : &timeout, nullptr, 0);
+#endif
+    }
+};
+
+using SpscRing = SharedRing<RingProducers::Single>;
+using MpscRing = SharedRing<RingProducers::Multiple>;
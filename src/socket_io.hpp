@@ -0,0 +1,325 @@
+#pragma once
+#include "handle.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(_WIN32)
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+/*
+ * @brief Native scatter/gather element, WSABUF on Windows and iovec on Linux
+ *
+ * Batched calls hand arrays of these to the kernel as they are, without copying.
+ */
+#if defined(_WIN32)
+using SocketBuffer = WSABUF;
+using SocketLength = int;
+#else
+using SocketBuffer = iovec;
+using SocketLength = socklen_t;
+#endif
+
+[[nodiscard]] inline SocketBuffer MakeSocketBuffer(void const* data, std::size_t size) noexcept
+{
+    SocketBuffer buffer;
+#if defined(_WIN32)
+    buffer.buf = static_cast<CHAR*>(const_cast<void*>(data));
+    buffer.len = static_cast<ULONG>(size);
+#else
+    buffer.iov_base = const_cast<void*>(data);
+    buffer.iov_len  = size;
+#endif
+    return buffer;
+}
+
+/*
+ * @brief One datagram of SendDatagrams() / ReceiveDatagrams()
+ *
+ * `m_Address` is the destination when sending (unused on connected sockets, leave
+ * `m_AddressLength` at 0) and receives the source when receiving. `m_Size` receives the
+ * number of bytes transferred.
+ */
+struct Datagram
+{
+    SocketBuffer     m_Buffer{};
+    sockaddr_storage m_Address{};
+    SocketLength     m_AddressLength = 0;
+    std::size_t      m_Size = 0;
+};
+
+/*
+ * @brief Calls WSAStartup once per process, always true on Linux
+ */
+[[nodiscard]] inline bool SocketStartup() noexcept
+{
+#if defined(_WIN32)
+    static bool const started = []
+    {
+        WSADATA data;
+        return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+
+    return started;
+#else
+    return true;
+#endif
+}
+
+/*
+ * @brief Sends `buffers` as one gathered write (WSASend / sendmsg)
+ *
+ * @return bytes sent or -error
+ */
+[[nodiscard]] inline std::int64_t SocketSend(SocketHandle const& socket, std::span<SocketBuffer const> buffers) noexcept
+{
+#if defined(_WIN32)
+    DWORD sent = 0;
+    if (::WSASend(socket.Get(), const_cast<SocketBuffer*>(buffers.data()), static_cast<DWORD>(buffers.size()), &sent, 0, nullptr, nullptr) != 0)
+    {
+        return -::WSAGetLastError();
+    }
+
+    return sent;
+#else
+    msghdr message{};
+    message.msg_iov    = const_cast<SocketBuffer*>(buffers.data());
+    message.msg_iovlen = buffers.size();
+
+    ssize_t sent;
+    do
+    {
+        sent = ::sendmsg(socket.Get(), &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    return sent < 0 ? -errno : sent;
+#endif
+}
+
+/*
+ * @brief Receives into `buffers` with one scattered read (WSARecv / recvmsg)
+ *
+ * @return bytes received, 0 at end of stream, or -error
+ */
+[[nodiscard]] inline std::int64_t SocketReceive(SocketHandle const& socket, std::span<SocketBuffer const> buffers) noexcept
+{
+#if defined(_WIN32)
+    DWORD received = 0;
+    DWORD flags    = 0;
+    if (::WSARecv(socket.Get(), const_cast<SocketBuffer*>(buffers.data()), static_cast<DWORD>(buffers.size()), &received, &flags, nullptr, nullptr) != 0)
+    {
+        return -::WSAGetLastError();
+    }
+
+    return received;
+#else
+    msghdr message{};
+    message.msg_iov    = const_cast<SocketBuffer*>(buffers.data());
+    message.msg_iovlen = buffers.size();
+
+    ssize_t received;
+    do
+    {
+        received = ::recvmsg(socket.Get(), &message, 0);
+    } while (received < 0 && errno == EINTR);
+
+    return received < 0 ? -errno : received;
+#endif
+}
+
+namespace SocketDetail
+{
+#if !defined(_WIN32)
+    // mmsghdr array kept on the stack per kernel call
+    constexpr std::size_t BatchChunk = 64;
+
+    inline void Prepare(mmsghdr& message, Datagram& datagram, bool receiving) noexcept
+    {
+        message = {};
+        message.msg_hdr.msg_iov    = &datagram.m_Buffer;
+        message.msg_hdr.msg_iovlen = 1;
+
+        if (receiving || datagram.m_AddressLength != 0)
+        {
+            message.msg_hdr.msg_name    = &datagram.m_Address;
+            message.msg_hdr.msg_namelen = receiving ? sizeof(datagram.m_Address) : static_cast<socklen_t>(datagram.m_AddressLength);
+        }
+    }
+#endif
+}
+
+/*
+ * @brief Sends each datagram as a separate message, in order
+ *
+ * Linux submits up to 64 datagrams per sendmmsg call. Windows has no batched datagram send
+ * for regular sockets, so this is one WSASendTo per datagram there.
+ *
+ * @return number of datagrams sent, or -error if the first one failed
+ */
+[[nodiscard]] inline std::int64_t SendDatagrams(SocketHandle const& socket, std::span<Datagram> datagrams) noexcept
+{
+    std::size_t sent = 0;
+
+#if defined(_WIN32)
+    for (; sent < datagrams.size(); ++sent)
+    {
+        auto& datagram = datagrams[sent];
+        auto const* address = datagram.m_AddressLength != 0 ? reinterpret_cast<sockaddr const*>(&datagram.m_Address) : nullptr;
+
+        DWORD bytes = 0;
+        if (::WSASendTo(socket.Get(), &datagram.m_Buffer, 1, &bytes, 0, address, datagram.m_AddressLength, nullptr, nullptr) != 0)
+        {
+            if (sent == 0)
+            {
+                return -::WSAGetLastError();
+            }
+
+            break;
+        }
+
+        datagram.m_Size = bytes;
+    }
+#else
+    mmsghdr messages[SocketDetail::BatchChunk];
+
+    while (sent < datagrams.size())
+    {
+        auto const count = std::min(datagrams.size() - sent, SocketDetail::BatchChunk);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            SocketDetail::Prepare(messages[i], datagrams[sent + i], false);
+        }
+
+        auto const result = ::sendmmsg(socket.Get(), messages, static_cast<unsigned>(count), MSG_NOSIGNAL);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (sent == 0)
+            {
+                return -errno;
+            }
+
+            break;
+        }
+
+        for (int i = 0; i < result; ++i)
+        {
+            datagrams[sent + i].m_Size = messages[i].msg_len;
+        }
+
+        sent += static_cast<std::size_t>(result);
+        if (static_cast<std::size_t>(result) < count)
+        {
+            break;
+        }
+    }
+#endif
+
+    return static_cast<std::int64_t>(sent);
+}
+
+/*
+ * @brief Receives up to `datagrams.size()` datagrams, one per element
+ *
+ * With `wait` the call blocks until the first datagram arrives (on a blocking socket) and
+ * then takes only what is already queued; without it nothing blocks. Linux uses recvmmsg
+ * with MSG_WAITFORONE, Windows checks FIONREAD between WSARecvFrom calls.
+ *
+ * @return number of datagrams received, or -error if none were (e.g. would block)
+ */
+[[nodiscard]] inline std::int64_t ReceiveDatagrams(SocketHandle const& socket, std::span<Datagram> datagrams, bool wait = true) noexcept
+{
+    std::size_t received = 0;
+
+#if defined(_WIN32)
+    for (; received < datagrams.size(); ++received)
+    {
+        if (received != 0 || !wait)
+        {
+            u_long pending = 0;
+            if (::ioctlsocket(socket.Get(), FIONREAD, &pending) != 0 || pending == 0)
+            {
+                if (received == 0)
+                {
+                    return -WSAEWOULDBLOCK;
+                }
+
+                break;
+            }
+        }
+
+        auto& datagram = datagrams[received];
+        datagram.m_AddressLength = sizeof(datagram.m_Address);
+
+        DWORD bytes = 0;
+        DWORD flags = 0;
+        if (::WSARecvFrom(socket.Get(), &datagram.m_Buffer, 1, &bytes, &flags, reinterpret_cast<sockaddr*>(&datagram.m_Address),
+                          &datagram.m_AddressLength, nullptr, nullptr) != 0)
+        {
+            if (received == 0)
+            {
+                return -::WSAGetLastError();
+            }
+
+            break;
+        }
+
+        datagram.m_Size = bytes;
+    }
+#else
+    mmsghdr messages[SocketDetail::BatchChunk];
+
+    while (received < datagrams.size())
+    {
+        auto const count = std::min(datagrams.size() - received, SocketDetail::BatchChunk);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            SocketDetail::Prepare(messages[i], datagrams[received + i], true);
+        }
+
+        // Only the first call may block
+        auto const flags  = wait && received == 0 ? MSG_WAITFORONE : MSG_DONTWAIT;
+        auto const result = ::recvmmsg(socket.Get(), messages, static_cast<unsigned>(count), flags, nullptr);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (received == 0)
+            {
+                return -errno;
+            }
+
+            break;
+        }
+
+        for (int i = 0; i < result; ++i)
+        {
+            auto& datagram = datagrams[received + i];
+            datagram.m_Size          = messages[i].msg_len;
+            datagram.m_AddressLength = static_cast<SocketLength>(messages[i].msg_hdr.msg_namelen);
+        }
+
+        received += static_cast<std::size_t>(result);
+        if (static_cast<std::size_t>(result) < count)
+        {
+            break;
+        }
+    }
+#endif
+
+    return static_cast<std::int64_t>(received);
+}
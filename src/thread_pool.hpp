@@ -0,0 +1,661 @@
+#pragma once
+#include "handle.hpp"
+#include "completion_engine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class TaskGroup;
+
+/*
+ * @brief Unit of work for a ThreadPool, owned by the submitter until it ran
+ *
+ * Tasks are intrusive so that submitting never allocates: fork-join code keeps them on the
+ * stack of the forking frame, and a full worker deque spills into the pool's shared list.
+ */
+struct PoolTask
+{
+    void      (*m_Run)(PoolTask& task) noexcept = nullptr;
+    void*       m_Context = nullptr;
+    TaskGroup*  m_Group   = nullptr;
+    PoolTask*   m_Next    = nullptr;
+};
+
+/*
+ * @brief Chase-Lev work-stealing deque of `_Ty*`
+ *
+ * The owner pushes and pops at the bottom, LIFO for locality, other threads steal the oldest
+ * entry at the top. Orderings follow Le, Pop, Cohen and Zappa Nardelli, "Correct and
+ * Efficient Work-Stealing for Weak Memory Models". The array is sized once at construction
+ * and never grows, Push() refuses items once it is full.
+ */
+template<typename _Ty>
+class WorkStealingDeque
+{
+private:
+    alignas(64) std::atomic<std::int64_t> m_Top    = 0;
+    alignas(64) std::atomic<std::int64_t> m_Bottom = 0;
+    alignas(64) std::int64_t              m_Capacity;
+    std::unique_ptr<std::atomic<_Ty*>[]>  m_Slots;
+
+public:
+    static constexpr std::int64_t DefaultCapacity = 1024;
+
+    /*
+     * @param Number of slots, rounded up to a power of two
+     */
+    explicit WorkStealingDeque(std::int64_t capacity = DefaultCapacity)
+        : m_Capacity(static_cast<std::int64_t>(std::bit_ceil(static_cast<std::uint64_t>(std::max<std::int64_t>(capacity, 2)))))
+        , m_Slots(std::make_unique<std::atomic<_Ty*>[]>(static_cast<std::size_t>(m_Capacity)))
+    {}
+
+    WorkStealingDeque(WorkStealingDeque const&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+    /*
+     * @brief Owner only, false when the deque is full
+     */
+    [[nodiscard]] bool Push(_Ty* item) noexcept
+    {
+        auto const bottom = m_Bottom.load(std::memory_order_relaxed);
+        auto const top    = m_Top.load(std::memory_order_acquire);
+
+        if (bottom - top > m_Capacity - 1)
+        {
+            return false;
+        }
+
+        Put(bottom, item);
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * @brief Owner only, the most recently pushed item or nullptr
+     */
+    [[nodiscard]] _Ty* Pop() noexcept
+    {
+        auto const bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto top = m_Top.load(std::memory_order_relaxed);
+        if (top > bottom)
+        {
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto* item = Get(bottom);
+        if (top == bottom)
+        {
+            // Last item, race the thieves for it
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                item = nullptr;
+            }
+
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    /*
+     * @brief Any thread, the oldest item or nullptr when empty or another thread won it
+     */
+    [[nodiscard]] _Ty* Steal() noexcept
+    {
+        auto top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const bottom = m_Bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        auto* item = Get(top);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+    [[nodiscard]] bool Empty() const noexcept
+    {
+        return m_Bottom.load(std::memory_order_acquire) <= m_Top.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::int64_t Capacity() const noexcept
+    {
+        return m_Capacity;
+    }
+
+private:
+    [[nodiscard]] _Ty* Get(std::int64_t index) const noexcept
+    {
+        return m_Slots[static_cast<std::size_t>(index & (m_Capacity - 1))].load(std::memory_order_relaxed);
+    }
+
+    void Put(std::int64_t index, _Ty* item) noexcept
+    {
+        m_Slots[static_cast<std::size_t>(index & (m_Capacity - 1))].store(item, std::memory_order_relaxed);
+    }
+};
+
+/*
+ * @brief Whether ThreadPool workers are pinned, worker i to the i-th processor the process may run on
+ */
+enum class ThreadAffinity
+{
+    None,
+    PinToCores,
+};
+
+/*
+ * @brief Work-stealing executor owning its worker threads
+ *
+ * Every worker has a fixed-size WorkStealingDeque. Tasks submitted from a worker go to its
+ * own deque, or to a shared FIFO once that is full; other threads submit into the FIFO.
+ * An idle worker takes, in order: its own newest task, the oldest shared one, then steals
+ * the oldest task of the other workers, starting at a random victim. Workers with nothing to do sleep on an epoch counter, and submitting
+ * wakes one only when some are asleep (Dekker-style fences on both sides).
+ *
+ * With a CompletionEngine the workers sleep in RunOnce() instead, so I/O completion
+ * callbacks run on the pool and can submit continuations straight into a worker deque.
+ * Busy workers also poll the engine every `EnginePollInterval` tasks. The engine must not
+ * be Start()ed then, the pool drives it.
+ *
+ * Windows: workers are ThreadHandles from CreateThread, pinned with SetThreadAffinityMask
+ * while still suspended. Linux has no thread handle, workers are pthreads created with an
+ * affinity attribute (pthread_attr_setaffinity_np).
+ */
+class ThreadPool
+{
+public:
+    static constexpr std::size_t EnginePollInterval = 64;
+
+private:
+    struct alignas(64) Worker
+    {
+        ThreadPool*                 m_Pool     = nullptr;
+        unsigned                    m_Index    = 0;
+        std::uint32_t               m_Seed     = 0;
+        std::size_t                 m_Executed = 0;
+        WorkStealingDeque<PoolTask> m_Deque;
+#if defined(_WIN32)
+        ThreadHandle                m_Thread;
+#else
+        pthread_t                   m_Thread{};
+        bool                        m_Started = false;
+#endif
+    };
+
+    unsigned                  m_WorkerCount;
+    std::unique_ptr<Worker[]> m_Workers;
+    CompletionEngine*         m_Engine;
+    unsigned                  m_Started = 0;
+
+    std::mutex                m_SharedLock;
+    PoolTask*                 m_SharedHead = nullptr;
+    PoolTask*                 m_SharedTail = nullptr;
+    std::atomic<std::size_t>  m_SharedCount = 0;
+
+    alignas(64) std::atomic<std::uint32_t> m_Epoch       = 0;
+    std::atomic<std::uint32_t>             m_Sleepers    = 0;
+    std::atomic<bool>                      m_WakePending = false;
+    std::atomic<bool>                      m_Stop        = false;
+
+public:
+    /*
+     * @param Number of workers, 0 means one per hardware thread
+     * @param Whether to pin each worker to its own processor
+     * @param Engine whose completions the workers run while idle, nullptr for none
+     */
+    explicit ThreadPool(unsigned workers = 0, ThreadAffinity affinity = ThreadAffinity::PinToCores, CompletionEngine* engine = nullptr)
+        : m_WorkerCount(workers ? workers : std::max(1u, std::thread::hardware_concurrency()))
+        , m_Workers(std::make_unique<Worker[]>(m_WorkerCount))
+        , m_Engine(engine)
+    {
+        for (unsigned i = 0; i < m_WorkerCount; ++i)
+        {
+            auto& worker   = m_Workers[i];
+            worker.m_Pool  = this;
+            worker.m_Index = i;
+            worker.m_Seed  = 0x9e3779b9u * (i + 1);
+        }
+
+        for (; m_Started < m_WorkerCount; ++m_Started)
+        {
+            if (!StartWorker(m_Workers[m_Started], affinity))
+            {
+                break;
+            }
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /*
+     * @brief Runs every task still queued, then joins the workers
+     */
+    ~ThreadPool()
+    {
+        m_Stop.store(true, std::memory_order_seq_cst);
+        m_Epoch.fetch_add(1, std::memory_order_release);
+        m_Epoch.notify_all();
+
+        if (m_Engine)
+        {
+            for (unsigned i = 0; i < m_Started; ++i)
+            {
+                m_Engine->Post(&OnWake);
+            }
+        }
+
+        for (unsigned i = 0; i < m_Started; ++i)
+        {
+#if defined(_WIN32)
+            ::WaitForSingleObject(m_Workers[i].m_Thread, INFINITE);
+#else
+            ::pthread_join(m_Workers[i].m_Thread, nullptr);
+#endif
+        }
+    }
+
+public:
+    /*
+     * @brief True when every worker started
+     */
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Started == m_WorkerCount;
+    }
+
+    [[nodiscard]] unsigned Workers() const noexcept
+    {
+        return m_WorkerCount;
+    }
+
+#if defined(_WIN32)
+    [[nodiscard]] ThreadHandle const& Thread(unsigned index) const noexcept
+    {
+        return m_Workers[index].m_Thread;
+    }
+#endif
+
+    /*
+     * @brief Queues `task`, which must stay alive until it ran
+     */
+    void Submit(PoolTask& task) noexcept
+    {
+        auto* worker = CurrentWorker();
+        if (!worker || worker->m_Pool != this || !worker->m_Deque.Push(std::addressof(task)))
+        {
+            std::lock_guard lock(m_SharedLock);
+            task.m_Next = nullptr;
+            (m_SharedTail ? m_SharedTail->m_Next : m_SharedHead) = std::addressof(task);
+            m_SharedTail = std::addressof(task);
+            m_SharedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Notify();
+    }
+
+    /*
+     * @brief Runs one queued task on the calling thread, false when none was found
+     */
+    bool RunOne() noexcept
+    {
+        auto* worker = CurrentWorker();
+        if (worker && worker->m_Pool != this)
+        {
+            worker = nullptr;
+        }
+
+        auto* task = FindTask(worker);
+        if (!task)
+        {
+            return false;
+        }
+
+        Execute(*task);
+        return true;
+    }
+
+private:
+    [[nodiscard]] static Worker*& CurrentWorker() noexcept
+    {
+        static thread_local Worker* t_Worker = nullptr;
+        return t_Worker;
+    }
+
+    static void OnWake(IoOperation&, std::int64_t) noexcept
+    {
+    }
+
+    /*
+     * @brief i-th processor in the process affinity, wrapping around
+     */
+    [[nodiscard]] static unsigned AllowedProcessor(unsigned index) noexcept
+    {
+#if defined(_WIN32)
+        DWORD_PTR process = 0, system = 0;
+        if (!::GetProcessAffinityMask(::GetCurrentProcess(), &process, &system) || process == 0)
+        {
+            return index % 64;
+        }
+
+        index %= static_cast<unsigned>(std::popcount(static_cast<std::uint64_t>(process)));
+        for (unsigned cpu = 0;; ++cpu)
+        {
+            if ((process >> cpu & 1) && index-- == 0)
+            {
+                return cpu;
+            }
+        }
+#else
+        cpu_set_t allowed;
+        if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+        {
+            return index;
+        }
+
+        index %= static_cast<unsigned>(CPU_COUNT(&allowed));
+        for (unsigned cpu = 0;; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed) && index-- == 0)
+            {
+                return cpu;
+            }
+        }
+#endif
+    }
+
+    bool StartWorker(Worker& worker, ThreadAffinity affinity) noexcept
+    {
+#if defined(_WIN32)
+        worker.m_Thread.Reset(::CreateThread(nullptr, 0, [](LPVOID parameter) -> DWORD
+        {
+            auto& self = *static_cast<Worker*>(parameter);
+            self.m_Pool->Run(self);
+            return 0;
+        }, std::addressof(worker), CREATE_SUSPENDED, nullptr));
+
+        if (!worker.m_Thread.Valid())
+        {
+            return false;
+        }
+
+        if (affinity == ThreadAffinity::PinToCores)
+        {
+            ::SetThreadAffinityMask(worker.m_Thread, DWORD_PTR(1) << AllowedProcessor(worker.m_Index));
+        }
+
+        ::ResumeThread(worker.m_Thread);
+        return true;
+#else
+        pthread_attr_t attributes;
+        if (::pthread_attr_init(&attributes) != 0)
+        {
+            return false;
+        }
+
+        if (affinity == ThreadAffinity::PinToCores)
+        {
+            cpu_set_t processor;
+            CPU_ZERO(&processor);
+            CPU_SET(AllowedProcessor(worker.m_Index), &processor);
+            ::pthread_attr_setaffinity_np(&attributes, sizeof(processor), &processor);
+        }
+
+        worker.m_Started = ::pthread_create(&worker.m_Thread, &attributes, [](void* parameter) -> void*
+        {
+            auto& self = *static_cast<Worker*>(parameter);
+            self.m_Pool->Run(self);
+            return nullptr;
+        }, std::addressof(worker)) == 0;
+
+        ::pthread_attr_destroy(&attributes);
+        return worker.m_Started;
+#endif
+    }
+
+    void Notify() noexcept
+    {
+        // Pairs with the fence in Idle(), either a sleeper sees the task or we see the sleeper
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Sleepers.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        if (m_Engine)
+        {
+            if (!m_WakePending.exchange(true, std::memory_order_acq_rel) && !m_Engine->Post(&OnWake))
+            {
+                m_WakePending.store(false, std::memory_order_relaxed);
+            }
+
+            return;
+        }
+
+        m_Epoch.fetch_add(1, std::memory_order_release);
+        m_Epoch.notify_one();
+    }
+
+    [[nodiscard]] PoolTask* TakeShared() noexcept
+    {
+        if (m_SharedCount.load(std::memory_order_relaxed) == 0)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard lock(m_SharedLock);
+        auto* task = m_SharedHead;
+        if (task)
+        {
+            m_SharedHead = task->m_Next;
+            if (!m_SharedHead)
+            {
+                m_SharedTail = nullptr;
+            }
+
+            m_SharedCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    /*
+     * @brief Own deque, shared queue, then the other deques from a random victim on
+     */
+    [[nodiscard]] PoolTask* FindTask(Worker* worker) noexcept
+    {
+        if (worker)
+        {
+            if (auto* task = worker->m_Deque.Pop())
+            {
+                return task;
+            }
+        }
+
+        if (auto* task = TakeShared())
+        {
+            return task;
+        }
+
+        std::uint32_t start = 0;
+        if (worker)
+        {
+            // xorshift32
+            auto& seed = worker->m_Seed;
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            start = seed;
+        }
+
+        // Workers that failed to start have empty deques
+        for (unsigned i = 0; i < m_WorkerCount; ++i)
+        {
+            auto& victim = m_Workers[(start + i) % m_WorkerCount];
+            if (std::addressof(victim) == worker)
+            {
+                continue;
+            }
+
+            if (auto* task = victim.m_Deque.Steal())
+            {
+                return task;
+            }
+        }
+
+        return nullptr;
+    }
+
+    [[nodiscard]] bool HasWork() const noexcept
+    {
+        if (m_SharedCount.load(std::memory_order_relaxed) != 0)
+        {
+            return true;
+        }
+
+        for (unsigned i = 0; i < m_WorkerCount; ++i)
+        {
+            if (!m_Workers[i].m_Deque.Empty())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Execute(PoolTask& task) noexcept;
+
+    void Idle() noexcept
+    {
+        auto const epoch = m_Epoch.load(std::memory_order_acquire);
+        m_Sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!HasWork() && !m_Stop.load(std::memory_order_relaxed))
+        {
+            if (m_Engine)
+            {
+                m_Engine->RunOnce();
+                m_WakePending.store(false, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_Epoch.wait(epoch, std::memory_order_acquire);
+            }
+        }
+
+        m_Sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Run(Worker& worker) noexcept
+    {
+        CurrentWorker() = std::addressof(worker);
+
+        for (;;)
+        {
+            if (auto* task = FindTask(std::addressof(worker)))
+            {
+                Execute(*task);
+
+                if (m_Engine && ++worker.m_Executed % EnginePollInterval == 0)
+                {
+                    m_Engine->RunOnce(std::chrono::milliseconds::zero());
+                }
+
+                continue;
+            }
+
+            if (m_Stop.load(std::memory_order_acquire) && !HasWork())
+            {
+                break;
+            }
+
+            Idle();
+        }
+
+        CurrentWorker() = nullptr;
+    }
+};
+
+/*
+ * @brief Fork-join scope, Wait() runs pool tasks on the calling thread until its own are done
+ */
+class TaskGroup
+{
+    friend class ThreadPool;
+
+private:
+    ThreadPool&              m_Pool;
+    std::atomic<std::size_t> m_Pending = 0;
+
+public:
+    explicit TaskGroup(ThreadPool& pool) noexcept
+        : m_Pool(pool)
+    {}
+
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+
+    ~TaskGroup()
+    {
+        Wait();
+    }
+
+    /*
+     * @brief Submits `task` as part of this group
+     */
+    void Run(PoolTask& task) noexcept
+    {
+        task.m_Group = this;
+        m_Pending.fetch_add(1, std::memory_order_relaxed);
+        m_Pool.Submit(task);
+    }
+
+    void Wait() noexcept
+    {
+        while (m_Pending.load(std::memory_order_acquire) != 0)
+        {
+            if (!m_Pool.RunOne())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+inline void ThreadPool::Execute(PoolTask& task) noexcept
+{
+    // The group may be gone once its count dropped, nothing is touched after that
+    auto* group = task.m_Group;
+    task.m_Run(task);
+
+    if (group)
+    {
+        group->m_Pending.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,521 @@
+#pragma once
+#include "handle.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <ctime>
+
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+/*
+ * @brief Caller owned timer, linked into the wheel while scheduled
+ *
+ * Like PoolTask it is intrusive, so scheduling never allocates. It must stay alive and
+ * unmoved while scheduled.
+ */
+struct TimerNode
+{
+    void          (*m_Expired)(TimerNode&) noexcept = nullptr;
+    void*         m_Context = nullptr;
+
+    // Owned by the wheel
+    TimerNode*    m_Next     = nullptr;
+    TimerNode*    m_Previous = nullptr;
+    std::uint64_t m_Deadline = 0;
+
+    [[nodiscard]] bool Scheduled() const noexcept
+    {
+        return m_Next != nullptr;
+    }
+};
+
+/*
+ * @brief Hierarchical timer wheel multiplexing any number of TimerNodes onto one WaitableTimerHandle
+ *
+ * Four levels of 256 slots cover 2^32 ticks, about 49 days at the default 1ms resolution;
+ * later deadlines wait in the top level and are re-placed whenever they cascade. Schedule
+ * and Cancel are O(1) list operations. Advance() walks the ticks that elapsed, skipping empty
+ * slots with per level occupancy bitmaps, cascades a higher level every 256 ticks of the one
+ * below, collects everything due into one batch and only then runs the callbacks.
+ *
+ * The kernel timer (a waitable timer on Windows, high resolution when available, a timerfd
+ * on Linux) is armed for the earliest slot only, and re-armed only when a new deadline comes
+ * before it. A tolerance passed to Schedule() rounds the deadline up to a power of two number
+ * of ticks within it, so timers with similar deadlines share a slot and one wakeup.
+ *
+ * The wheel belongs to one thread: Timer() goes into that thread's wait (WaitSet, a
+ * CompletionEngine wait or Run()), which calls Advance(). Callbacks may schedule and cancel
+ * any node, their own included.
+ */
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds Infinite{ -1 };
+
+private:
+    static constexpr std::uint32_t SlotBits = 8;
+    static constexpr std::uint32_t Slots    = 1u << SlotBits;
+    static constexpr std::uint32_t Levels   = 4;
+    static constexpr std::uint64_t SlotMask = Slots - 1;
+    static constexpr std::uint64_t MaxDelta = (std::uint64_t(1) << (SlotBits * Levels)) - 1;
+    static constexpr std::uint64_t Disarmed = std::numeric_limits<std::uint64_t>::max();
+
+    using Occupancy = std::array<std::uint64_t, Slots / 64>;
+
+    WaitableTimerHandle           m_Timer;
+    Clock::time_point             m_Origin;
+    Clock::duration               m_Resolution;
+
+    // Next tick Advance() processes, every deadline before it has expired
+    std::uint64_t                 m_Current = 0;
+    std::uint64_t                 m_Armed   = Disarmed;
+    std::size_t                   m_Count   = 0;
+
+    // Sentinels of the Levels * Slots lists and of the expired batch, never moved
+    std::unique_ptr<TimerNode[]>  m_Slots;
+    std::unique_ptr<TimerNode>    m_Expired;
+    std::array<Occupancy, Levels> m_Occupied{};
+
+public:
+    /*
+     * @param Tick length, deadlines are rounded up to it
+     */
+    explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1))
+        : m_Origin(Clock::now())
+        , m_Resolution(resolution > Clock::duration::zero() ? resolution : Clock::duration(1))
+        , m_Slots(new (std::nothrow) TimerNode[Levels * Slots])
+        , m_Expired(new (std::nothrow) TimerNode)
+    {
+        if (!m_Slots || !m_Expired)
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i < Levels * Slots; ++i)
+        {
+            m_Slots[i].m_Next = m_Slots[i].m_Previous = &m_Slots[i];
+        }
+
+        m_Expired->m_Next = m_Expired->m_Previous = m_Expired.get();
+
+#if defined(_WIN32)
+        m_Timer.Reset(::CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+        if (!m_Timer.Valid())
+        {
+            // Before Windows 10 1803
+            m_Timer.Reset(::CreateWaitableTimerW(nullptr, FALSE, nullptr));
+        }
+#else
+        m_Timer.Reset(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+#endif
+    }
+
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+
+    ~TimerWheel()
+    {
+        if (!m_Slots || !m_Expired)
+        {
+            return;
+        }
+
+        // Nodes outlive the wheel, leave them unscheduled
+        for (std::size_t i = 0; i <= Levels * Slots; ++i)
+        {
+            auto& sentinel = i < Levels * Slots ? m_Slots[i] : *m_Expired;
+            for (auto* node = sentinel.m_Next; node != &sentinel;)
+            {
+                auto* const next = node->m_Next;
+                node->m_Next = node->m_Previous = nullptr;
+                node = next;
+            }
+        }
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+        return m_Timer.Valid();
+    }
+
+    /*
+     * @brief Signaled once the earliest timer is due, a wait on it is followed by Advance()
+     */
+    [[nodiscard]] WaitableTimerHandle const& Timer() const noexcept
+    {
+        return m_Timer;
+    }
+
+    /*
+     * @brief Scheduled nodes, including those expired but not yet called back
+     */
+    [[nodiscard]] std::size_t Size() const noexcept
+    {
+        return m_Count;
+    }
+
+    /*
+     * @brief Schedules `node` to expire after `delay`, rescheduling it if it already is
+     *
+     * @param Up to this much later is fine, used to share a slot and a wakeup with other timers
+     */
+    void Schedule(TimerNode& node, Clock::duration delay, Clock::duration tolerance = Clock::duration::zero()) noexcept
+    {
+        ScheduleAt(node, Clock::now() + delay, tolerance);
+    }
+
+    void ScheduleAt(TimerNode& node, Clock::time_point deadline, Clock::duration tolerance = Clock::duration::zero()) noexcept
+    {
+        if (node.Scheduled())
+        {
+            Unlink(node);
+            --m_Count;
+        }
+
+        auto const elapsed = deadline - m_Origin;
+        auto tick          = elapsed > Clock::duration::zero()
+                                 ? static_cast<std::uint64_t>((elapsed + m_Resolution - Clock::duration(1)) / m_Resolution)
+                                 : 0;
+
+        if (auto const slack = static_cast<std::uint64_t>(std::max(tolerance, Clock::duration::zero()) / m_Resolution); slack > 1)
+        {
+            auto const alignment = std::bit_floor(slack);
+            tick = (tick + alignment - 1) & ~(alignment - 1);
+        }
+
+        node.m_Deadline = std::max(tick, m_Current);
+        Place(node);
+        ++m_Count;
+
+        if (node.m_Deadline < m_Armed)
+        {
+            Arm(node.m_Deadline);
+        }
+    }
+
+    /*
+     * @brief Unschedules `node`, false if it was not scheduled
+     *
+     * A node expired in the running batch is cancelled too, its callback will not run.
+     */
+    bool Cancel(TimerNode& node) noexcept
+    {
+        if (!node.Scheduled())
+        {
+            return false;
+        }
+
+        Unlink(node);
+        --m_Count;
+        return true;
+    }
+
+    /*
+     * @brief Expires everything due at `now` and calls the callbacks, then re-arms the timer
+     *
+     * @return Number of callbacks run
+     */
+    std::size_t Advance(Clock::time_point now = Clock::now()) noexcept
+    {
+#if !defined(_WIN32)
+        std::uint64_t expirations;
+        while (::read(m_Timer.Get(), &expirations, sizeof(expirations)) < 0 && errno == EINTR)
+        {
+        }
+#endif
+
+        auto const elapsed = now - m_Origin;
+        if (elapsed >= Clock::duration::zero())
+        {
+            Collect(static_cast<std::uint64_t>(elapsed / m_Resolution));
+        }
+
+        // The kernel timer fired or is about to, either way it is re-armed below
+        m_Armed = Disarmed;
+
+        std::size_t expired = 0;
+        while (m_Expired->m_Next != m_Expired.get())
+        {
+            auto& node = *m_Expired->m_Next;
+            Unlink(node);
+            --m_Count;
+
+            node.m_Expired(node);
+            ++expired;
+        }
+
+        if (auto const next = NextTick(); next != Disarmed)
+        {
+            Arm(next);
+        }
+
+        return expired;
+    }
+
+    /*
+     * @brief Waits up to `timeout` for the earliest timer, then Advance()
+     */
+    std::size_t Run(std::chrono::milliseconds timeout = Infinite) noexcept
+    {
+#if defined(_WIN32)
+        ::WaitForSingleObject(m_Timer, timeout < std::chrono::milliseconds::zero() ? INFINITE : static_cast<DWORD>(timeout.count()));
+#else
+        pollfd expired{ m_Timer.Get(), POLLIN, 0 };
+        ::poll(&expired, 1, timeout < std::chrono::milliseconds::zero() ? -1 : static_cast<int>(timeout.count()));
+#endif
+
+        return Advance();
+    }
+
+private:
+    [[nodiscard]] static constexpr std::size_t SlotIndex(std::uint64_t tick, std::uint32_t level) noexcept
+    {
+        return static_cast<std::size_t>((tick >> (SlotBits * level)) & SlotMask);
+    }
+
+    [[nodiscard]] TimerNode& Slot(std::uint32_t level, std::size_t index) noexcept
+    {
+        return m_Slots[level * Slots + index];
+    }
+
+    /*
+     * @brief Links `node` into the slot of its deadline, relative to m_Current
+     */
+    void Place(TimerNode& node) noexcept
+    {
+        // Beyond the top level, parked at its far end and re-placed when it cascades
+        auto const delta = node.m_Deadline - m_Current;
+        auto const tick  = delta > MaxDelta ? m_Current + MaxDelta : node.m_Deadline;
+
+        std::uint32_t level = 0;
+        while (level + 1 < Levels && (tick - m_Current) >> (SlotBits * (level + 1)) != 0)
+        {
+            ++level;
+        }
+
+        auto const index = SlotIndex(tick, level);
+        Link(Slot(level, index), node);
+        m_Occupied[level][index / 64] |= std::uint64_t(1) << (index % 64);
+    }
+
+    static void Link(TimerNode& sentinel, TimerNode& node) noexcept
+    {
+        node.m_Previous             = sentinel.m_Previous;
+        node.m_Next                 = &sentinel;
+        sentinel.m_Previous->m_Next = &node;
+        sentinel.m_Previous         = &node;
+    }
+
+    void Unlink(TimerNode& node) noexcept
+    {
+        auto* const next = node.m_Next;
+        next->m_Previous        = node.m_Previous;
+        node.m_Previous->m_Next = next;
+        node.m_Next = node.m_Previous = nullptr;
+
+        // Emptied a slot, only sentinels link to themselves
+        if (next->m_Next == next && next != m_Expired.get())
+        {
+            auto const slot = static_cast<std::size_t>(next - m_Slots.get());
+            m_Occupied[slot / Slots][(slot % Slots) / 64] &= ~(std::uint64_t(1) << (slot % 64));
+        }
+    }
+
+    /*
+     * @brief Moves the whole list of `sentinel` behind the expired batch
+     */
+    void SpliceExpired(TimerNode& sentinel) noexcept
+    {
+        auto& expired = *m_Expired;
+
+        sentinel.m_Next->m_Previous = expired.m_Previous;
+        expired.m_Previous->m_Next  = sentinel.m_Next;
+        sentinel.m_Previous->m_Next = &expired;
+        expired.m_Previous          = sentinel.m_Previous;
+        sentinel.m_Next = sentinel.m_Previous = &sentinel;
+    }
+
+    /*
+     * @brief First occupied slot of `level` at or after `from`, Slots if none
+     */
+    [[nodiscard]] std::size_t NextOccupied(std::uint32_t level, std::size_t from) const noexcept
+    {
+        for (auto word = from / 64; word < Slots / 64; ++word)
+        {
+            auto bits = m_Occupied[level][word];
+            if (word == from / 64)
+            {
+                bits &= ~std::uint64_t(0) << (from % 64);
+            }
+
+            if (bits != 0)
+            {
+                return word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+            }
+        }
+
+        return Slots;
+    }
+
+    [[nodiscard]] bool HigherOccupied() const noexcept
+    {
+        for (std::uint32_t level = 1; level < Levels; ++level)
+        {
+            for (auto const word : m_Occupied[level])
+            {
+                if (word != 0)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /*
+     * @brief Re-places the slot of each higher level whose turn begins at m_Current
+     */
+    void Cascade() noexcept
+    {
+        for (std::uint32_t level = 1; level < Levels; ++level)
+        {
+            auto const index = SlotIndex(m_Current, level);
+            auto& sentinel   = Slot(level, index);
+
+            auto* node = sentinel.m_Next;
+            sentinel.m_Next = sentinel.m_Previous = &sentinel;
+            m_Occupied[level][index / 64] &= ~(std::uint64_t(1) << (index % 64));
+
+            while (node != &sentinel)
+            {
+                auto* const next = node->m_Next;
+                Place(*node);
+                node = next;
+            }
+
+            // The next level only turns when this one wrapped
+            if (index != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    /*
+     * @brief Moves every timer due up to `now` into the expired batch
+     */
+    void Collect(std::uint64_t now) noexcept
+    {
+        // Nothing to cascade either
+        if (m_Count == 0)
+        {
+            m_Current = std::max(m_Current, now + 1);
+            return;
+        }
+
+        while (m_Current <= now)
+        {
+            auto const index = static_cast<std::size_t>(m_Current & SlotMask);
+            if (index == 0)
+            {
+                Cascade();
+            }
+
+            auto const block = m_Current & ~SlotMask;
+            auto const next  = NextOccupied(0, index);
+            if (next == Slots)
+            {
+                // Stopping short of the block end keeps later schedules from landing behind m_Current
+                m_Current = std::min(block + Slots, now + 1);
+                continue;
+            }
+
+            if (block + next > now)
+            {
+                m_Current = now + 1;
+                break;
+            }
+
+            SpliceExpired(Slot(0, next));
+            m_Occupied[0][next / 64] &= ~(std::uint64_t(1) << (next % 64));
+            m_Current = block + next + 1;
+        }
+    }
+
+    /*
+     * @brief Tick the kernel timer has to fire at for the earliest timer, Disarmed if there is none
+     */
+    [[nodiscard]] std::uint64_t NextTick() const noexcept
+    {
+        if (m_Count == 0)
+        {
+            return Disarmed;
+        }
+
+        auto const index = static_cast<std::size_t>(m_Current & SlotMask);
+        auto const block = m_Current & ~SlotMask;
+        auto const higher = HigherOccupied();
+
+        // A cascade is due before anything else is known
+        if (index == 0 && higher)
+        {
+            return m_Current;
+        }
+
+        if (auto const next = NextOccupied(0, index); next != Slots)
+        {
+            return block + next;
+        }
+
+        // The rest of level 0 belongs to the next block, which starts with a cascade
+        if (higher)
+        {
+            return block + Slots;
+        }
+
+        return block + Slots + NextOccupied(0, 0);
+    }
+
+    void Arm(std::uint64_t tick) noexcept
+    {
+        m_Armed = tick;
+
+        auto const deadline = m_Origin + m_Resolution * static_cast<Clock::rep>(tick);
+
+#if defined(_WIN32)
+        // Negative due times are relative, in 100ns units
+        auto const remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now()).count();
+        LARGE_INTEGER due;
+        due.QuadPart = -std::max<LONGLONG>(remaining / 100, 1);
+        ::SetWaitableTimer(m_Timer, &due, 0, nullptr, nullptr, FALSE);
+#else
+        // steady_clock is CLOCK_MONOTONIC, a deadline already past fires right away
+        auto const since = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        itimerspec expiry{};
+        expiry.it_value.tv_sec  = static_cast<time_t>(since / 1'000'000'000);
+        expiry.it_value.tv_nsec = static_cast<long>(since % 1'000'000'000);
+        if (expiry.it_value.tv_sec == 0 && expiry.it_value.tv_nsec == 0)
+        {
+            expiry.it_value.tv_nsec = 1;
+        }
+
+        ::timerfd_settime(m_Timer.Get(), TFD_TIMER_ABSTIME, &expiry, nullptr);
+#endif
+    }
+};
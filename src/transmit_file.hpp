@@ -0,0 +1,228 @@
+#pragma once
+#include "handle.hpp"
+#include "event_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(_WIN32)
+#include <mswsock.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * @brief A file range framed by optional header and trailer bytes, sent without copying the file through user space
+ *
+ * `m_Length` 0 means up to the end of the file. The file, header and trailer must stay alive
+ * until the transmission completed. `m_Sent` counts the bytes sent so far, header and trailer
+ * included.
+ */
+struct TransmitRequest
+{
+    FileHandle const&          m_File;
+    std::uint64_t              m_Offset = 0;
+    std::uint64_t              m_Length = 0;
+    std::span<std::byte const> m_Header;
+    std::span<std::byte const> m_Trailer;
+    std::uint64_t              m_Sent = 0;
+#if defined(_WIN32)
+    TRANSMIT_FILE_BUFFERS      m_Buffers{};
+#endif
+
+    /*
+     * @brief Resolves a 0 length to the rest of the file
+     */
+    [[nodiscard]] bool Resolve() noexcept
+    {
+        if (m_Length != 0)
+        {
+            return true;
+        }
+
+#if defined(_WIN32)
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(m_File.Get(), &size))
+        {
+            return false;
+        }
+
+        auto const fileSize = static_cast<std::uint64_t>(size.QuadPart);
+#else
+        struct stat status;
+        if (::fstat(m_File.Get(), &status) != 0)
+        {
+            return false;
+        }
+
+        auto const fileSize = static_cast<std::uint64_t>(status.st_size);
+#endif
+
+        m_Length = fileSize > m_Offset ? fileSize - m_Offset : 0;
+        return true;
+    }
+
+    [[nodiscard]] std::uint64_t Total() const noexcept
+    {
+        return m_Header.size() + m_Length + m_Trailer.size();
+    }
+};
+
+#if defined(_WIN32)
+// TransmitFile sends at most 2^31 - 1 bytes of the file per call
+inline constexpr std::uint64_t MaxTransmitChunk = 0x7fffffff;
+#else
+// Most sendfile can move per call
+inline constexpr std::uint64_t MaxTransmitChunk = 0x7ffff000;
+
+/*
+ * @brief Sends what `socket` accepts without blocking, continuing at `request.m_Sent`
+ *
+ * The header goes out with MSG_MORE so it shares segments with the file data, which sendfile
+ * reads straight from the page cache.
+ *
+ * @return Total bytes sent once complete, -EAGAIN when the socket is full, or -errno
+ */
+[[nodiscard]] inline std::int64_t TransmitStep(int socket, TransmitRequest& request) noexcept
+{
+    auto const header = request.m_Header.size();
+    auto const body   = header + request.m_Length;
+
+    while (request.m_Sent < request.Total())
+    {
+        ssize_t sent;
+        if (request.m_Sent < header)
+        {
+            auto const more = request.m_Length != 0 || !request.m_Trailer.empty() ? MSG_MORE : 0;
+            sent = ::send(socket, request.m_Header.data() + request.m_Sent, header - request.m_Sent, MSG_NOSIGNAL | more);
+        }
+        else if (request.m_Sent < body)
+        {
+            auto offset = static_cast<off_t>(request.m_Offset + (request.m_Sent - header));
+            sent = ::sendfile(socket, request.m_File.Get(), &offset, static_cast<std::size_t>(std::min(body - request.m_Sent, MaxTransmitChunk)));
+
+            // The file shrank below the requested range
+            if (sent == 0)
+            {
+                return -EIO;
+            }
+        }
+        else
+        {
+            auto const done = request.m_Sent - body;
+            sent = ::send(socket, request.m_Trailer.data() + done, request.m_Trailer.size() - done, MSG_NOSIGNAL);
+        }
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return -errno;
+        }
+
+        request.m_Sent += static_cast<std::uint64_t>(sent);
+    }
+
+    return static_cast<std::int64_t>(request.m_Sent);
+}
+#endif
+
+/*
+ * @brief Sends `request` on `socket` and returns once all of it was sent
+ *
+ * Windows: TransmitFile, in chunks of MaxTransmitChunk, waiting on a pooled event whose
+ * completion is kept off any completion port the socket is associated with. Linux: sendfile,
+ * polling for space when the socket is non-blocking.
+ *
+ * @return Total bytes sent, or -error
+ */
+[[nodiscard]] inline std::int64_t SendFile(SocketHandle const& socket, TransmitRequest& request) noexcept
+{
+    if (!request.Resolve())
+    {
+#if defined(_WIN32)
+        return -static_cast<std::int64_t>(::GetLastError());
+#else
+        return -errno;
+#endif
+    }
+
+#if defined(_WIN32)
+    auto const event = EventPool<EventReset::Manual>::Instance().Acquire();
+    if (!event.Valid())
+    {
+        return -static_cast<std::int64_t>(::GetLastError());
+    }
+
+    std::uint64_t fileSent = 0;
+    do
+    {
+        auto const chunk = std::min(request.m_Length - fileSent, MaxTransmitChunk);
+        auto const last  = fileSent + chunk == request.m_Length;
+
+        TRANSMIT_FILE_BUFFERS buffers{};
+        if (fileSent == 0)
+        {
+            buffers.Head       = const_cast<std::byte*>(request.m_Header.data());
+            buffers.HeadLength = static_cast<DWORD>(request.m_Header.size());
+        }
+
+        if (last)
+        {
+            buffers.Tail       = const_cast<std::byte*>(request.m_Trailer.data());
+            buffers.TailLength = static_cast<DWORD>(request.m_Trailer.size());
+        }
+
+        auto const offset = request.m_Offset + fileSent;
+
+        OVERLAPPED overlapped{};
+        overlapped.Offset     = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        // The low bit keeps the completion off the socket's completion port
+        overlapped.hEvent     = reinterpret_cast<HANDLE>(reinterpret_cast<std::uintptr_t>(event.Get()) | 1);
+        ::ResetEvent(event.Get());
+
+        if (!::TransmitFile(socket.Get(), request.m_File.Get(), static_cast<DWORD>(chunk), 0, &overlapped, &buffers, 0)
+            && ::WSAGetLastError() != WSA_IO_PENDING)
+        {
+            return -static_cast<std::int64_t>(::WSAGetLastError());
+        }
+
+        DWORD transferred = 0;
+        DWORD flags       = 0;
+        if (!::WSAGetOverlappedResult(socket.Get(), &overlapped, &transferred, TRUE, &flags))
+        {
+            return -static_cast<std::int64_t>(::WSAGetLastError());
+        }
+
+        request.m_Sent += transferred;
+        fileSent += chunk;
+    } while (fileSent < request.m_Length);
+
+    return static_cast<std::int64_t>(request.m_Sent);
+#else
+    for (;;)
+    {
+        auto const result = TransmitStep(socket.Get(), request);
+        if (result != -EAGAIN && result != -EWOULDBLOCK)
+        {
+            return result;
+        }
+
+        pollfd writable{ socket.Get(), POLLOUT, 0 };
+        if (::poll(&writable, 1, -1) < 0 && errno != EINTR)
+        {
+            return -errno;
+        }
+    }
+#endif
+}
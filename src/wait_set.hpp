@@ -0,0 +1,308 @@
+#pragma once
+#include "handle.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#if defined(_WIN32)
+#include <algorithm>
+#include <mutex>
+#else
+#include <sys/epoll.h>
+#endif
+
+/*
+ * @brief Waits on any number of waitable handles and reports the ready ones in batches
+ *
+ * Windows: WaitForMultipleObjects stops at MAXIMUM_WAIT_OBJECTS (64), so every handle gets a
+ * threadpool wait registration instead. Fired registrations push their index to a queue and
+ * signal one internal event, which is all `Wait()` blocks on. Registrations are one-shot and
+ * re-armed at the next `Wait()`, so handles that stay signaled are reported again. As with
+ * WaitForSingleObject a satisfied wait consumes auto-reset events and semaphore counts and
+ * acquires mutexes.
+ *
+ * Linux: a level-triggered epoll set over the descriptors (eventfd, pidfd, timerfd, pipes,
+ * sockets). Readiness is only observed, reading the eventfd or timerfd is up to the caller.
+ *
+ * Not thread-safe, one thread adds, removes and waits.
+ */
+class WaitSet
+{
+public:
+    static constexpr std::size_t InvalidIndex = std::numeric_limits<std::size_t>::max();
+    static constexpr std::chrono::milliseconds Infinite{ -1 };
+
+private:
+#if defined(_WIN32)
+    struct Registration
+    {
+        WaitSet*    m_Set;
+        std::size_t m_Index;
+        HANDLE      m_Handle;
+        PTP_WAIT    m_Wait;
+    };
+
+    std::vector<std::unique_ptr<Registration>> m_Slots;
+    std::vector<std::size_t>                   m_Fired;
+
+    EventHandle              m_Signal;
+    std::mutex               m_ReadyLock;
+    std::vector<std::size_t> m_Ready;
+#else
+    struct Registration
+    {
+        int  m_Fd;
+        bool m_Used;
+    };
+
+    std::vector<Registration> m_Slots;
+    std::vector<epoll_event>  m_Events;
+
+    IoCompletionPortHandle m_Epoll;
+#endif
+
+    std::vector<std::size_t> m_FreeSlots;
+    std::size_t              m_Size = 0;
+
+public:
+    WaitSet() noexcept
+#if defined(_WIN32)
+        : m_Signal(::CreateEventW(nullptr, FALSE, FALSE, nullptr))
+#else
+        : m_Epoll(::epoll_create1(EPOLL_CLOEXEC))
+#endif
+    {
+    }
+
+    WaitSet(WaitSet const&) = delete;
+    WaitSet& operator=(WaitSet const&) = delete;
+
+    ~WaitSet()
+    {
+        for (std::size_t index = 0; index < m_Slots.size(); ++index)
+        {
+            Remove(index);
+        }
+    }
+
+public:
+    [[nodiscard]] bool Valid() const noexcept
+    {
+#if defined(_WIN32)
+        return m_Signal.Valid();
+#else
+        return m_Epoll.Valid();
+#endif
+    }
+
+    /*
+     * @brief Number of registered handles
+     */
+    [[nodiscard]] std::size_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    /*
+     * @brief Starts watching `handle`, remove it again before closing the handle
+     *
+     * @return Index reported by Wait() until Remove(), InvalidIndex on failure
+     */
+    template<WaitableHandleType _Ty, typename _ClosePolicy>
+    std::size_t Add(Handle<_Ty, _ClosePolicy> const& handle)
+    {
+        if (!handle.Valid())
+        {
+            return InvalidIndex;
+        }
+
+        std::size_t index;
+        if (!m_FreeSlots.empty())
+        {
+            index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        }
+        else
+        {
+            index = m_Slots.size();
+            m_Slots.emplace_back();
+        }
+
+#if defined(_WIN32)
+        auto registration = std::make_unique<Registration>(Registration{ this, index, handle.Get(), nullptr });
+
+        registration->m_Wait = ::CreateThreadpoolWait(&OnSignaled, registration.get(), nullptr);
+        if (!registration->m_Wait)
+        {
+            m_FreeSlots.push_back(index);
+            return InvalidIndex;
+        }
+
+        ::SetThreadpoolWait(registration->m_Wait, registration->m_Handle, nullptr);
+        m_Slots[index] = std::move(registration);
+#else
+        epoll_event event{};
+        event.events   = EPOLLIN;
+        event.data.u64 = index;
+
+        if (::epoll_ctl(m_Epoll, EPOLL_CTL_ADD, handle.Get(), &event) != 0)
+        {
+            m_FreeSlots.push_back(index);
+            return InvalidIndex;
+        }
+
+        m_Slots[index] = { handle.Get(), true };
+#endif
+
+        ++m_Size;
+        return index;
+    }
+
+    /*
+     * @brief Stops watching the handle at `index`, it is never reported again
+     *
+     * @return false for unknown indices
+     */
+    bool Remove(std::size_t index) noexcept
+    {
+        if (index >= m_Slots.size())
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        auto& registration = m_Slots[index];
+        if (!registration)
+        {
+            return false;
+        }
+
+        ::SetThreadpoolWait(registration->m_Wait, nullptr, nullptr);
+        ::WaitForThreadpoolWaitCallbacks(registration->m_Wait, TRUE);
+        ::CloseThreadpoolWait(registration->m_Wait);
+        registration.reset();
+
+        // The index may be reused, drop reports that are still queued
+        std::lock_guard lock(m_ReadyLock);
+        std::erase(m_Ready, index);
+        std::erase(m_Fired, index);
+#else
+        auto& registration = m_Slots[index];
+        if (!registration.m_Used)
+        {
+            return false;
+        }
+
+        // Fails with EBADF when the handle was closed first, which removed it already
+        ::epoll_ctl(m_Epoll, EPOLL_CTL_DEL, registration.m_Fd, nullptr);
+        registration = { -1, false };
+#endif
+
+        m_FreeSlots.push_back(index);
+        --m_Size;
+        return true;
+    }
+
+    /*
+     * @brief Blocks until at least one handle is signaled or `timeout` elapsed
+     *
+     * @param Receives the indices of up to `ready.size()` signaled handles
+     * @param Time limit, Infinite waits forever and zero polls
+     * @return Number of indices written, 0 on timeout
+     */
+    std::size_t Wait(std::span<std::size_t> ready, std::chrono::milliseconds timeout = Infinite)
+    {
+        if (ready.empty())
+        {
+            return 0;
+        }
+
+#if defined(_WIN32)
+        for (auto const index : m_Fired)
+        {
+            ::SetThreadpoolWait(m_Slots[index]->m_Wait, m_Slots[index]->m_Handle, nullptr);
+        }
+
+        m_Fired.clear();
+
+        auto const deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            DWORD milliseconds = INFINITE;
+            if (timeout >= std::chrono::milliseconds::zero())
+            {
+                auto const left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                milliseconds = static_cast<DWORD>(std::max<std::int64_t>(left.count(), 0));
+            }
+
+            if (::WaitForSingleObject(m_Signal, milliseconds) != WAIT_OBJECT_0)
+            {
+                return 0;
+            }
+
+            std::lock_guard lock(m_ReadyLock);
+
+            // The signal can outlive the reports it announced when an earlier call took them
+            if (m_Ready.empty())
+            {
+                continue;
+            }
+
+            auto const count = std::min(ready.size(), m_Ready.size());
+            std::copy_n(m_Ready.begin(), count, ready.begin());
+            m_Ready.erase(m_Ready.begin(), m_Ready.begin() + static_cast<std::ptrdiff_t>(count));
+            m_Fired.insert(m_Fired.end(), ready.begin(), ready.begin() + static_cast<std::ptrdiff_t>(count));
+
+            // More than one batch fired, the next call must not block
+            if (!m_Ready.empty())
+            {
+                ::SetEvent(m_Signal);
+            }
+
+            return count;
+        }
+#else
+        if (m_Events.size() < ready.size())
+        {
+            m_Events.resize(ready.size());
+        }
+
+        auto const count = ::epoll_wait(m_Epoll, m_Events.data(), static_cast<int>(ready.size()),
+                                        timeout < std::chrono::milliseconds::zero() ? -1 : static_cast<int>(timeout.count()));
+
+        // EINTR counts as a timeout
+        for (int i = 0; i < count; ++i)
+        {
+            ready[static_cast<std::size_t>(i)] = static_cast<std::size_t>(m_Events[static_cast<std::size_t>(i)].data.u64);
+        }
+
+        return count > 0 ? static_cast<std::size_t>(count) : 0;
+#endif
+    }
+
+private:
+#if defined(_WIN32)
+    static void CALLBACK OnSignaled(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WAIT, TP_WAIT_RESULT) noexcept
+    {
+        auto const& registration = *static_cast<Registration*>(context);
+        auto& set = *registration.m_Set;
+
+        bool wasEmpty;
+        {
+            std::lock_guard lock(set.m_ReadyLock);
+            wasEmpty = set.m_Ready.empty();
+            set.m_Ready.push_back(registration.m_Index);
+        }
+
+        if (wasEmpty)
+        {
+            ::SetEvent(set.m_Signal);
+        }
+    }
+#endif
+};
@@ -0,0 +1,139 @@
+#include "async_file.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t BlockSize = 4096;
+    constexpr std::size_t Blocks    = 16;
+
+    /*
+     * @brief Scratch file whose block `i` is filled with the byte value `i`
+     */
+    std::string ScratchFile()
+    {
+        auto const path = (std::filesystem::temp_directory_path() / "handle_test_async").string();
+
+        std::vector<char> block(BlockSize);
+#if defined(_WIN32)
+        FileHandle file(::CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+#else
+        FileHandle file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+#endif
+        for (std::size_t i = 0; i < Blocks; ++i)
+        {
+            std::fill(block.begin(), block.end(), static_cast<char>(i));
+#if defined(_WIN32)
+            DWORD written = 0;
+            ::WriteFile(file, block.data(), static_cast<DWORD>(block.size()), &written, nullptr);
+#else
+            (void)::write(file, block.data(), block.size());
+#endif
+        }
+
+        return path;
+    }
+
+    FileHandle OpenForReading(std::string const& path) noexcept
+    {
+#if defined(_WIN32)
+        return FileHandle(::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr));
+#else
+        return FileHandle(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+    }
+}
+
+HANDLE_TEST(AsyncFile, QueueDepthBoundsSubmission)
+{
+    auto const path = ScratchFile();
+
+    {
+        AsyncFile file(OpenForReading(path), 4);
+        HANDLE_CHECK(file.Valid() && file.QueueDepth() == 4);
+
+        std::vector<std::byte> buffers(Blocks * BlockSize);
+        std::vector<AsyncRead> reads;
+        for (std::size_t i = 0; i < Blocks; ++i)
+        {
+            reads.push_back({ std::span(buffers).subspan(i * BlockSize, BlockSize), i * BlockSize, i });
+        }
+
+        // Never more than the queue depth in flight, the rest goes in as completions come back
+        std::span<AsyncRead const> pending(reads);
+        std::array<bool, Blocks> done{};
+        std::size_t completed = 0;
+
+        while (completed != Blocks)
+        {
+            auto const issued = file.SubmitReads(pending);
+            pending = pending.subspan(issued);
+            HANDLE_CHECK(file.InFlight() <= file.QueueDepth());
+
+            std::array<AsyncCompletion, Blocks> completions;
+            auto const count = file.WaitCompletions(completions, 1);
+            HANDLE_CHECK(count != 0);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto const block = completions[i].m_UserData;
+                HANDLE_CHECK(block < Blocks && !done[block]);
+                HANDLE_CHECK(completions[i].m_Result == static_cast<std::int64_t>(BlockSize));
+
+                done[block] = true;
+                ++completed;
+            }
+        }
+
+        HANDLE_CHECK(file.InFlight() == 0);
+        for (std::size_t i = 0; i < buffers.size(); ++i)
+        {
+            HANDLE_CHECK(buffers[i] == static_cast<std::byte>(i / BlockSize));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+#if !defined(_WIN32)
+HANDLE_TEST(AsyncFile, CancelPendingRead)
+{
+    // A read from an empty pipe stays in flight until cancelled
+    int fds[2];
+    HANDLE_CHECK(::pipe2(fds, O_CLOEXEC) == 0);
+    FileHandle writer(fds[1]);
+
+    AsyncFile file(FileHandle(fds[0]), 2);
+    HANDLE_CHECK(file.Valid());
+
+    std::array<std::byte, 64> first;
+    std::array<std::byte, 64> second;
+    AsyncRead const reads[] = { { first, 0, 1 }, { second, 0, 2 } };
+    HANDLE_CHECK(file.SubmitReads(reads) == 2);
+
+    std::array<AsyncCompletion, 4> completions;
+    HANDLE_CHECK(file.PollCompletions(completions) == 0);
+    HANDLE_CHECK(file.Cancel(1));
+
+    HANDLE_CHECK(file.WaitCompletions(completions, 1) == 1);
+    HANDLE_CHECK(completions[0].m_UserData == 1 && completions[0].m_Result == -ECANCELED);
+    HANDLE_CHECK(file.InFlight() == 1);
+
+    // The destructor cancels and drains the other one
+}
+#endif
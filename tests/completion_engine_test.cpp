@@ -0,0 +1,125 @@
+#include "completion_engine.hpp"
+#include "test.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <sys/socket.h>
+#endif
+
+namespace
+{
+    /*
+     * @brief Result slot a callback fills through IoOperation::m_Context
+     */
+    struct Outcome
+    {
+        std::int64_t m_Result = 0;
+        int          m_Calls  = 0;
+    };
+
+    void Record(IoOperation& operation, std::int64_t result) noexcept
+    {
+        auto& outcome = *static_cast<Outcome*>(operation.m_Context);
+        outcome.m_Result = result;
+        ++outcome.m_Calls;
+    }
+
+    /*
+     * @brief Runs completions on the calling thread until `outcome` was reported or a second passed
+     */
+    void RunUntil(CompletionEngine& engine, Outcome const& outcome)
+    {
+        for (int round = 0; round < 100 && outcome.m_Calls == 0; ++round)
+        {
+            engine.RunOnce(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+HANDLE_TEST(CompletionEngine, PostRunsOnRunOnce)
+{
+    CompletionEngine engine(1, 4);
+    HANDLE_CHECK(engine.Valid());
+
+    Outcome outcomes[4];
+    for (auto& outcome : outcomes)
+    {
+        HANDLE_CHECK(engine.Post(&Record, &outcome));
+    }
+
+    // The pool holds four operations, they come back once their callbacks ran
+    Outcome overflow;
+    HANDLE_CHECK(!engine.Post(&Record, &overflow));
+
+    std::size_t ran = 0;
+    for (int round = 0; round < 10 && ran < 4; ++round)
+    {
+        ran += engine.RunOnce(std::chrono::milliseconds(10));
+    }
+
+    HANDLE_CHECK(ran == 4);
+    for (auto const& outcome : outcomes)
+    {
+        HANDLE_CHECK(outcome.m_Calls == 1 && outcome.m_Result == 0);
+    }
+
+    HANDLE_CHECK(engine.Post(&Record, &overflow));
+    RunUntil(engine, overflow);
+    HANDLE_CHECK(overflow.m_Calls == 1);
+}
+
+#if !defined(_WIN32)
+HANDLE_TEST(CompletionEngine, SocketRoundTrip)
+{
+    int fds[2];
+    HANDLE_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+    SocketHandle left(fds[0]);
+    SocketHandle right(fds[1]);
+
+    CompletionEngine engine(1);
+    HANDLE_CHECK(engine.Associate(left) && engine.Associate(right));
+    HANDLE_CHECK(!engine.Associate(left));
+
+    // Parked until the write below makes the socket readable
+    std::byte received[16] = {};
+    Outcome read;
+    HANDLE_CHECK(engine.Read(right, received, 0, &Record, &read));
+    HANDLE_CHECK(engine.RunOnce(std::chrono::milliseconds::zero()) == 0 && read.m_Calls == 0);
+
+    char const payload[] = "round trip data";
+    Outcome written;
+    HANDLE_CHECK(engine.Write(left, std::as_bytes(std::span(payload)), 0, &Record, &written));
+
+    RunUntil(engine, written);
+    RunUntil(engine, read);
+    HANDLE_CHECK(written.m_Calls == 1 && written.m_Result == sizeof(payload));
+    HANDLE_CHECK(read.m_Calls == 1 && read.m_Result == sizeof(payload));
+    HANDLE_CHECK(std::memcmp(received, payload, sizeof(payload)) == 0);
+
+    // Disassociating fails what is still parked
+    Outcome cancelled;
+    HANDLE_CHECK(engine.Read(right, received, 0, &Record, &cancelled));
+    engine.Disassociate(right);
+    RunUntil(engine, cancelled);
+    HANDLE_CHECK(cancelled.m_Calls == 1 && cancelled.m_Result == -ECANCELED);
+
+    // A closed peer reads as end of stream
+    HANDLE_CHECK(engine.Associate(right));
+    engine.Disassociate(left);
+    left.Close();
+
+    Outcome closed;
+    HANDLE_CHECK(engine.Read(right, received, 0, &Record, &closed));
+    RunUntil(engine, closed);
+    HANDLE_CHECK(closed.m_Calls == 1 && closed.m_Result == 0);
+
+    engine.Disassociate(right);
+}
+#endif
@@ -0,0 +1,185 @@
+#include "coroutine_io.hpp"
+#include "test.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    IoTask<int> Constant(int value)
+    {
+        co_return value;
+    }
+
+    /*
+     * @brief Thread-exit holder of a task, constructed before the frame cache so destroyed after it
+     */
+    struct LateTask
+    {
+        std::optional<IoTask<int>> m_Task;
+    };
+
+    thread_local LateTask t_LateTask;
+
+#if !defined(_WIN32)
+    /*
+     * @brief Drives `engine` on the calling thread until `done` is set or `rounds` dequeues passed
+     */
+    void RunUntil(CompletionEngine& engine, bool const& done, int rounds = 100)
+    {
+        while (!done && rounds-- > 0)
+        {
+            engine.RunOnce(std::chrono::milliseconds(10));
+        }
+    }
+
+    template<typename _Handle>
+    IoTask<> WaitOnce(CompletionEngine& engine, _Handle const& handle, std::int64_t& result, bool& done)
+    {
+        result = co_await WaitAsync(engine, handle);
+        done   = true;
+    }
+
+    /*
+     * @brief Accepts one connection on `listener` and echoes its first message back
+     */
+    IoTask<> EchoOnce(CompletionEngine& engine, SocketHandle const& listener, std::int64_t& echoed, bool& done)
+    {
+        auto const accepted = co_await AcceptAsync(engine, listener);
+        if (accepted < 0)
+        {
+            echoed = accepted;
+            done   = true;
+            co_return;
+        }
+
+        SocketHandle connection(static_cast<int>(accepted));
+        engine.Associate(connection);
+
+        std::byte buffer[64];
+        auto const received = co_await ReceiveAsync(engine, connection, buffer);
+        echoed = received <= 0
+            ? received
+            : co_await SendAsync(engine, connection, std::span<std::byte const>(buffer, static_cast<std::size_t>(received)));
+
+        engine.Disassociate(connection);
+        done = true;
+    }
+#endif
+}
+
+HANDLE_TEST(CoroutineIo, FrameFreedAfterThreadCache)
+{
+    // t_LateTask is touched first, so its frame is released after the thread's frame cache died
+    std::thread([]
+    {
+        t_LateTask.m_Task.reset();
+        t_LateTask.m_Task.emplace(Constant(1));
+        HANDLE_CHECK(t_LateTask.m_Task->Valid());
+    }).join();
+
+    auto task = Constant(2);
+    HANDLE_CHECK(task.Valid());
+}
+
+#if !defined(_WIN32)
+HANDLE_TEST(CoroutineIo, SocketWaitKeepsPayload)
+{
+    int fds[2];
+    HANDLE_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+    SocketHandle reader(fds[0]);
+    SocketHandle writer(fds[1]);
+
+    CompletionEngine engine(1);
+    HANDLE_CHECK(engine.Valid() && engine.Associate(reader));
+
+    std::int64_t result = -1;
+    bool done = false;
+    WaitOnce(engine, reader, result, done).Start();
+    HANDLE_CHECK(!done);
+
+    char const payload[] = "0123456789abcdef";
+    HANDLE_CHECK(::send(writer.Get(), payload, sizeof(payload), 0) == sizeof(payload));
+
+    RunUntil(engine, done);
+    HANDLE_CHECK(done && result == 0);
+
+    // The wait only observed readability, every byte is still queued
+    char received[sizeof(payload)] = {};
+    HANDLE_CHECK(::recv(reader.Get(), received, sizeof(received), 0) == sizeof(received));
+    HANDLE_CHECK(std::memcmp(received, payload, sizeof(payload)) == 0);
+
+    engine.Disassociate(reader);
+}
+
+HANDLE_TEST(CoroutineIo, EventWaitConsumesCounter)
+{
+    EventHandle event(::eventfd(0, EFD_CLOEXEC));
+    CompletionEngine engine(1);
+    HANDLE_CHECK(engine.Associate(event));
+
+    std::int64_t result = -1;
+    bool done = false;
+    WaitOnce(engine, event, result, done).Start();
+
+    (void)::eventfd_write(event, 3);
+    RunUntil(engine, done);
+    HANDLE_CHECK(done && result == 0);
+
+    // Reset like a satisfied auto-reset event, the engine made the descriptor non-blocking
+    eventfd_t value;
+    HANDLE_CHECK(::eventfd_read(event, &value) != 0 && errno == EAGAIN);
+
+    engine.Disassociate(event);
+}
+
+HANDLE_TEST(CoroutineIo, AcceptReceiveSend)
+{
+    SocketHandle listener(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    sockaddr_in address{};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t length = sizeof(address);
+    HANDLE_CHECK(::bind(listener.Get(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0);
+    HANDLE_CHECK(::listen(listener.Get(), 1) == 0);
+    HANDLE_CHECK(::getsockname(listener.Get(), reinterpret_cast<sockaddr*>(&address), &length) == 0);
+
+    CompletionEngine engine(1);
+    HANDLE_CHECK(engine.Associate(listener));
+
+    std::int64_t echoed = 0;
+    bool done = false;
+    EchoOnce(engine, listener, echoed, done).Start();
+    HANDLE_CHECK(!done);
+
+    SocketHandle client(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    HANDLE_CHECK(::connect(client.Get(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0);
+
+    char const payload[] = "echo through the engine";
+    HANDLE_CHECK(::send(client.Get(), payload, sizeof(payload), 0) == sizeof(payload));
+
+    RunUntil(engine, done);
+    HANDLE_CHECK(done && echoed == sizeof(payload));
+
+    char received[sizeof(payload)] = {};
+    HANDLE_CHECK(::recv(client.Get(), received, sizeof(received), MSG_WAITALL) == sizeof(received));
+    HANDLE_CHECK(std::memcmp(received, payload, sizeof(payload)) == 0);
+
+    engine.Disassociate(listener);
+}
+#endif
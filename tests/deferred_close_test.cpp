@@ -0,0 +1,81 @@
+#include "deferred_close.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t CountedHandles = 4096;
+
+    std::array<std::atomic<int>, CountedHandles> g_Closes{};
+
+    /*
+     * @brief Traits whose handles are indices into g_Closes, closing one counts it
+     */
+    struct CountedTraits
+    {
+        using Type = std::intptr_t;
+
+        static void Close(Type handle) noexcept
+        {
+            g_Closes[static_cast<std::size_t>(handle)].fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+}
+
+HANDLE_TEST(DeferredCloser, FlushWaitsForEveryEnqueue)
+{
+    // A small ring so that producers also hit the inline path
+    DeferredCloser closer(16, 4);
+
+    std::vector<std::thread> producers;
+    for (std::size_t thread = 0; thread < 4; ++thread)
+    {
+        producers.emplace_back([&closer, thread]
+        {
+            for (std::size_t i = thread; i < CountedHandles; i += 4)
+            {
+                closer.Enqueue<CountedTraits>(static_cast<std::intptr_t>(i));
+            }
+        });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    closer.Flush();
+    for (auto const& closes : g_Closes)
+    {
+        HANDLE_CHECK(closes.load() == 1);
+    }
+
+    // Flush with nothing queued returns at once
+    closer.Flush();
+}
+
+#if !defined(_WIN32)
+HANDLE_TEST(DeferredCloser, DeferredHandleClosedByFlush)
+{
+    auto const raw = ::eventfd(0, EFD_CLOEXEC);
+    HANDLE_CHECK(raw >= 0);
+
+    {
+        DeferredHandle<TaggedHandle<HandleType::Event>> event(raw);
+    }
+
+    DeferredCloser::Instance().Flush();
+    HANDLE_CHECK(::fcntl(raw, F_GETFD) == -1);
+}
+#endif
@@ -0,0 +1,101 @@
+#include "event_pool.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#endif
+
+namespace
+{
+    using Pool = EventPool<EventReset::Auto>;
+
+    void Signal(PooledEventHandle<> const& event) noexcept
+    {
+#if defined(_WIN32)
+        ::SetEvent(event.Get());
+#else
+        (void)::eventfd_write(event.Get(), 1);
+#endif
+    }
+
+    [[nodiscard]] bool Signaled(PooledEventHandle<> const& event) noexcept
+    {
+#if defined(_WIN32)
+        return ::WaitForSingleObject(event.Get(), 0) == WAIT_OBJECT_0;
+#else
+        eventfd_t value;
+        return ::eventfd_read(event.Get(), &value) == 0 || errno != EAGAIN;
+#endif
+    }
+
+    /*
+     * @brief Thread-exit holder of an event, constructed before the thread cache so released after it
+     */
+    struct LateEvent
+    {
+        std::optional<PooledEventHandle<>> m_Event;
+    };
+
+    thread_local LateEvent t_LateEvent;
+}
+
+HANDLE_TEST(EventPool, ReleasedEventIsReusedReset)
+{
+    auto& pool = Pool::Instance();
+
+    auto event = pool.Acquire();
+    HANDLE_CHECK(event.Valid());
+    auto const raw     = event.Get();
+    auto const created = pool.Created();
+
+    // Back into this thread's cache, which hands it out next, reset
+    Signal(event);
+    event = PooledEventHandle<>();
+
+    auto reused = pool.Acquire();
+    HANDLE_CHECK(reused.Get() == raw && pool.Created() == created);
+    HANDLE_CHECK(!Signaled(reused));
+}
+
+HANDLE_TEST(EventPool, ThreadExitKeepsEvents)
+{
+    constexpr std::size_t Count = 8;
+
+    auto& pool = Pool::Instance();
+    pool.Trim();
+
+    // The cached events go to the global freelist with the thread cache, the late one after it
+    std::thread([&pool]
+    {
+        t_LateEvent.m_Event.emplace();
+
+        std::array<PooledEventHandle<>, Count> events;
+        for (auto& event : events)
+        {
+            event = pool.Acquire();
+            HANDLE_CHECK(event.Valid());
+        }
+
+        *t_LateEvent.m_Event = pool.Acquire();
+    }).join();
+
+    auto const created = pool.Created();
+
+    // A fresh thread refills its empty cache from the freelist and creates nothing
+    std::thread([&pool]
+    {
+        std::array<PooledEventHandle<>, Count + 1> events;
+        for (auto& event : events)
+        {
+            event = pool.Acquire();
+            HANDLE_CHECK(event.Valid());
+        }
+    }).join();
+
+    HANDLE_CHECK(pool.Created() == created);
+}
@@ -0,0 +1,132 @@
+#include "file_handle_cache.hpp"
+#include "test.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /*
+     * @brief Fresh scratch directory, removed with its contents on destruction
+     */
+    struct ScratchDirectory
+    {
+        std::filesystem::path m_Path;
+
+        explicit ScratchDirectory(char const* name)
+            : m_Path(std::filesystem::temp_directory_path() / name)
+        {
+            std::filesystem::remove_all(m_Path);
+            std::filesystem::create_directories(m_Path);
+        }
+
+        ~ScratchDirectory()
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_Path, error);
+        }
+    };
+
+    /*
+     * @brief Writes `contents` next to `path` and renames it over, the way files are replaced atomically
+     */
+    void Replace(std::filesystem::path const& path, std::string const& contents)
+    {
+        auto temporary = path;
+        temporary += ".new";
+        std::ofstream(temporary, std::ios::binary) << contents;
+        std::filesystem::rename(temporary, path);
+    }
+
+    [[nodiscard]] std::string ReadFront(FileLease const& file, std::size_t size)
+    {
+        std::string contents(size, '\0');
+#if defined(_WIN32)
+        OVERLAPPED position{};
+        DWORD read = 0;
+        ::ReadFile(file.Get(), contents.data(), static_cast<DWORD>(size), &read, &position);
+#else
+        auto const read = ::pread(file.Get(), contents.data(), size, 0);
+#endif
+        contents.resize(read > 0 ? static_cast<std::size_t>(read) : 0);
+        return contents;
+    }
+
+    [[nodiscard]] bool WaitForSize(FileHandleCache& cache, std::size_t size)
+    {
+        for (int round = 0; round < 5000 && cache.Size() != size; ++round)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return cache.Size() == size;
+    }
+}
+
+HANDLE_TEST(FileHandleCache, InvalidateAfterReplace)
+{
+    ScratchDirectory directory("handle_test_cache");
+    auto const path = directory.m_Path / "file.txt";
+    Replace(path, "first");
+
+    FileHandleCache cache(8, 2);
+    auto const first = cache.Open(path);
+    HANDLE_CHECK(first.Valid() && cache.Misses() == 1);
+
+    // Equivalent spellings hit the same entry
+    auto const again = cache.Open(directory.m_Path / "." / "file.txt");
+    HANDLE_CHECK(again.Get() == first.Get() && cache.Hits() == 1);
+
+    // The cached handle still refers to the replaced file until invalidated
+    Replace(path, "second");
+    HANDLE_CHECK(ReadFront(cache.Open(path), 6) == "first");
+
+    cache.Invalidate(path);
+    HANDLE_CHECK(cache.Size() == 0);
+
+    auto const fresh = cache.Open(path);
+    HANDLE_CHECK(ReadFront(fresh, 6) == "second" && cache.Misses() == 2);
+
+    // Leases taken before the invalidation keep their file open
+    HANDLE_CHECK(ReadFront(first, 5) == "first");
+
+    HANDLE_CHECK(!cache.Open(directory.m_Path / "missing").Valid() && cache.Size() == 1);
+}
+
+HANDLE_TEST(FileHandleCache, WatchDropsReplacedAndDeleted)
+{
+    ScratchDirectory directory("handle_test_watch");
+    std::filesystem::create_directories(directory.m_Path / "nested");
+
+    auto const replaced = directory.m_Path / "replaced.txt";
+    auto const deleted  = directory.m_Path / "deleted.txt";
+    auto const nested   = directory.m_Path / "nested" / "kept.txt";
+    Replace(replaced, "old");
+    Replace(deleted, "gone");
+    Replace(nested, "kept");
+
+    FileHandleCache cache(8, 2);
+    HANDLE_CHECK(cache.Open(replaced).Valid() && cache.Open(deleted).Valid() && cache.Open(nested).Valid());
+    HANDLE_CHECK(cache.Size() == 3);
+    HANDLE_CHECK(cache.Watch(directory.m_Path));
+
+    Replace(replaced, "new");
+    HANDLE_CHECK(WaitForSize(cache, 2));
+    HANDLE_CHECK(ReadFront(cache.Open(replaced), 3) == "new");
+
+    std::filesystem::remove(deleted);
+    HANDLE_CHECK(WaitForSize(cache, 2));
+    HANDLE_CHECK(!cache.Open(deleted).Valid());
+
+    // Watches are not recursive, the tree is dropped explicitly
+    cache.InvalidateTree(directory.m_Path / "nested");
+    HANDLE_CHECK(cache.Size() == 1);
+}
@@ -0,0 +1,131 @@
+#include "handle_table.hpp"
+#include "test.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace
+{
+    [[nodiscard]] EventHandle NewEvent() noexcept
+    {
+#if defined(_WIN32)
+        return EventHandle(::CreateEventW(nullptr, FALSE, FALSE, nullptr));
+#else
+        return EventHandle(::eventfd(0, EFD_CLOEXEC));
+#endif
+    }
+
+    [[nodiscard]] bool IsOpen(NativeHandle handle) noexcept
+    {
+#if defined(_WIN32)
+        DWORD flags;
+        return ::GetHandleInformation(handle, &flags);
+#else
+        return ::fcntl(handle, F_GETFD) != -1;
+#endif
+    }
+}
+
+HANDLE_TEST(HandleTable, InsertFindErase)
+{
+    HandleTable<TaggedHandle<HandleType::Event>> table;
+
+    auto const id  = table.Insert(NewEvent());
+    auto const raw = table.Get(id);
+    HANDLE_CHECK(id.Valid() && table.Contains(id) && table.Size() == 1);
+    HANDLE_CHECK(table.Find(id) && table.Find(id)->Get() == raw);
+
+    HANDLE_CHECK(table.Erase(id));
+    HANDLE_CHECK(!IsOpen(raw) && table.Empty());
+    HANDLE_CHECK(!table.Erase(id));
+}
+
+HANDLE_TEST(HandleTable, StaleGenerationNeverResolves)
+{
+    HandleTable<TaggedHandle<HandleType::Event>> table;
+
+    auto const stale = table.Insert(NewEvent());
+    HANDLE_CHECK(table.Erase(stale));
+
+    // The freed slot is reused with the next generation, possibly for the same raw value
+    auto const fresh = table.Insert(NewEvent());
+    HANDLE_CHECK(fresh.m_Index == stale.m_Index && fresh.m_Generation != stale.m_Generation);
+
+    HANDLE_CHECK(!table.Contains(stale));
+    HANDLE_CHECK(table.Find(stale) == nullptr);
+    HANDLE_CHECK(!EventHandle::Traits::Valid(table.Get(stale)));
+    HANDLE_CHECK(!table.Extract(stale).Valid());
+    HANDLE_CHECK(!table.Erase(stale));
+
+    HANDLE_CHECK(table.Contains(fresh) && table.Size() == 1);
+
+    // Clear() makes every outstanding id stale as well
+    table.Clear();
+    HANDLE_CHECK(!table.Contains(fresh) && table.Find(fresh) == nullptr);
+
+    HANDLE_CHECK(!table.Contains(HandleId{}));
+}
+
+HANDLE_TEST(HandleTable, EraseKeepsOtherIdsAndDenseIteration)
+{
+    HandleTable<TaggedHandle<HandleType::Event>> table;
+
+    std::vector<HandleId>     ids;
+    std::vector<NativeHandle> raws;
+    for (int i = 0; i < 100; ++i)
+    {
+        ids.push_back(table.Insert(NewEvent()));
+        raws.push_back(table.Get(ids.back()));
+    }
+
+    // Erasing moves the last dense element into the hole, ids must follow it
+    for (std::size_t i = 0; i < ids.size(); i += 3)
+    {
+        HANDLE_CHECK(table.Erase(ids[i]));
+    }
+
+    std::size_t live = 0;
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        if (i % 3 == 0)
+        {
+            HANDLE_CHECK(!table.Contains(ids[i]));
+            continue;
+        }
+
+        HANDLE_CHECK(table.Get(ids[i]) == raws[i]);
+        ++live;
+    }
+
+    HANDLE_CHECK(table.Size() == live);
+
+    std::size_t iterated = 0;
+    for (auto const& handle : table)
+    {
+        HANDLE_CHECK(handle.Valid());
+        ++iterated;
+    }
+
+    HANDLE_CHECK(iterated == live);
+    for (std::size_t dense = 0; dense < table.Size(); ++dense)
+    {
+        HANDLE_CHECK(table.Find(table.IdAt(dense)) == std::addressof(table.Handles()[dense]));
+    }
+}
+
+HANDLE_TEST(HandleTable, ExtractDoesNotClose)
+{
+    HandleTable<TaggedHandle<HandleType::Event>> table;
+
+    auto const id = table.Insert(NewEvent());
+    auto extracted = table.Extract(id);
+    HANDLE_CHECK(extracted.Valid() && IsOpen(extracted.Get()));
+    HANDLE_CHECK(!table.Contains(id) && table.Empty());
+}
@@ -0,0 +1,177 @@
+#include "handle.hpp"
+#include "test.hpp"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace
+{
+    int g_Closed = 0;
+
+    /*
+     * @brief Close policy counting the handles it closes
+     */
+    struct CountClose
+    {
+        template<typename _Traits>
+        static void Close(typename _Traits::Type handle) noexcept
+        {
+            ++g_Closed;
+            _Traits::Close(handle);
+        }
+    };
+
+    using CountedEvent = Handle<TaggedHandle<HandleType::Event>, CountClose>;
+
+    [[nodiscard]] NativeHandle NewEvent() noexcept
+    {
+#if defined(_WIN32)
+        return ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#else
+        return ::eventfd(0, EFD_CLOEXEC);
+#endif
+    }
+
+    /*
+     * @brief Whether `handle` still refers to an open kernel object
+     */
+    [[nodiscard]] bool IsOpen(NativeHandle handle) noexcept
+    {
+#if defined(_WIN32)
+        DWORD flags;
+        return ::GetHandleInformation(handle, &flags);
+#else
+        return ::fcntl(handle, F_GETFD) != -1;
+#endif
+    }
+}
+
+static_assert(std::is_nothrow_move_constructible_v<EventHandle> && std::is_nothrow_move_assignable_v<EventHandle>);
+static_assert(!std::is_copy_constructible_v<EventHandle> && !std::is_copy_assignable_v<EventHandle>);
+
+HANDLE_TEST(Handle, DefaultIsInvalid)
+{
+    EventHandle event;
+    HANDLE_CHECK(!event.Valid());
+    HANDLE_CHECK(HandleToBits(event.Get()) == EventHandle::Traits::InvalidHandleBits);
+
+    FileHandle file;
+    HANDLE_CHECK(!file.Valid());
+    HANDLE_CHECK(HandleToBits(file.Get()) == FileHandle::Traits::InvalidHandleBits);
+}
+
+HANDLE_TEST(Handle, MoveTransfersOwnership)
+{
+    g_Closed = 0;
+
+    CountedEvent first(NewEvent());
+    HANDLE_CHECK(first.Valid());
+    auto const raw = first.Get();
+
+    CountedEvent second(std::move(first));
+    HANDLE_CHECK(!first.Valid());
+    HANDLE_CHECK(second.Get() == raw);
+    HANDLE_CHECK(g_Closed == 0);
+
+    // Assignment closes the target's old handle and nothing else
+    CountedEvent third(NewEvent());
+    auto const replaced = third.Get();
+    third = std::move(second);
+    HANDLE_CHECK(g_Closed == 1);
+    HANDLE_CHECK(!IsOpen(replaced));
+    HANDLE_CHECK(third.Get() == raw && IsOpen(raw));
+
+    // Self-move keeps the handle
+    auto& alias = third;
+    third = std::move(alias);
+    HANDLE_CHECK(third.Get() == raw && g_Closed == 1);
+
+    third.Close();
+    HANDLE_CHECK(g_Closed == 2 && !third.Valid());
+
+    third.Close();
+    HANDLE_CHECK(g_Closed == 2);
+}
+
+HANDLE_TEST(Handle, VectorGrowthNeverCloses)
+{
+    g_Closed = 0;
+    {
+        std::vector<CountedEvent> events;
+        for (int i = 0; i < 64; ++i)
+        {
+            events.emplace_back(NewEvent());
+            HANDLE_CHECK(events.back().Valid());
+        }
+
+        HANDLE_CHECK(g_Closed == 0);
+    }
+
+    HANDLE_CHECK(g_Closed == 64);
+}
+
+HANDLE_TEST(Handle, ReleaseAndReset)
+{
+    g_Closed = 0;
+
+    CountedEvent event(NewEvent());
+    auto const raw = event.Release();
+    HANDLE_CHECK(!event.Valid());
+    HANDLE_CHECK(IsOpen(raw));
+
+    event.Reset(raw);
+    HANDLE_CHECK(event.Get() == raw && g_Closed == 0);
+
+    event.Reset(NewEvent());
+    HANDLE_CHECK(g_Closed == 1 && event.Valid() && event.Get() != raw);
+
+    event.Reset();
+    HANDLE_CHECK(g_Closed == 2 && !event.Valid());
+
+    // Releasing an invalid handle yields the sentinel
+    HANDLE_CHECK(HandleToBits(event.Release()) == CountedEvent::Traits::InvalidHandleBits);
+}
+
+HANDLE_TEST(Handle, SentinelTraits)
+{
+#if defined(_WIN32)
+    static_assert(HandleTraits<TaggedHandle<HandleType::Event>>::InvalidHandleBits == 0);
+    static_assert(HandleTraits<TaggedHandle<HandleType::Semaphore>>::InvalidHandleBits == 0);
+    static_assert(HandleTraits<TaggedHandle<HandleType::FileMapping>>::InvalidHandleBits == 0);
+    static_assert(HandleTraits<TaggedHandle<HandleType::File>>::InvalidHandleBits == -1);
+    static_assert(HandleTraits<TaggedHandle<HandleType::Snapshot>>::InvalidHandleBits == -1);
+
+    HANDLE_CHECK(!FileMappingHandle::Traits::Valid(nullptr));
+    HANDLE_CHECK(FileMappingHandle::Traits::Valid(INVALID_HANDLE_VALUE));
+    HANDLE_CHECK(!FileHandle::Traits::Valid(INVALID_HANDLE_VALUE));
+
+    // INVALID_SOCKET is ~0, 0 is a valid socket
+    static_assert(HandleTraits<SOCKET>::InvalidHandleBits == -1);
+    HANDLE_CHECK(!SocketHandle::Traits::Valid(INVALID_SOCKET));
+    HANDLE_CHECK(SocketHandle::Traits::Valid(0));
+#else
+    static_assert(HandleTraits<TaggedHandle<HandleType::Event>>::InvalidHandleBits == -1);
+    static_assert(HandleTraits<TaggedHandle<HandleType::FileMapping>>::InvalidHandleBits == -1);
+    static_assert(HandleTraits<TaggedHandle<HandleType::Socket>>::InvalidHandleBits == -1);
+
+    // Descriptor 0 is a valid descriptor, socket or not
+    HANDLE_CHECK(SocketHandle::Traits::Valid(0));
+    HANDLE_CHECK(!SocketHandle::Traits::Valid(-1));
+    HANDLE_CHECK(FileHandle::Traits::Valid(0));
+
+    // Descriptor sentinels are constant expressions all the way through Valid()
+    static_assert(!HandleTraits<TaggedHandle<HandleType::Event>>::Valid(HandleTraits<TaggedHandle<HandleType::Event>>::InvalidHandleValue()));
+#endif
+
+    static_assert(HandleHasCapability<TaggedHandle<HandleType::Event>>(HandleCapabilities::Waitable));
+    static_assert(HandleHasCapability<TaggedHandle<HandleType::File>>(HandleCapabilities::Overlapped));
+    static_assert(!HandleHasCapability<TaggedHandle<HandleType::FileMapping>>(HandleCapabilities::Waitable));
+
+    static_assert(TaggedHandle<HandleType::File>::GetHandleInvalidBits() == HandleTraits<TaggedHandle<HandleType::File>>::InvalidHandleBits);
+}
@@ -0,0 +1,120 @@
+#include "handle.hpp"
+#include "test.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+/*
+ * Built into handle_tracking_tests with HANDLE_ENABLE_TRACKING and HANDLE_TRACK_CALL_SITES,
+ * Handle<_Ty> has a different layout there and cannot share a binary with handle_tests.
+ */
+namespace
+{
+    enum class Counted : std::intptr_t {};
+}
+
+template<>
+struct HandleTraits<Counted>
+{
+    using Type = Counted;
+
+    static constexpr std::intptr_t InvalidHandleBits = -1;
+
+    [[nodiscard]] static constexpr Type InvalidHandleValue() noexcept
+    {
+        return HandleFromBits<Type>(InvalidHandleBits);
+    }
+
+    static void Close(Type) noexcept {}
+
+    [[nodiscard]] static constexpr bool Valid(Type handle) noexcept
+    {
+        return HandleToBits(handle) != InvalidHandleBits;
+    }
+};
+
+namespace
+{
+    [[nodiscard]] HandleTagCensus Census(HandleCensus const& census) noexcept
+    {
+        for (auto const& tag : census.m_Tags)
+        {
+            if (tag.m_Name == HandleTypeName<Counted>())
+            {
+                return tag;
+            }
+        }
+
+        return { HandleTypeName<Counted>(), 0, 0, 0, 0, 0 };
+    }
+
+    [[nodiscard]] std::size_t CountEvents(HandleCensus const& census, std::intptr_t handle, bool open) noexcept
+    {
+        std::size_t count = 0;
+        for (auto const& event : census.m_Events)
+        {
+            if (event.m_Name == HandleTypeName<Counted>() && event.m_Handle == handle && event.m_Open == open)
+            {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+}
+
+HANDLE_TEST(HandleTracker, CensusCountsTransitions)
+{
+    {
+        Handle<Counted> first(Counted{ 1 });
+        Handle<Counted> second(Counted{ 2 });
+        Handle<Counted> third(Counted{ 3 });
+
+        auto const open = Census(HandleTracker::Snapshot());
+        HANDLE_CHECK(open.m_Live == 3 && open.m_Opened == 3 && open.m_Peak == 3);
+
+        second.Close();
+        (void)third.Release();
+
+        // Moves transfer the count, the moved-from handle closes nothing
+        Handle<Counted> moved(std::move(first));
+        HANDLE_CHECK(!first.Valid());
+
+        auto const after = Census(HandleTracker::Snapshot());
+        HANDLE_CHECK(after.m_Live == 1 && after.m_Closed == 1 && after.m_Released == 1);
+    }
+
+    auto const census = Census(HandleTracker::Snapshot());
+    HANDLE_CHECK(census.m_Live == 0 && census.m_Opened == 3 && census.m_Closed == 2);
+    HANDLE_CHECK(census.m_Released == 1 && census.m_Peak == 3);
+}
+
+HANDLE_TEST(HandleTracker, EventsCarryCallSites)
+{
+    std::uint32_t line = 0;
+    {
+        line = __LINE__ + 1;
+        Handle<Counted> handle(Counted{ 10 });
+    }
+
+    auto const census = HandleTracker::Snapshot(true);
+    HANDLE_CHECK(CountEvents(census, 10, true) == 1 && CountEvents(census, 10, false) == 1);
+
+    for (auto const& event : census.m_Events)
+    {
+        if (event.m_Handle == 10 && event.m_Open)
+        {
+            HANDLE_CHECK(event.m_Line == line);
+            HANDLE_CHECK(std::string_view(event.m_File).ends_with("handle_tracker_test.cpp"));
+        }
+    }
+
+    // An exited thread's buffer stays listed and is handed to the next thread
+    std::thread([] { Handle<Counted> handle(Counted{ 11 }); }).join();
+    std::thread([] { Handle<Counted> handle(Counted{ 12 }); }).join();
+
+    auto const threads = HandleTracker::Snapshot(true);
+    HANDLE_CHECK(CountEvents(threads, 11, true) == 1 && CountEvents(threads, 12, false) == 1);
+}
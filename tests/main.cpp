@@ -0,0 +1,36 @@
+#include "test.hpp"
+
+#include <cstdio>
+#include <string_view>
+
+/*
+ * @brief Runs the cases whose suite is `argv[1]`, or all of them without an argument
+ */
+int main(int argc, char** argv)
+{
+    std::string_view const suite = argc > 1 ? argv[1] : "";
+
+    int ran = 0;
+    for (auto* test = TestCase::Head(); test; test = test->m_Next)
+    {
+        std::string_view const name = test->m_Name;
+        if (!suite.empty() && (name.size() <= suite.size() || name.substr(0, suite.size()) != suite || name[suite.size()] != '.'))
+        {
+            continue;
+        }
+
+        std::printf("[ RUN  ] %s\n", test->m_Name);
+        std::fflush(stdout);
+        test->m_Run();
+        std::printf("[  OK  ] %s\n", test->m_Name);
+        ++ran;
+    }
+
+    if (ran == 0)
+    {
+        std::fprintf(stderr, "no test matches '%.*s'\n", static_cast<int>(suite.size()), suite.data());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "mapped_view.hpp"
+#include "test.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /*
+     * @brief Anonymous read-write mapping of `size` bytes, a pagefile section or a memfd
+     */
+    FileMappingHandle NewMapping(std::size_t size) noexcept
+    {
+#if defined(_WIN32)
+        return FileMappingHandle(::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                                      static_cast<DWORD>(std::uint64_t(size) >> 32), static_cast<DWORD>(size), nullptr));
+#else
+        FileMappingHandle mapping(::memfd_create("handle_test_view", MFD_CLOEXEC));
+        if (mapping.Valid() && ::ftruncate(mapping, static_cast<off_t>(size)) != 0)
+        {
+            mapping.Close();
+        }
+
+        return mapping;
+#endif
+    }
+
+    [[nodiscard]] std::byte Pattern(std::uint64_t offset) noexcept
+    {
+        return static_cast<std::byte>(offset * 7 + offset / 251);
+    }
+}
+
+HANDLE_TEST(MappedView, UnalignedWindows)
+{
+    auto const granularity = MapAllocationGranularity();
+    auto const mapping     = NewMapping(3 * granularity);
+    HANDLE_CHECK(mapping.Valid());
+
+    {
+        MappedView whole(mapping, 0, 3 * granularity, MapAccess::ReadWrite);
+        HANDLE_CHECK(whole.Valid());
+
+        auto const bytes = whole.WritableBytes();
+        for (std::size_t i = 0; i < bytes.size(); ++i)
+        {
+            bytes[i] = Pattern(i);
+        }
+
+        HANDLE_CHECK(whole.Flush());
+    }
+
+    // Windows straddling a granularity boundary start exactly at the requested byte
+    for (std::uint64_t offset : { std::uint64_t(1), granularity - 5, 2 * granularity + 3 })
+    {
+        MappedView view(mapping, offset, 10);
+        HANDLE_CHECK(view.Valid() && view.Size() == 10 && view.Bytes().size() == 10);
+
+        for (std::size_t i = 0; i < view.Size(); ++i)
+        {
+            HANDLE_CHECK(view.Data()[i] == Pattern(offset + i));
+        }
+
+        // Hints round the window out to whole pages, offsets past its end are refused
+        HANDLE_CHECK(view.Prefetch(3, 4) && view.Advise(MapAdvice::DontNeed));
+        HANDLE_CHECK(!view.Prefetch(view.Size()));
+    }
+
+    // Writes through an unaligned window land at the same offset of the mapping
+    {
+        MappedView writer(mapping, granularity + 17, 4, MapAccess::ReadWrite);
+        HANDLE_CHECK(writer.Valid() && writer.WritableData() == writer.Data());
+        writer.WritableData()[0] = std::byte{ 0xAB };
+        HANDLE_CHECK(writer.Flush(0, 1));
+    }
+
+    MappedView reader(mapping, granularity + 16, 2);
+    HANDLE_CHECK(reader.Bytes()[0] == Pattern(granularity + 16) && reader.Bytes()[1] == std::byte{ 0xAB });
+
+    HANDLE_CHECK(!MappedView(mapping, 0, 0).Valid());
+}
+
+HANDLE_TEST(MappedView, ReadOnlyAccessors)
+{
+    auto const mapping = NewMapping(MapAllocationGranularity());
+    HANDLE_CHECK(mapping.Valid());
+
+    MappedView view(mapping, 5, 100);
+    HANDLE_CHECK(view.Valid() && view.Access() == MapAccess::Read);
+    HANDLE_CHECK(view.WritableData() == nullptr && view.WritableBytes().empty());
+    HANDLE_CHECK(view.Data() != nullptr && view.Bytes().size() == 100);
+
+    // Copy-on-write pages are writable but never reach the mapping
+    {
+        MappedView copy(mapping, 5, 100, MapAccess::Copy);
+        HANDLE_CHECK(copy.WritableBytes().size() == 100);
+        copy.WritableData()[0] = std::byte{ 0x5A };
+        HANDLE_CHECK(copy.Data()[0] == std::byte{ 0x5A });
+    }
+
+    HANDLE_CHECK(view.Data()[0] == std::byte{ 0 });
+
+    MappedView moved(std::move(view));
+    HANDLE_CHECK(!view.Valid() && view.WritableBytes().empty() && moved.Access() == MapAccess::Read);
+
+    moved.Reset();
+    HANDLE_CHECK(!moved.Valid() && moved.Bytes().empty());
+}
+
+HANDLE_TEST(MappedView, MappedFileCoversWholeFile)
+{
+    auto const path = std::filesystem::temp_directory_path() / "handle_test_mapped";
+    std::string const contents = "mapped file contents";
+
+    {
+#if defined(_WIN32)
+        FileHandle file(::CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+        DWORD written = 0;
+        ::WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr);
+#else
+        FileHandle file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+        HANDLE_CHECK(::write(file, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size()));
+#endif
+    }
+
+    {
+        MappedFile file(path);
+        HANDLE_CHECK(file.Valid() && file.Size() == contents.size());
+        HANDLE_CHECK(std::string(reinterpret_cast<char const*>(file.Bytes().data()), file.Bytes().size()) == contents);
+    }
+
+    std::filesystem::resize_file(path, 0);
+    {
+        MappedFile empty(path);
+        HANDLE_CHECK(empty.Valid() && empty.Size() == 0 && empty.Bytes().empty());
+    }
+
+    std::filesystem::remove(path);
+    HANDLE_CHECK(!MappedFile(path).Valid());
+}
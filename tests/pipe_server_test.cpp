@@ -0,0 +1,128 @@
+#include "pipe_server.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::filesystem::path ServerName()
+    {
+#if defined(_WIN32)
+        return L"\\\\.\\pipe\\handle_test_" + std::to_wstring(::_getpid());
+#else
+        return std::filesystem::temp_directory_path() / ("handle_test_" + std::to_string(::getpid()) + ".sock");
+#endif
+    }
+
+    /*
+     * @brief What the server side observed, written by the engine worker
+     */
+    struct Session
+    {
+        std::atomic<int>  m_Accepted{ 0 };
+        std::atomic<int>  m_Messages{ 0 };
+        std::atomic<int>  m_Closed{ 0 };
+        std::atomic<int>  m_Stopped{ 0 };
+    };
+
+    IoTask<> Echo(PipeConnection connection, Session& session)
+    {
+        for (;;)
+        {
+            auto const message = co_await connection.Receive();
+            if (message.empty() || co_await connection.Send(message) <= 0)
+            {
+                break;
+            }
+
+            ++session.m_Messages;
+        }
+
+        connection.Close();
+        ++session.m_Closed;
+    }
+
+    IoTask<> Serve(PipeServer& server, Session& session)
+    {
+        for (;;)
+        {
+            auto connection = co_await server.Accept();
+            if (!connection.Valid())
+            {
+                break;
+            }
+
+            ++session.m_Accepted;
+            Echo(std::move(connection), session).Start();
+        }
+
+        ++session.m_Stopped;
+    }
+
+    void WaitFor(std::atomic<int> const& counter, int value)
+    {
+        for (int round = 0; round < 10000 && counter.load() != value; ++round)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+HANDLE_TEST(PipeServer, AcceptReceiveClose)
+{
+    CompletionEngine engine(1, 256);
+    HANDLE_CHECK(engine.Valid());
+    engine.Start(1);
+
+    Session session;
+    std::optional<PipeServer> server;
+    server.emplace(engine, ServerName(), 2, 256);
+    HANDLE_CHECK(server->Valid());
+    Serve(*server, session).Start();
+
+    {
+        auto client = PipeConnect(ServerName());
+        HANDLE_CHECK(client.Valid());
+
+        // Each send comes back as one message, boundaries kept
+        for (std::size_t size : { std::size_t(1), std::size_t(100), std::size_t(256) })
+        {
+            std::array<std::byte, 256> sent;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                sent[i] = static_cast<std::byte>(i + size);
+            }
+
+            std::array<std::byte, 256> received{};
+            HANDLE_CHECK(PipeSend(client, std::span(sent.data(), size)) == static_cast<std::int64_t>(size));
+            HANDLE_CHECK(PipeReceive(client, received) == static_cast<std::int64_t>(size));
+            HANDLE_CHECK(std::memcmp(received.data(), sent.data(), size) == 0);
+        }
+    }
+
+    // The client hung up, the session sees an empty receive and closes its end
+    WaitFor(session.m_Closed, 1);
+    HANDLE_CHECK(session.m_Closed == 1);
+    HANDLE_CHECK(session.m_Accepted == 1 && session.m_Messages == 3);
+
+    // Destroying the server hands the pending Accept() an invalid connection
+    server.reset();
+    WaitFor(session.m_Stopped, 1);
+    HANDLE_CHECK(session.m_Stopped == 1);
+
+    engine.Stop();
+}
@@ -0,0 +1,177 @@
+#include "process_group.hpp"
+#include "process_spawn.hpp"
+#include "test.hpp"
+
+#if !defined(_WIN32)
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * @brief Plain directory standing in for a cgroup v2 root, removed with its contents
+     */
+    struct FakeRoot
+    {
+        std::filesystem::path m_Path;
+
+        FakeRoot()
+            : m_Path(std::filesystem::temp_directory_path() / ("handle_tests_cgroup_" + std::to_string(::getpid())))
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_Path, error);
+            std::filesystem::create_directories(m_Path);
+        }
+
+        ~FakeRoot()
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_Path, error);
+        }
+    };
+
+    [[nodiscard]] std::string ReadText(std::filesystem::path const& path)
+    {
+        std::ifstream file(path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void WriteText(std::filesystem::path const& path, std::string_view text)
+    {
+        std::ofstream(path, std::ios::trunc) << text;
+    }
+}
+
+HANDLE_TEST(ProcessGroup, LimitsOnFakeRoot)
+{
+    FakeRoot root;
+    std::filesystem::path path;
+    {
+        ProcessGroup group("limits", root.m_Path);
+        HANDLE_CHECK(group.Valid());
+
+        path = group.Path();
+        HANDLE_CHECK(path == root.m_Path / "limits" && std::filesystem::is_directory(path));
+
+        // The fake root has no cgroup.subtree_control, nothing may be created in it
+        HANDLE_CHECK(!std::filesystem::exists(root.m_Path / "cgroup.subtree_control"));
+
+        HANDLE_CHECK(group.SetMemoryLimit(std::uint64_t(64) << 20));
+        HANDLE_CHECK(ReadText(path / "memory.max") == "67108864\n");
+        HANDLE_CHECK(group.SetMemoryLimit(0));
+        HANDLE_CHECK(ReadText(path / "memory.max") == "max\n");
+
+        HANDLE_CHECK(group.SetActiveProcessLimit(16));
+        HANDLE_CHECK(ReadText(path / "pids.max") == "16\n");
+
+        HANDLE_CHECK(group.SetCpuRate(0));
+        HANDLE_CHECK(ReadText(path / "cpu.max") == "max 100000\n");
+
+        auto const processors = std::max(1u, std::thread::hardware_concurrency());
+        HANDLE_CHECK(group.SetCpuRate(50));
+        HANDLE_CHECK(ReadText(path / "cpu.max") == std::to_string(std::uint64_t(50'000) * processors) + " 100000\n");
+    }
+
+    // Plain control files do not keep a fake group alive
+    HANDLE_CHECK(!std::filesystem::exists(path));
+}
+
+HANDLE_TEST(ProcessGroup, AssignAndKillOnClose)
+{
+    FakeRoot root;
+
+    static constexpr std::string_view Arguments[] = { "60" };
+    SpawnOptions options;
+    options.m_Program   = "/bin/sleep";
+    options.m_Arguments = Arguments;
+
+    auto child = Spawn(options);
+    HANDLE_CHECK(child.Valid());
+    {
+        ProcessGroup group("assign", root.m_Path);
+        HANDLE_CHECK(group.Valid());
+
+        HANDLE_CHECK(ProcessIdOf(child.m_Process) == child.m_ProcessId);
+        HANDLE_CHECK(group.Assign(child.m_Process));
+        HANDLE_CHECK(ReadText(group.Path() / "cgroup.procs") == std::to_string(child.m_ProcessId) + "\n");
+
+        // Without cgroup.kill semantics the group signals every listed pid itself
+        group.SetKillOnClose(true);
+    }
+
+    HANDLE_CHECK(child.Wait() == 128 + SIGKILL);
+}
+
+HANDLE_TEST(ProcessGroup, MoveAssignClosesTarget)
+{
+    FakeRoot root;
+
+    static constexpr std::string_view Arguments[] = { "60" };
+    SpawnOptions options;
+    options.m_Program   = "/bin/sleep";
+    options.m_Arguments = Arguments;
+
+    auto child = Spawn(options);
+    HANDLE_CHECK(child.Valid());
+
+    ProcessGroup group("first", root.m_Path);
+    HANDLE_CHECK(group.Valid() && group.Assign(child.m_Process));
+    group.SetKillOnClose(true);
+
+    auto const first = group.Path();
+    group = ProcessGroup("second", root.m_Path);
+
+    // The overwritten group was closed like a destroyed one
+    HANDLE_CHECK(child.Wait() == 128 + SIGKILL);
+    HANDLE_CHECK(!std::filesystem::exists(first));
+    HANDLE_CHECK(group.Valid() && group.Path() == root.m_Path / "second");
+}
+
+HANDLE_TEST(ProcessGroup, EventsFromControlFiles)
+{
+    FakeRoot root;
+
+    // The watched files must exist before the group opens them
+    auto const path = root.m_Path / "events";
+    std::filesystem::create_directories(path);
+    WriteText(path / "cgroup.events", "populated 1\nfrozen 0\n");
+    WriteText(path / "memory.events", "low 0\nhigh 0\nmax 0\noom 0\noom_kill 0\n");
+    WriteText(path / "pids.events", "max 0\n");
+
+    ProcessGroup group("events", root.m_Path);
+    HANDLE_CHECK(group.Valid() && group.Port().Valid());
+
+    int memory = 0, pids = 0, empty = 0;
+    auto const handler = [&](ProcessGroupEvent event, std::uint32_t)
+    {
+        memory += event == ProcessGroupEvent::MemoryLimit;
+        pids   += event == ProcessGroupEvent::ActiveProcessLimit;
+        empty  += event == ProcessGroupEvent::Empty;
+    };
+
+    HANDLE_CHECK(group.WaitEvents(handler, std::chrono::milliseconds::zero()) == 0);
+
+    WriteText(path / "memory.events", "low 0\nhigh 0\nmax 2\noom 0\noom_kill 0\n");
+    WriteText(path / "pids.events", "max 1\n");
+    HANDLE_CHECK(group.WaitEvents(handler, std::chrono::milliseconds(1000)) == 2);
+    HANDLE_CHECK(memory == 1 && pids == 1 && empty == 0);
+
+    // Unchanged counters report nothing again
+    WriteText(path / "cgroup.events", "populated 0\nfrozen 0\n");
+    HANDLE_CHECK(group.WaitEvents(handler, std::chrono::milliseconds(1000)) == 1);
+    HANDLE_CHECK(memory == 1 && pids == 1 && empty == 1);
+}
+#endif
@@ -0,0 +1,158 @@
+#include "process_snapshot.hpp"
+#include "process_spawn.hpp"
+#include "test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <csignal>
+#include <filesystem>
+#include <string_view>
+
+#include <unistd.h>
+#endif
+
+namespace
+{
+    [[nodiscard]] std::uint32_t CurrentProcessId() noexcept
+    {
+#if defined(_WIN32)
+        return static_cast<std::uint32_t>(::_getpid());
+#else
+        return static_cast<std::uint32_t>(::getpid());
+#endif
+    }
+}
+
+HANDLE_TEST(ProcessSnapshot, FindsOwnProcessAndThreads)
+{
+    // Two extra threads parked until the snapshot was walked
+    std::atomic<bool> release = false;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 2; ++i)
+    {
+        workers.emplace_back([&release]
+        {
+            while (!release.load())
+            {
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    auto const self = CurrentProcessId();
+
+    ProcessSnapshot snapshot(SnapshotContents::Processes | SnapshotContents::Threads, self);
+    HANDLE_CHECK(snapshot.Valid());
+
+    // Walking twice restarts the enumeration
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::size_t processes = 0;
+        std::uint32_t threads = 0;
+        for (auto const& process : snapshot.Processes())
+        {
+            ++processes;
+            if (process.m_ProcessId == self)
+            {
+                threads = process.m_Threads;
+                HANDLE_CHECK(!process.m_Name.empty());
+#if !defined(_WIN32)
+                HANDLE_CHECK(process.m_ParentId == static_cast<std::uint32_t>(::getppid()));
+#endif
+            }
+        }
+
+        HANDLE_CHECK(processes != 0 && threads >= 3);
+    }
+
+    std::size_t owned = 0;
+    for (auto const& thread : snapshot.Threads())
+    {
+        HANDLE_CHECK(thread.m_OwnerProcessId == self && thread.m_ThreadId != 0);
+        ++owned;
+    }
+
+    HANDLE_CHECK(owned >= 3);
+
+    release = true;
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+#if !defined(_WIN32)
+HANDLE_TEST(ProcessSnapshot, ParsesCommWithParentheses)
+{
+    // comm comes from the name the program was started as, a link works
+    auto const link = std::filesystem::temp_directory_path() / "a) b (c";
+    std::filesystem::remove(link);
+    std::filesystem::create_symlink("/bin/sleep", link);
+
+    std::string_view const arguments[] = { "30" };
+    SpawnOptions options;
+    options.m_Program   = link;
+    options.m_Arguments = arguments;
+
+    auto child = Spawn(options);
+    HANDLE_CHECK(child.Valid());
+
+    // The name only changes once exec finished
+    bool found = false;
+    ProcessSnapshot snapshot;
+    for (int round = 0; round < 1000 && !found; ++round)
+    {
+        for (auto const& process : snapshot.Processes())
+        {
+            if (process.m_ProcessId == child.m_ProcessId && process.m_Name == "a) b (c")
+            {
+                HANDLE_CHECK(process.m_ParentId == static_cast<std::uint32_t>(::getpid()) && process.m_Threads == 1);
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    HANDLE_CHECK(found);
+
+    ::kill(static_cast<pid_t>(child.m_ProcessId), SIGKILL);
+    HANDLE_CHECK(child.Wait() == 128 + SIGKILL);
+    std::filesystem::remove(link);
+}
+
+HANDLE_TEST(ProcessSnapshot, ModulesAndHeapsFromMaps)
+{
+    ProcessSnapshot snapshot(SnapshotContents::Modules | SnapshotContents::Heaps);
+    HANDLE_CHECK(snapshot.Valid());
+
+    auto const executable = std::filesystem::read_symlink("/proc/self/exe").string();
+
+    bool sawExecutable = false;
+    for (auto const& module : snapshot.Modules())
+    {
+        HANDLE_CHECK(module.m_Base != 0 && module.m_Size != 0 && !module.m_Path.empty());
+        HANDLE_CHECK(module.m_Path.ends_with(module.m_Name));
+        sawExecutable = sawExecutable || module.m_Path == executable;
+    }
+
+    HANDLE_CHECK(sawExecutable);
+
+    // Whether a [heap] mapping exists depends on the allocator, if it does it is the caller's
+    for (auto const& heap : snapshot.Heaps())
+    {
+        HANDLE_CHECK(heap.m_Id != 0 && heap.m_ProcessId == static_cast<std::uint32_t>(::getpid()) && heap.m_Default);
+    }
+}
+#endif
@@ -0,0 +1,109 @@
+#include "process_spawn.hpp"
+#include "test.hpp"
+
+#if !defined(_WIN32)
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * @brief Reads `pipe` until every writer is gone
+     */
+    std::string Drain(FileHandle const& pipe)
+    {
+        std::string contents;
+        char buffer[256];
+        for (;;)
+        {
+            auto const count = ::read(pipe.Get(), buffer, sizeof(buffer));
+            if (count <= 0)
+            {
+                return contents;
+            }
+
+            contents.append(buffer, static_cast<std::size_t>(count));
+        }
+    }
+
+    struct Pipe
+    {
+        FileHandle m_Read;
+        FileHandle m_Write;
+
+        Pipe() noexcept
+        {
+            int fds[2];
+            if (::pipe2(fds, O_CLOEXEC) == 0)
+            {
+                m_Read.Reset(fds[0]);
+                m_Write.Reset(fds[1]);
+            }
+        }
+    };
+}
+
+HANDLE_TEST(ProcessSpawn, InheritListMapsDescriptors)
+{
+    Pipe output;
+    Pipe first;
+    Pipe second;
+    HANDLE_CHECK(output.m_Write.Valid() && first.m_Write.Valid() && second.m_Write.Valid());
+
+    // Inheritable in the parent, yet not on the inherit list
+    FileHandle leaked(::dup(output.m_Write.Get()));
+    HANDLE_CHECK(leaked.Valid() && leaked.Get() > 4);
+    auto const probe = "test -e /proc/self/fd/" + std::to_string(leaked.Get()) + " && exit 9; "
+                       "echo out; echo three >&3; echo four >&4; exit 5";
+
+    // Targets follow the list order, whatever the descriptor values
+    NativeHandle const inherit[] = { second.m_Write.Get(), first.m_Write.Get() };
+
+    std::string_view const arguments[] = { "-c", probe };
+
+    SpawnOptions options;
+    options.m_Program   = "/bin/sh";
+    options.m_Arguments = arguments;
+    options.m_Output    = output.m_Write.Get();
+    options.m_Inherit   = inherit;
+
+    auto child = Spawn(options);
+    HANDLE_CHECK(child.Valid() && child.m_ProcessId != 0);
+
+    // Only the child holds the write ends now, reads end when it exits
+    output.m_Write.Close();
+    first.m_Write.Close();
+    second.m_Write.Close();
+    leaked.Close();
+
+    HANDLE_CHECK(child.Wait() == 5);
+    HANDLE_CHECK(Drain(output.m_Read) == "out\n");
+    HANDLE_CHECK(Drain(second.m_Read) == "three\n");
+    HANDLE_CHECK(Drain(first.m_Read) == "four\n");
+}
+
+HANDLE_TEST(ProcessSpawn, WorkingDirectoryAndFailure)
+{
+    Pipe output;
+    std::string_view const arguments[] = { "-c", "pwd" };
+
+    SpawnOptions options;
+    options.m_Program          = "sh";
+    options.m_Arguments        = arguments;
+    options.m_WorkingDirectory = "/";
+    options.m_Output           = output.m_Write.Get();
+
+    auto child = Spawn(options);
+    HANDLE_CHECK(child.Valid());
+    output.m_Write.Close();
+
+    HANDLE_CHECK(child.Wait() == 0 && Drain(output.m_Read) == "/\n");
+
+    options.m_Program = "/nonexistent/program";
+    HANDLE_CHECK(!Spawn(options).Valid());
+}
+#endif
@@ -0,0 +1,142 @@
+#include "shared_handle.hpp"
+#include "test.hpp"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace
+{
+    [[nodiscard]] EventHandle NewEvent() noexcept
+    {
+#if defined(_WIN32)
+        return EventHandle(::CreateEventW(nullptr, FALSE, FALSE, nullptr));
+#else
+        return EventHandle(::eventfd(0, EFD_CLOEXEC));
+#endif
+    }
+
+    [[nodiscard]] bool IsOpen(NativeHandle handle) noexcept
+    {
+#if defined(_WIN32)
+        DWORD flags;
+        return ::GetHandleInformation(handle, &flags);
+#else
+        return ::fcntl(handle, F_GETFD) != -1;
+#endif
+    }
+}
+
+HANDLE_TEST(SharedHandle, LastOwnerCloses)
+{
+    SharedHandle shared(NewEvent());
+    HANDLE_CHECK(shared.Valid() && shared.UseCount() == 1);
+    auto const raw = shared.Get();
+
+    auto copy = shared;
+    HANDLE_CHECK(copy.Get() == raw && shared.UseCount() == 2);
+
+    shared.Reset();
+    HANDLE_CHECK(!shared.Valid() && copy.UseCount() == 1 && IsOpen(raw));
+
+    auto moved = std::move(copy);
+    HANDLE_CHECK(!copy.Valid() && moved.UseCount() == 1);
+
+    moved.Reset();
+    HANDLE_CHECK(!IsOpen(raw));
+}
+
+HANDLE_TEST(SharedHandle, InvalidDoesNotAllocate)
+{
+    SharedHandle shared{ EventHandle() };
+    HANDLE_CHECK(!shared.Valid() && shared.UseCount() == 0);
+
+    WeakHandle weak(shared);
+    HANDLE_CHECK(weak.Expired() && !weak.Lock().Valid());
+}
+
+HANDLE_TEST(SharedHandle, WeakLockAndExpiry)
+{
+    SharedHandle shared(NewEvent());
+    auto const raw = shared.Get();
+
+    WeakHandle weak(shared);
+    HANDLE_CHECK(!weak.Expired());
+    {
+        auto locked = weak.Lock();
+        HANDLE_CHECK(locked.Get() == raw && shared.UseCount() == 2);
+    }
+
+    HANDLE_CHECK(shared.UseCount() == 1);
+
+    // A weak reference alone keeps the block, not the handle
+    shared.Reset();
+    HANDLE_CHECK(weak.Expired() && !weak.Lock().Valid() && !IsOpen(raw));
+
+    weak.Reset();
+    HANDLE_CHECK(weak.Expired());
+}
+
+HANDLE_TEST(SharedHandle, LocalVariant)
+{
+    LocalSharedHandle<TaggedHandle<HandleType::Event>> shared(NewEvent());
+    LocalWeakHandle<TaggedHandle<HandleType::Event>> weak(shared);
+
+    auto copy = weak.Lock();
+    HANDLE_CHECK(copy.Valid() && shared.UseCount() == 2);
+
+    auto const raw = shared.Get();
+    copy.Reset();
+    shared.Reset();
+    HANDLE_CHECK(weak.Expired() && !IsOpen(raw));
+}
+
+HANDLE_TEST(SharedHandle, ConcurrentLockRacesLastRelease)
+{
+    for (int round = 0; round < 200; ++round)
+    {
+        SharedHandle shared(NewEvent());
+        auto const raw = shared.Get();
+        WeakHandle weak(shared);
+
+        std::atomic<bool> start = false;
+        std::atomic<int>  locked = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&]
+            {
+                while (!start.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+
+                for (int j = 0; j < 100; ++j)
+                {
+                    // A successful Lock() always sees the handle open
+                    if (auto owner = weak.Lock(); owner.Valid())
+                    {
+                        HANDLE_CHECK(owner.Get() == raw && IsOpen(raw));
+                        locked.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+
+        start.store(true, std::memory_order_release);
+        shared.Reset();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        HANDLE_CHECK(weak.Expired());
+    }
+}
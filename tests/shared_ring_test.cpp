@@ -0,0 +1,212 @@
+#include "shared_ring.hpp"
+#include "test.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    [[nodiscard]] std::string RingName(char const* suffix)
+    {
+        return "handle_tests_" + std::to_string(getpid()) + "_" + suffix;
+    }
+
+    /*
+     * @brief Payload of `size` bytes derived from `sequence`, checked on receipt
+     */
+    void Fill(std::span<std::byte> payload, std::uint32_t sequence) noexcept
+    {
+        for (std::size_t i = 0; i < payload.size(); ++i)
+        {
+            payload[i] = static_cast<std::byte>(sequence * 31 + i);
+        }
+    }
+
+    [[nodiscard]] bool Matches(std::span<std::byte const> payload, std::uint32_t sequence) noexcept
+    {
+        for (std::size_t i = 0; i < payload.size(); ++i)
+        {
+            if (payload[i] != static_cast<std::byte>(sequence * 31 + i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<RingProducers _Producers>
+    void CheckPaddingAtWrap(char const* suffix)
+    {
+        auto const name = RingName(suffix);
+        SharedRing<_Producers> consumer(name, 4096);
+        SharedRing<_Producers> producer(name);
+        HANDLE_CHECK(consumer.Valid() && producer.Valid() && consumer.Capacity() == 4096);
+
+        // 1008 byte records: four fit, the fifth would straddle the end
+        std::vector<std::byte> message(1000);
+        std::uint32_t sent = 0;
+        while (true)
+        {
+            Fill(message, sent);
+            if (!producer.TrySend(message))
+            {
+                break;
+            }
+
+            ++sent;
+        }
+
+        HANDLE_CHECK(sent == 4);
+
+        std::uint32_t received = 0;
+        auto const check = [&](std::span<std::byte const> payload)
+        {
+            HANDLE_CHECK(payload.size() == message.size() && Matches(payload, received));
+            ++received;
+        };
+
+        HANDLE_CHECK(consumer.TryReceive(check) == 4);
+
+        // The first lands at the start behind a padding record over the 64 byte tail, the
+        // others wrap at shifting offsets. Padding records are skipped, never handed out.
+        for (std::uint32_t round = 0; round < 64; ++round)
+        {
+            Fill(message, sent);
+            HANDLE_CHECK(producer.TrySend(message));
+            ++sent;
+
+            HANDLE_CHECK(consumer.TryReceive(check) == 1);
+        }
+
+        HANDLE_CHECK(received == sent);
+        HANDLE_CHECK(consumer.TryReceive(check) == 0);
+
+        // Oversized and empty messages are refused outright
+        std::vector<std::byte> large(consumer.MaxMessageSize() + 1);
+        HANDLE_CHECK(!producer.TrySend(large) && !producer.TrySend({}));
+    }
+}
+
+HANDLE_TEST(SharedRing, SinglePaddingAtWrap)
+{
+    CheckPaddingAtWrap<RingProducers::Single>("spsc");
+}
+
+HANDLE_TEST(SharedRing, MultiplePaddingAtWrap)
+{
+    CheckPaddingAtWrap<RingProducers::Multiple>("mpsc");
+}
+
+HANDLE_TEST(SharedRing, ConcurrentVariableSizes)
+{
+    constexpr std::uint32_t Messages  = 20'000;
+    constexpr std::uint32_t Producers = 2;
+
+    auto const name = RingName("stress");
+    SharedRing<RingProducers::Multiple> consumer(name, 8192);
+    HANDLE_CHECK(consumer.Valid());
+
+    std::vector<std::thread> producers;
+    for (std::uint32_t id = 0; id < Producers; ++id)
+    {
+        producers.emplace_back([&, id]
+        {
+            SharedRing<RingProducers::Multiple> producer(name);
+            HANDLE_CHECK(producer.Valid());
+
+            // Sizes sweep across record boundaries so the wrap lands on every offset
+            std::vector<std::byte> message(producer.MaxMessageSize());
+            for (std::uint32_t i = 0; i < Messages; ++i)
+            {
+                auto const size = 8 + (i * 37 + id * 101) % (message.size() - 8);
+                std::span<std::byte> payload(message.data(), size);
+
+                std::uint32_t const header[2] = { id, i };
+                Fill(payload.subspan(sizeof(header)), i);
+                std::memcpy(payload.data(), header, sizeof(header));
+                HANDLE_CHECK(producer.Send(payload));
+            }
+        });
+    }
+
+    std::uint32_t next[Producers] = {};
+    std::uint32_t received = 0;
+    while (received < Messages * Producers)
+    {
+        received += static_cast<std::uint32_t>(consumer.Receive([&](std::span<std::byte const> payload)
+        {
+            std::uint32_t header[2];
+            HANDLE_CHECK(payload.size() >= sizeof(header));
+            std::memcpy(header, payload.data(), sizeof(header));
+
+            // Per producer order is kept
+            HANDLE_CHECK(header[0] < Producers && header[1] == next[header[0]]);
+            HANDLE_CHECK(Matches(payload.subspan(sizeof(header)), header[1]));
+            ++next[header[0]];
+        }, 5000));
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    HANDLE_CHECK(next[0] == Messages && next[1] == Messages);
+}
+
+HANDLE_TEST(SharedRing, OpenWhileCreating)
+{
+    auto const name = RingName("race");
+    std::atomic<bool> stop = false;
+
+    // Opens racing creation either fail or see a fully sized and initialised ring
+    std::thread opener([&]
+    {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            SharedRing<RingProducers::Single> ring(name);
+            HANDLE_CHECK(!ring.Valid() || ring.Capacity() == 8192);
+        }
+    });
+
+    std::vector<std::byte> message(64);
+    for (std::uint32_t round = 0; round < 200; ++round)
+    {
+        SharedRing<RingProducers::Single> consumer(name, 8192);
+        SharedRing<RingProducers::Single> producer(name);
+        HANDLE_CHECK(consumer.Valid() && producer.Valid());
+
+        Fill(message, round);
+        HANDLE_CHECK(producer.TrySend(message));
+
+#if !defined(_WIN32)
+        // Recreating the name leaves the ring still mapped here intact, pending record included
+        SharedRing<RingProducers::Single> replacement(name, 8192);
+        HANDLE_CHECK(replacement.Valid());
+#endif
+
+        HANDLE_CHECK(consumer.TryReceive([&](std::span<std::byte const> payload)
+        {
+            HANDLE_CHECK(payload.size() == message.size() && Matches(payload, round));
+        }) == 1);
+
+        std::this_thread::yield();
+    }
+
+    stop = true;
+    opener.join();
+}
@@ -0,0 +1,125 @@
+#include "socket_io.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    constexpr std::int64_t WouldBlock = -WSAEWOULDBLOCK;
+#else
+    constexpr std::int64_t WouldBlock = -EAGAIN;
+#endif
+
+    /*
+     * @brief UDP socket bound to an ephemeral loopback port, `address` receives where
+     */
+    SocketHandle BoundUdp(sockaddr_in& address) noexcept
+    {
+        SocketHandle socket(::socket(AF_INET, SOCK_DGRAM, 0));
+
+        address = {};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        SocketLength length = sizeof(address);
+        if (::bind(socket.Get(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0
+            || ::getsockname(socket.Get(), reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        {
+            socket.Close();
+        }
+
+        return socket;
+    }
+}
+
+HANDLE_TEST(SocketIo, DatagramBatchesRoundTrip)
+{
+    HANDLE_CHECK(SocketStartup());
+
+    sockaddr_in senderAddress;
+    sockaddr_in receiverAddress;
+    auto const sender   = BoundUdp(senderAddress);
+    auto const receiver = BoundUdp(receiverAddress);
+    HANDLE_CHECK(sender.Valid() && receiver.Valid());
+
+    // More than one 64 datagram kernel call, each with its own size and first byte
+    constexpr std::size_t Count = 100;
+    std::vector<std::array<std::byte, 32>> payloads(Count);
+    std::vector<Datagram> outgoing(Count);
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        payloads[i].fill(static_cast<std::byte>(i));
+        outgoing[i].m_Buffer = MakeSocketBuffer(payloads[i].data(), 1 + i % payloads[i].size());
+        std::memcpy(&outgoing[i].m_Address, &receiverAddress, sizeof(receiverAddress));
+        outgoing[i].m_AddressLength = sizeof(receiverAddress);
+    }
+
+    HANDLE_CHECK(SendDatagrams(sender, outgoing) == static_cast<std::int64_t>(Count));
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        HANDLE_CHECK(outgoing[i].m_Size == 1 + i % payloads[i].size());
+    }
+
+    std::vector<std::array<std::byte, 64>> buffers(Count);
+    std::vector<Datagram> incoming(Count);
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        incoming[i].m_Buffer = MakeSocketBuffer(buffers[i].data(), buffers[i].size());
+    }
+
+    // Datagrams arrive in order on loopback, batches take whatever is queued
+    std::size_t received = 0;
+    while (received < Count)
+    {
+        auto const result = ReceiveDatagrams(receiver, std::span(incoming).subspan(received));
+        HANDLE_CHECK(result > 0);
+
+        for (auto i = received; i < received + static_cast<std::size_t>(result); ++i)
+        {
+            auto const& source = reinterpret_cast<sockaddr_in const&>(incoming[i].m_Address);
+            HANDLE_CHECK(incoming[i].m_Size == 1 + i % payloads[i].size());
+            HANDLE_CHECK(std::memcmp(buffers[i].data(), payloads[i].data(), incoming[i].m_Size) == 0);
+            HANDLE_CHECK(source.sin_port == senderAddress.sin_port);
+        }
+
+        received += static_cast<std::size_t>(result);
+    }
+
+    HANDLE_CHECK(ReceiveDatagrams(receiver, incoming, false) == WouldBlock);
+}
+
+HANDLE_TEST(SocketIo, GatherScatterDatagram)
+{
+    HANDLE_CHECK(SocketStartup());
+
+    sockaddr_in senderAddress;
+    sockaddr_in receiverAddress;
+    auto const sender   = BoundUdp(senderAddress);
+    auto const receiver = BoundUdp(receiverAddress);
+    HANDLE_CHECK(::connect(sender.Get(), reinterpret_cast<sockaddr const*>(&receiverAddress), sizeof(receiverAddress)) == 0);
+
+    // Three pieces leave as one datagram and land across two buffers
+    char const head[] = "head-";
+    char const body[] = "body-";
+    char const tail[] = "tail";
+    SocketBuffer const gather[] = { MakeSocketBuffer(head, 5), MakeSocketBuffer(body, 5), MakeSocketBuffer(tail, 4) };
+    HANDLE_CHECK(SocketSend(sender, gather) == 14);
+
+    char first[8]  = {};
+    char second[8] = {};
+    SocketBuffer const scatter[] = { MakeSocketBuffer(first, sizeof(first)), MakeSocketBuffer(second, sizeof(second)) };
+    HANDLE_CHECK(SocketReceive(receiver, scatter) == 14);
+    HANDLE_CHECK(std::memcmp(first, "head-bod", 8) == 0 && std::memcmp(second, "y-tail", 6) == 0);
+}
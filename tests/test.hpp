@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * @brief One registered test case, `handle_tests <Suite>` runs every case named `<Suite>.*`
+ */
+struct TestCase
+{
+    char const* m_Name;
+    void      (*m_Run)();
+    TestCase*   m_Next;
+
+    // Appended, so cases run in declaration order within a file
+    TestCase(char const* name, void (*run)()) noexcept
+        : m_Name(name)
+        , m_Run(run)
+        , m_Next(nullptr)
+    {
+        *Tail() = this;
+        Tail()  = &m_Next;
+    }
+
+    [[nodiscard]] static TestCase*& Head() noexcept
+    {
+        static TestCase* head = nullptr;
+        return head;
+    }
+
+private:
+    [[nodiscard]] static TestCase**& Tail() noexcept
+    {
+        static TestCase** tail = &Head();
+        return tail;
+    }
+};
+
+/*
+ * @brief Defines and registers `suite.name`
+ */
+#define HANDLE_TEST(suite, name)                                               \
+    static void suite##_##name();                                              \
+    static TestCase const suite##_##name##_Case(#suite "." #name, suite##_##name); \
+    static void suite##_##name()
+
+/*
+ * @brief Fails the running case, independent of NDEBUG so Release builds check too
+ */
+#define HANDLE_CHECK(condition)                                                                   \
+    do                                                                                            \
+    {                                                                                             \
+        if (!(condition))                                                                         \
+        {                                                                                         \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);   \
+            std::fflush(stderr);                                                                  \
+            std::_Exit(EXIT_FAILURE);                                                             \
+        }                                                                                         \
+    } while (false)
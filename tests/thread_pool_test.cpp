@@ -0,0 +1,164 @@
+#include "thread_pool.hpp"
+#include "test.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+HANDLE_TEST(ThreadPool, DequeOwnerOrderAndCapacity)
+{
+    WorkStealingDeque<int> deque(4);
+    HANDLE_CHECK(deque.Capacity() == 4 && deque.Empty());
+
+    int items[5] = { 0, 1, 2, 3, 4 };
+    for (int i = 0; i < 4; ++i)
+    {
+        HANDLE_CHECK(deque.Push(&items[i]));
+    }
+
+    // Fixed size, a full deque refuses instead of growing
+    HANDLE_CHECK(!deque.Push(&items[4]));
+
+    // Thieves take the oldest, the owner the newest
+    HANDLE_CHECK(deque.Steal() == &items[0]);
+    HANDLE_CHECK(deque.Pop() == &items[3]);
+    HANDLE_CHECK(deque.Push(&items[4]));
+    HANDLE_CHECK(deque.Pop() == &items[4]);
+    HANDLE_CHECK(deque.Pop() == &items[2]);
+    HANDLE_CHECK(deque.Steal() == &items[1]);
+    HANDLE_CHECK(deque.Pop() == nullptr && deque.Steal() == nullptr && deque.Empty());
+}
+
+HANDLE_TEST(ThreadPool, DequePopStealRace)
+{
+    constexpr int Items   = 200'000;
+    constexpr int Thieves = 3;
+
+    WorkStealingDeque<int> deque(256);
+    std::unique_ptr<int[]> items(new int[Items]);
+    std::unique_ptr<std::atomic<int>[]> taken(new std::atomic<int>[Items]);
+    for (int i = 0; i < Items; ++i)
+    {
+        items[i] = i;
+        taken[i].store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> done = false;
+    auto const take = [&](int* item)
+    {
+        taken[*item].fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < Thieves; ++i)
+    {
+        thieves.emplace_back([&]
+        {
+            while (!done.load(std::memory_order_acquire) || !deque.Empty())
+            {
+                if (auto* item = deque.Steal())
+                {
+                    take(item);
+                }
+            }
+        });
+    }
+
+    // The owner pops every other push, the single last item is raced for most of the time
+    for (int i = 0; i < Items; ++i)
+    {
+        while (!deque.Push(&items[i]))
+        {
+            if (auto* item = deque.Pop())
+            {
+                take(item);
+            }
+        }
+
+        if (i % 2 == 0)
+        {
+            if (auto* item = deque.Pop())
+            {
+                take(item);
+            }
+        }
+    }
+
+    while (auto* item = deque.Pop())
+    {
+        take(item);
+    }
+
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves)
+    {
+        thief.join();
+    }
+
+    for (int i = 0; i < Items; ++i)
+    {
+        HANDLE_CHECK(taken[i].load(std::memory_order_relaxed) == 1);
+    }
+}
+
+namespace
+{
+    struct Counter
+    {
+        PoolTask          m_Task;
+        std::atomic<int>* m_Count;
+    };
+
+    void Increment(PoolTask& task) noexcept
+    {
+        static_cast<Counter*>(task.m_Context)->m_Count->fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+HANDLE_TEST(ThreadPool, SubmitSpillsFullDeque)
+{
+    ThreadPool pool(2, ThreadAffinity::None);
+    HANDLE_CHECK(pool.Valid());
+
+    // Far more than one worker deque holds, submitted from a worker
+    constexpr std::size_t Children = WorkStealingDeque<PoolTask>::DefaultCapacity * 4;
+
+    std::atomic<int> count = 0;
+    std::unique_ptr<Counter[]> children(new Counter[Children]);
+
+    struct Parent
+    {
+        PoolTask    m_Task;
+        ThreadPool* m_Pool;
+        Counter*    m_Children;
+    } parent{ {}, &pool, children.get() };
+
+    parent.m_Task.m_Context = &parent;
+    parent.m_Task.m_Run     = [](PoolTask& task) noexcept
+    {
+        auto& self = *static_cast<Parent*>(task.m_Context);
+
+        TaskGroup group(*self.m_Pool);
+        for (std::size_t i = 0; i < Children; ++i)
+        {
+            auto& child = self.m_Children[i];
+            child.m_Task.m_Context = &child;
+            child.m_Task.m_Run     = Increment;
+            group.Run(child.m_Task);
+        }
+    };
+
+    for (std::size_t i = 0; i < Children; ++i)
+    {
+        children[i].m_Count = &count;
+    }
+
+    {
+        TaskGroup group(pool);
+        group.Run(parent.m_Task);
+    }
+
+    HANDLE_CHECK(count.load() == static_cast<int>(Children));
+}
@@ -0,0 +1,170 @@
+#include "timer_wheel.hpp"
+#include "test.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    /*
+     * @brief Node recording how often it expired
+     */
+    struct Probe
+    {
+        TimerNode m_Node;
+        int       m_Fired = 0;
+
+        Probe() noexcept
+        {
+            m_Node.m_Context = this;
+            m_Node.m_Expired = [](TimerNode& node) noexcept
+            {
+                ++static_cast<Probe*>(node.m_Context)->m_Fired;
+            };
+        }
+    };
+}
+
+// Deadlines are rounded up to whole ticks from the wheel's origin, which lies a little before
+// `start`. Advance() at `start + d - 1ms` must not fire a timer due at `start + d`, and
+// `start + d + 2ms` must.
+HANDLE_TEST(TimerWheel, CascadeThroughLevels)
+{
+    TimerWheel wheel;
+    HANDLE_CHECK(wheel.Valid());
+    auto const start = TimerWheel::Clock::now();
+
+    // Level 0 covers 256 ticks, level 1 65536, level 2 16M
+    std::chrono::milliseconds const delays[] = { 5ms, 300ms, 70'000ms, 20'000'000ms };
+    Probe probes[std::size(delays)];
+    for (std::size_t i = 0; i < std::size(delays); ++i)
+    {
+        wheel.ScheduleAt(probes[i].m_Node, start + delays[i]);
+    }
+
+    HANDLE_CHECK(wheel.Size() == std::size(delays));
+
+    for (std::size_t i = 0; i < std::size(delays); ++i)
+    {
+        HANDLE_CHECK(wheel.Advance(start + delays[i] - 1ms) == 0);
+        HANDLE_CHECK(probes[i].m_Fired == 0);
+
+        HANDLE_CHECK(wheel.Advance(start + delays[i] + 2ms) == 1);
+        for (std::size_t j = 0; j < std::size(delays); ++j)
+        {
+            HANDLE_CHECK(probes[j].m_Fired == (j <= i ? 1 : 0));
+        }
+    }
+
+    HANDLE_CHECK(wheel.Size() == 0);
+}
+
+HANDLE_TEST(TimerWheel, CancelOnEveryLevel)
+{
+    TimerWheel wheel;
+    auto const start = TimerWheel::Clock::now();
+
+    Probe kept, cancelled[3];
+    wheel.ScheduleAt(cancelled[0].m_Node, start + 10ms);
+    wheel.ScheduleAt(cancelled[1].m_Node, start + 1'000ms);
+    wheel.ScheduleAt(cancelled[2].m_Node, start + 100'000ms);
+    wheel.ScheduleAt(kept.m_Node, start + 100'000ms);
+
+    for (auto& probe : cancelled)
+    {
+        HANDLE_CHECK(probe.m_Node.Scheduled());
+        HANDLE_CHECK(wheel.Cancel(probe.m_Node));
+        HANDLE_CHECK(!probe.m_Node.Scheduled() && !wheel.Cancel(probe.m_Node));
+    }
+
+    HANDLE_CHECK(wheel.Size() == 1);
+    HANDLE_CHECK(wheel.Advance(start + 100'002ms) == 1);
+    HANDLE_CHECK(kept.m_Fired == 1);
+    for (auto const& probe : cancelled)
+    {
+        HANDLE_CHECK(probe.m_Fired == 0);
+    }
+}
+
+HANDLE_TEST(TimerWheel, RescheduleMovesDeadline)
+{
+    TimerWheel wheel;
+    auto const start = TimerWheel::Clock::now();
+
+    Probe probe;
+    wheel.ScheduleAt(probe.m_Node, start + 50ms);
+    wheel.ScheduleAt(probe.m_Node, start + 500ms);
+    HANDLE_CHECK(wheel.Size() == 1);
+
+    HANDLE_CHECK(wheel.Advance(start + 100ms) == 0);
+    HANDLE_CHECK(wheel.Advance(start + 502ms) == 1 && probe.m_Fired == 1);
+}
+
+namespace
+{
+    struct Pair
+    {
+        TimerNode  m_First;
+        TimerNode  m_Second;
+        TimerWheel* m_Wheel;
+        int         m_Fired = 0;
+    };
+}
+
+HANDLE_TEST(TimerWheel, CallbackCancelsSameBatch)
+{
+    TimerWheel wheel;
+    auto const start = TimerWheel::Clock::now();
+
+    // Both expire in one batch, whichever runs first cancels the other
+    Pair pair{ {}, {}, &wheel };
+    for (auto* node : { &pair.m_First, &pair.m_Second })
+    {
+        node->m_Context = &pair;
+        node->m_Expired = [](TimerNode& node) noexcept
+        {
+            auto& self = *static_cast<Pair*>(node.m_Context);
+            ++self.m_Fired;
+            self.m_Wheel->Cancel(&node == &self.m_First ? self.m_Second : self.m_First);
+        };
+    }
+
+    wheel.ScheduleAt(pair.m_First, start + 20ms);
+    wheel.ScheduleAt(pair.m_Second, start + 20ms);
+
+    HANDLE_CHECK(wheel.Advance(start + 30ms) == 1);
+    HANDLE_CHECK(pair.m_Fired == 1 && wheel.Size() == 0);
+}
+
+HANDLE_TEST(TimerWheel, ToleranceSharesSlot)
+{
+    TimerWheel wheel;
+    auto const start = TimerWheel::Clock::now();
+
+    // 8ms of tolerance rounds both up to the same multiple of 8 ticks
+    Probe probes[2];
+    wheel.ScheduleAt(probes[0].m_Node, start + 17ms, 8ms);
+    wheel.ScheduleAt(probes[1].m_Node, start + 21ms, 8ms);
+    HANDLE_CHECK(probes[0].m_Node.m_Deadline == probes[1].m_Node.m_Deadline);
+
+    HANDLE_CHECK(wheel.Advance(start + 40ms) == 2);
+}
+
+HANDLE_TEST(TimerWheel, KernelTimerFires)
+{
+    TimerWheel wheel;
+
+    Probe probe;
+    wheel.Schedule(probe.m_Node, 5ms);
+
+    std::size_t expired = 0;
+    for (int attempt = 0; attempt < 100 && expired == 0; ++attempt)
+    {
+        expired = wheel.Run(1000ms);
+    }
+
+    HANDLE_CHECK(expired == 1 && probe.m_Fired == 1);
+}
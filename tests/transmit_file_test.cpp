@@ -0,0 +1,159 @@
+#include "completion_engine.hpp"
+#include "transmit_file.hpp"
+#include "test.hpp"
+
+#if !defined(_WIN32)
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t FileSize = (1 << 20) + 123;
+
+    [[nodiscard]] char Pattern(std::size_t offset) noexcept
+    {
+        return static_cast<char>('a' + offset % 23);
+    }
+
+    std::filesystem::path ScratchFile()
+    {
+        auto const path = std::filesystem::temp_directory_path() / "handle_test_transmit";
+
+        std::string contents(FileSize, '\0');
+        for (std::size_t i = 0; i < FileSize; ++i)
+        {
+            contents[i] = Pattern(i);
+        }
+
+        std::ofstream(path, std::ios::binary) << contents;
+        return path;
+    }
+
+    /*
+     * @brief Everything read from `socket` until the peer shuts down its sending side
+     */
+    std::string Drain(SocketHandle const& socket)
+    {
+        std::string received;
+        char buffer[64 * 1024];
+        for (;;)
+        {
+            auto const count = ::recv(socket.Get(), buffer, sizeof(buffer), 0);
+            if (count <= 0)
+            {
+                return received;
+            }
+
+            received.append(buffer, static_cast<std::size_t>(count));
+        }
+    }
+
+    [[nodiscard]] std::string Expected(std::string const& header, std::size_t offset, std::size_t length, std::string const& trailer)
+    {
+        auto expected = header;
+        for (std::size_t i = offset; i < offset + length; ++i)
+        {
+            expected.push_back(Pattern(i));
+        }
+
+        return expected + trailer;
+    }
+
+    struct Outcome
+    {
+        std::int64_t m_Result = 0;
+        int          m_Calls  = 0;
+    };
+
+    void Record(IoOperation& operation, std::int64_t result) noexcept
+    {
+        auto& outcome = *static_cast<Outcome*>(operation.m_Context);
+        outcome.m_Result = result;
+        ++outcome.m_Calls;
+    }
+}
+
+HANDLE_TEST(TransmitFile, SendFileFramesRange)
+{
+    auto const path = ScratchFile();
+    FileHandle file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    HANDLE_CHECK(file.Valid());
+
+    int fds[2];
+    HANDLE_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+    SocketHandle sender(fds[0]);
+    SocketHandle receiver(fds[1]);
+
+    // Non-blocking, so the file is larger than the socket buffer takes and SendFile polls for room
+    HANDLE_CHECK(::fcntl(sender.Get(), F_SETFL, O_NONBLOCK) == 0);
+
+    std::string received;
+    std::thread reader([&] { received = Drain(receiver); });
+
+    std::string const header  = "HEADER\r\n";
+    std::string const trailer = "\r\nTRAILER";
+    TransmitRequest request{ .m_File    = file,
+                             .m_Offset  = 1000,
+                             .m_Header  = std::as_bytes(std::span(header)),
+                             .m_Trailer = std::as_bytes(std::span(trailer)) };
+
+    auto const total = header.size() + FileSize - 1000 + trailer.size();
+    HANDLE_CHECK(SendFile(sender, request) == static_cast<std::int64_t>(total));
+    HANDLE_CHECK(request.m_Length == FileSize - 1000 && request.m_Sent == total);
+
+    ::shutdown(sender.Get(), SHUT_WR);
+    reader.join();
+    HANDLE_CHECK(received == Expected(header, 1000, FileSize - 1000, trailer));
+
+    file.Close();
+    std::filesystem::remove(path);
+}
+
+HANDLE_TEST(TransmitFile, EngineTransmitCompletes)
+{
+    auto const path = ScratchFile();
+    FileHandle file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+
+    int fds[2];
+    HANDLE_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+    SocketHandle sender(fds[0]);
+    SocketHandle receiver(fds[1]);
+
+    CompletionEngine engine(1);
+    HANDLE_CHECK(engine.Associate(sender));
+
+    std::string received;
+    std::thread reader([&] { received = Drain(receiver); });
+
+    std::string const header = "H";
+    TransmitRequest request{ .m_File = file, .m_Offset = 7, .m_Length = 300000, .m_Header = std::as_bytes(std::span(header)) };
+
+    Outcome outcome;
+    HANDLE_CHECK(engine.Transmit(sender, request, &Record, &outcome));
+    for (int round = 0; round < 500 && outcome.m_Calls == 0; ++round)
+    {
+        engine.RunOnce(std::chrono::milliseconds(10));
+    }
+
+    HANDLE_CHECK(outcome.m_Calls == 1 && outcome.m_Result == static_cast<std::int64_t>(request.Total()));
+
+    engine.Disassociate(sender);
+    ::shutdown(sender.Get(), SHUT_WR);
+    reader.join();
+    HANDLE_CHECK(received == Expected(header, 7, 300000, ""));
+
+    file.Close();
+    std::filesystem::remove(path);
+}
+#endif
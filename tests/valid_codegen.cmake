@@ -0,0 +1,63 @@
+# Checks the disassembly of tests/valid_codegen.cpp: every Codegen* function must compare
+# the handle against an immediate exactly once and contain no conditional branch.
+#
+# cmake -DOBJDUMP=<objdump> -DOBJECT=<valid_codegen object> -P valid_codegen.cmake
+
+execute_process(
+    COMMAND "${OBJDUMP}" -d --no-show-raw-insn "${OBJECT}"
+    OUTPUT_VARIABLE disassembly
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECT}")
+endif()
+
+string(REPLACE "\n" ";" lines "${disassembly}")
+
+set(function "")
+set(functions "")
+foreach(line IN LISTS lines)
+    if(line MATCHES "^[0-9a-f]+ <(.+)>:$")
+        set(function "${CMAKE_MATCH_1}")
+        if(function MATCHES "^_?Codegen")
+            list(APPEND functions "${function}")
+            set(compares_${function} 0)
+            set(immediates_${function} 0)
+            set(branches_${function} "")
+        endif()
+    elseif(function MATCHES "^_?Codegen" AND line MATCHES "^ *[0-9a-f]+:[ \t]+([a-z][a-z0-9.]*)[ \t]*(.*)$")
+        set(mnemonic "${CMAKE_MATCH_1}")
+        set(operands "${CMAKE_MATCH_2}")
+
+        # x86: cmp/test, AArch64: cmp/cmn/tst
+        if(mnemonic MATCHES "^(cmp|cmn|test|tst)")
+            math(EXPR compares_${function} "${compares_${function}} + 1")
+            if(operands MATCHES "\\$|#")
+                math(EXPR immediates_${function} "${immediates_${function}} + 1")
+            endif()
+        endif()
+
+        # x86: every j* but jmp, AArch64: b.<cond>, cbz/cbnz, tbz/tbnz
+        if((mnemonic MATCHES "^j" AND NOT mnemonic MATCHES "^jmp") OR mnemonic MATCHES "^(b\\.|cbn?z|tbn?z)")
+            string(APPEND branches_${function} " ${mnemonic}")
+        endif()
+    endif()
+endforeach()
+
+if(NOT functions)
+    message(FATAL_ERROR "no Codegen* function in ${OBJECT}:\n${disassembly}")
+endif()
+
+set(failed FALSE)
+foreach(function IN LISTS functions)
+    if(NOT compares_${function} EQUAL 1 OR NOT immediates_${function} EQUAL 1 OR NOT branches_${function} STREQUAL "")
+        message(SEND_ERROR "${function}: ${compares_${function}} compares, ${immediates_${function}} against an immediate, conditional branches:${branches_${function}}")
+        set(failed TRUE)
+    else()
+        message(STATUS "${function}: one immediate compare, no branch")
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "Valid() does not fold to a single compare:\n${disassembly}")
+endif()
@@ -0,0 +1,29 @@
+#include "handle.hpp"
+
+// Compiled on its own and disassembled by valid_codegen.cmake, which expects every
+// Codegen* function to be one compare against the sentinel and no conditional branch.
+
+extern "C" bool CodegenEventValid(EventHandle const& handle) noexcept
+{
+    return handle.Valid();
+}
+
+extern "C" bool CodegenFileValid(FileHandle const& handle) noexcept
+{
+    return handle.Valid();
+}
+
+extern "C" bool CodegenFileMappingValid(FileMappingHandle const& handle) noexcept
+{
+    return handle.Valid();
+}
+
+extern "C" bool CodegenSocketValid(SocketHandle const& handle) noexcept
+{
+    return handle.Valid();
+}
+
+extern "C" bool CodegenFileTraitsValid(FileHandle::Type handle) noexcept
+{
+    return FileHandle::Traits::Valid(handle);
+}
@@ -0,0 +1,112 @@
+#include "wait_set.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/eventfd.h>
+#endif
+
+namespace
+{
+    [[nodiscard]] NativeHandle NewEvent() noexcept
+    {
+#if defined(_WIN32)
+        return ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#else
+        return ::eventfd(0, EFD_CLOEXEC);
+#endif
+    }
+
+    void Signal(EventHandle const& event) noexcept
+    {
+#if defined(_WIN32)
+        ::SetEvent(event);
+#else
+        (void)::eventfd_write(event, 1);
+#endif
+    }
+
+    /*
+     * @brief Resets an event reported by the set, auto-reset events were consumed by the wait already
+     */
+    void Consume(EventHandle const& event) noexcept
+    {
+#if defined(_WIN32)
+        (void)event;
+#else
+        eventfd_t value;
+        (void)::eventfd_read(event, &value);
+#endif
+    }
+}
+
+HANDLE_TEST(WaitSet, ReportsSignaledHandles)
+{
+    // More than MAXIMUM_WAIT_OBJECTS, which WaitForMultipleObjects could not take
+    std::vector<EventHandle> events;
+    WaitSet set;
+    HANDLE_CHECK(set.Valid());
+
+    for (std::size_t i = 0; i < 80; ++i)
+    {
+        events.emplace_back(NewEvent());
+        HANDLE_CHECK(set.Add(events.back()) == i);
+    }
+
+    HANDLE_CHECK(set.Size() == 80);
+
+    std::array<std::size_t, 8> ready;
+    HANDLE_CHECK(set.Wait(ready, std::chrono::milliseconds::zero()) == 0);
+
+    Signal(events[3]);
+    Signal(events[71]);
+
+    std::size_t seen = 0;
+    for (int round = 0; round < 10 && seen != 2; ++round)
+    {
+        auto const count = set.Wait(ready, std::chrono::milliseconds(1000));
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            HANDLE_CHECK(ready[i] == 3 || ready[i] == 71);
+            Consume(events[ready[i]]);
+            ++seen;
+        }
+    }
+
+    HANDLE_CHECK(seen == 2);
+    HANDLE_CHECK(set.Wait(ready, std::chrono::milliseconds(10)) == 0);
+
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        HANDLE_CHECK(set.Remove(i));
+    }
+
+    HANDLE_CHECK(set.Size() == 0);
+}
+
+HANDLE_TEST(WaitSet, RemovedIndexIsReused)
+{
+    EventHandle first(NewEvent());
+    EventHandle second(NewEvent());
+    EventHandle third(NewEvent());
+
+    WaitSet set;
+    HANDLE_CHECK(set.Add(first) == 0 && set.Add(second) == 1);
+    HANDLE_CHECK(set.Remove(0) && !set.Remove(0));
+
+    // A removed handle is never reported, its slot goes to the next Add
+    Signal(first);
+    std::array<std::size_t, 4> ready;
+    HANDLE_CHECK(set.Wait(ready, std::chrono::milliseconds(10)) == 0);
+
+    HANDLE_CHECK(set.Add(third) == 0);
+    Signal(third);
+    HANDLE_CHECK(set.Wait(ready, std::chrono::milliseconds(1000)) == 1 && ready[0] == 0);
+    Consume(third);
+
+    HANDLE_CHECK(set.Remove(0) && set.Remove(1));
+}